@@ -10,15 +10,21 @@
 #include <Utils/Geometry/ElementInfo.h>
 /* external */
 #include <libint2/util/small_vector.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
 
 using namespace Scine;
 using namespace Integrals;
 
-auto BasisSetHandler::libintToScine(const libint2::BasisSet& libintBasis, const Utils::AtomCollection& atoms,
-                                    const bool& pure_solid) -> Utils::Integrals::BasisSet {
+namespace {
+template<class ShellRange>
+auto shellsToScine(const ShellRange& libintShells, const Utils::AtomCollection& atoms, const bool& pure_solid)
+    -> Utils::Integrals::BasisSet {
   Utils::Integrals::BasisSet scineBasis(atoms);
 
-  for (const auto& libintShell : libintBasis) {
+  for (const auto& libintShell : libintShells) {
     Utils::Displacement shift;
     std::size_t max_l;
 
@@ -47,6 +53,17 @@ auto BasisSetHandler::libintToScine(const libint2::BasisSet& libintBasis, const
 
   return scineBasis;
 }
+} // namespace
+
+auto BasisSetHandler::libintToScine(const libint2::BasisSet& libintBasis, const Utils::AtomCollection& atoms,
+                                    const bool& pure_solid) -> Utils::Integrals::BasisSet {
+  return shellsToScine(libintBasis, atoms, pure_solid);
+}
+
+auto BasisSetHandler::libintToScine(const std::vector<libint2::Shell>& libintShells, const Utils::AtomCollection& atoms,
+                                    const bool& pure_solid) -> Utils::Integrals::BasisSet {
+  return shellsToScine(libintShells, atoms, pure_solid);
+}
 
 auto BasisSetHandler::scineToLibint(const Utils::AtomCollection& scineAtoms) -> std::vector<libint2::Atom> {
   std::vector<libint2::Atom> libintAtoms;
@@ -86,78 +103,293 @@ auto BasisSetHandler::generateShellPairs(Utils::Integrals::BasisSet& basis, bool
   Libint::getInstance();
   auto shellPairs = std::make_shared<Utils::Integrals::ShellPairs>();
   shellPairs->resize(basis.size());
-#pragma omp parallel
+
+  // Far shell pairs are rejected through the spatial index, only the remaining candidates are checked with libint.
+  std::vector<std::vector<size_t>> candidates;
+  if (performOverlapPrescreening) {
+    candidates = shellPairCandidates(basis, threshold);
+  }
+  else {
+    candidates.resize(basis.size());
+    for (size_t s1 = 0; s1 < basis.size(); ++s1) {
+      candidates[s1].resize(s1 + 1);
+      std::iota(candidates[s1].begin(), candidates[s1].end(), 0);
+    }
+  }
+
+  // The shells are converted once and shared among the threads.
+  std::vector<libint2::Shell> libintShells;
+  libintShells.reserve(basis.size());
+  for (auto const& shell : basis) {
+    libintShells.push_back(scineToLibint(shell));
+  }
+
+#pragma omp parallel num_threads(Libint::getNumberOfThreads())
   {
-    auto localEngine = Libint::getEngine(basis, libint2::Operator::overlap);
-    auto const& buffer = localEngine.results();
-#pragma omp barrier
+    // One overlap and one Coulomb engine per thread, reused for all shell pairs.
+    auto localEngine = Libint::leaseEngine(basis, libint2::Operator::overlap);
+    auto const& buffer = localEngine->results();
+    Libint::EngineLease coulombEngine;
+    if (calculateCauchySchwarzFactor) {
+      coulombEngine = Libint::leaseEngine(basis, libint2::Operator::coulomb);
+      // Important for Cauchy-Schwarz that no native screening is performed!!
+      coulombEngine->set_precision(0);
+    }
 #pragma omp for schedule(dynamic)
     for (size_t s1 = 0; s1 < basis.size(); ++s1) {
       const auto& shell1 = basis[s1];
+      // Every shell pair is built by one thread only, no locking is required.
       Utils::Integrals::ShellPair shellPair(shell1, calculateCauchySchwarzFactor);
 
       auto const shell1Size = basis[s1].size();
-      for (size_t s2 = 0; s2 <= s1; ++s2) {
+      for (size_t s2 : candidates[s1]) {
         auto const shell2Size = basis[s2].size();
         const auto& shell2 = basis[s2];
 
-        if (performOverlapPrescreening) {
-          bool onSameCenter = shell1.getShift() == shell2.getShift();
-          bool toBeIncluded = onSameCenter;
+        bool toBeIncluded = true;
+        if (performOverlapPrescreening && shell1.getShift() != shell2.getShift()) {
+          localEngine->compute(libintShells[s1], libintShells[s2]);
+          double overlapNorm =
+              (Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>(buffer[0], shell1Size, shell2Size)).norm();
+          toBeIncluded = overlapNorm > threshold;
+        }
+        if (toBeIncluded) {
+          shellPair.emplace_back(makePair(s2, shell1, shell2, libintShells[s1], libintShells[s2], coulombEngine.get()));
+        }
+      }
+      // s2 is traversed in ascending order, the pairs are therefore already sorted.
+      shellPairs->at(s1) = std::move(shellPair);
+    }
+  }
+  shellPairs->setCauchySchwarzFactor(calculateCauchySchwarzFactor);
+
+  basis.setShellPairs(shellPairs);
+}
+
+auto BasisSetHandler::shellPairCandidates(const Utils::Integrals::BasisSet& basis, double threshold)
+    -> std::vector<std::vector<size_t>> {
+  std::vector<std::vector<size_t>> candidates(basis.size());
+  if (basis.empty()) {
+    return candidates;
+  }
 
-          if (!onSameCenter) {
-            localEngine.compute(scineToLibint(shell1), scineToLibint(shell2));
-            double overlapNorm =
-                (Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>(buffer[0], shell1Size, shell2Size)).norm();
-            toBeIncluded = overlapNorm > threshold;
+  /*
+   * The overlap of two primitives decays as exp(-mu R^2) with mu = a1 a2 / (a1 + a2). With the extent
+   * e = sqrt(L / a_min) of every shell, R > e1 + e2 implies mu R^2 > L. The margin in L accounts for the contraction
+   * coefficients and the polynomial prefactors of higher angular momenta.
+   */
+  const double L = -std::log(threshold) + 10.0 + 4.0 * static_cast<double>(basis.max_l());
+  std::vector<double> extents(basis.size());
+  for (size_t s = 0; s < basis.size(); ++s) {
+    const auto& alphas = basis[s].getVecAlpha();
+    extents[s] = std::sqrt(L / *std::min_element(alphas.begin(), alphas.end()));
+  }
+  const double maxExtent = *std::max_element(extents.begin(), extents.end());
+  const double cellSize = maxExtent;
+
+  // Cell list of the shell centers. The partners of s1 are at most extents[s1] + maxExtent, i.e. up to two cells,
+  // away; the search reach is determined per shell.
+  auto cellOf = [&](const Utils::Integrals::Shell& shell) {
+    return std::array<long, 3>{static_cast<long>(std::floor(shell.getShift()[0] / cellSize)),
+                               static_cast<long>(std::floor(shell.getShift()[1] / cellSize)),
+                               static_cast<long>(std::floor(shell.getShift()[2] / cellSize))};
+  };
+  auto hashCell = [](const std::array<long, 3>& cell) {
+    return static_cast<size_t>((cell[0] * 73856093) ^ (cell[1] * 19349663) ^ (cell[2] * 83492791));
+  };
+  std::unordered_map<std::array<long, 3>, std::vector<size_t>, decltype(hashCell)> cells(basis.size(), hashCell);
+  for (size_t s = 0; s < basis.size(); ++s) {
+    cells[cellOf(basis[s])].push_back(s);
+  }
+
+#pragma omp parallel for schedule(dynamic) num_threads(Libint::getNumberOfThreads())
+  for (size_t s1 = 0; s1 < basis.size(); ++s1) {
+    const auto cell = cellOf(basis[s1]);
+    const auto& center1 = basis[s1].getShift();
+    const auto reach = static_cast<long>(std::ceil((extents[s1] + maxExtent) / cellSize));
+    for (long i = -reach; i <= reach; ++i) {
+      for (long j = -reach; j <= reach; ++j) {
+        for (long k = -reach; k <= reach; ++k) {
+          auto it = cells.find({cell[0] + i, cell[1] + j, cell[2] + k});
+          if (it == cells.end()) {
+            continue;
           }
-          if (toBeIncluded) {
-            addPair(shellPair, s2, shell2);
+          for (auto s2 : it->second) {
+            if (s2 > s1) {
+              continue;
+            }
+            const double maxDistance = extents[s1] + extents[s2];
+            if ((basis[s2].getShift() - center1).squaredNorm() <= maxDistance * maxDistance) {
+              candidates[s1].push_back(s2);
+            }
           }
         }
-        else {
-          addPair(shellPair, s2, shell2);
+      }
+    }
+    std::sort(candidates[s1].begin(), candidates[s1].end());
+  }
+  return candidates;
+}
+
+auto BasisSetHandler::moveBasisSet(const Utils::Integrals::BasisSet& basis, const Utils::AtomCollection& oldAtoms,
+                                   const Utils::AtomCollection& newAtoms, double displacementTolerance,
+                                   double threshold) -> Utils::Integrals::BasisSet {
+  if (oldAtoms.size() != newAtoms.size()) {
+    throw std::runtime_error("The number of atoms must not change when moving a basis set.");
+  }
+  auto shellToAtom = basis.shellToAtom(oldAtoms);
+  double maxDisplacement = 0.0;
+  for (int atom = 0; atom < oldAtoms.size(); ++atom) {
+    if (oldAtoms.getElement(atom) != newAtoms.getElement(atom)) {
+      throw std::runtime_error("The elements must not change when moving a basis set.");
+    }
+    maxDisplacement = std::max(maxDisplacement, (newAtoms.getPosition(atom) - oldAtoms.getPosition(atom)).norm());
+  }
+
+  Utils::Integrals::BasisSet newBasis(newAtoms);
+  for (size_t s = 0; s < basis.size(); ++s) {
+    const auto& shell = basis[s];
+    if (shellToAtom[s] < 0) {
+      throw std::runtime_error("Basis function not centered on any of the atoms.");
+    }
+    newBasis.emplace_back(shell.getVecAlpha(), shell.getVecCoeffs(), newAtoms.getPosition(shellToAtom[s]), shell.l(),
+                          shell.isPureSolid());
+  }
+  newBasis.setPureSpherical(basis.isPureSpherical());
+
+  if (!basis.areShellPairsEvaluated()) {
+    return newBasis;
+  }
+  // The flags of the existing shell pairs are kept. Without overlap prescreening, every shell has all partners.
+  const auto& oldShellPairs = *basis.getShellPairs();
+  const bool calculateCauchySchwarzFactor = oldShellPairs.hasCauchySchwarzFactor();
+  bool performOverlapPrescreening = false;
+  for (size_t s1 = 0; s1 < oldShellPairs.size(); ++s1) {
+    performOverlapPrescreening = performOverlapPrescreening || oldShellPairs[s1].size() != s1 + 1;
+  }
+  if (maxDisplacement > displacementTolerance) {
+    generateShellPairs(newBasis, performOverlapPrescreening, threshold, calculateCauchySchwarzFactor);
+    return newBasis;
+  }
+
+  // Only pairs that may overlap at the new positions are considered. Pairs that are no candidates any more are
+  // dropped without computing their overlap.
+  std::vector<std::vector<size_t>> candidates;
+  if (performOverlapPrescreening) {
+    candidates = shellPairCandidates(newBasis, threshold);
+  }
+  else {
+    candidates.resize(newBasis.size());
+    for (size_t s1 = 0; s1 < newBasis.size(); ++s1) {
+      candidates[s1].resize(s1 + 1);
+      std::iota(candidates[s1].begin(), candidates[s1].end(), 0);
+    }
+  }
+
+  auto shellPairs = std::make_shared<Utils::Integrals::ShellPairs>();
+  shellPairs->resize(newBasis.size());
+
+  std::vector<libint2::Shell> libintShells;
+  libintShells.reserve(newBasis.size());
+  for (auto const& shell : newBasis) {
+    libintShells.push_back(scineToLibint(shell));
+  }
+  // Change of the distance vector of a pair below which its overlap and Schwarz factor are kept, e.g. for rigid
+  // translations.
+  constexpr double relativeGeometryTolerance = 1e-10;
+
+#pragma omp parallel num_threads(Libint::getNumberOfThreads())
+  {
+    auto overlapEngine = Libint::leaseEngine(newBasis, libint2::Operator::overlap);
+    auto const& buffer = overlapEngine->results();
+    Libint::EngineLease coulombEngine;
+    if (calculateCauchySchwarzFactor) {
+      coulombEngine = Libint::leaseEngine(newBasis, libint2::Operator::coulomb);
+      // Important for Cauchy-Schwarz that no native screening is performed!!
+      coulombEngine->set_precision(0);
+    }
+
+#pragma omp for schedule(dynamic)
+    for (size_t s1 = 0; s1 < newBasis.size(); ++s1) {
+      const auto& shell1 = newBasis[s1];
+      const auto& oldPairs = oldShellPairs.at(s1);
+      Utils::Integrals::ShellPair shellPair(shell1, calculateCauchySchwarzFactor);
+      shellPair.reserve(oldPairs.size());
+
+      // Both the old pairs and the candidates are sorted by the second shell.
+      auto oldPair = oldPairs.begin();
+      for (size_t s2 : candidates[s1]) {
+        while (oldPair != oldPairs.end() && oldPair->secondShellIndex < s2) {
+          ++oldPair;
+        }
+        const bool wasPair = oldPair != oldPairs.end() && oldPair->secondShellIndex == s2;
+        const auto& shell2 = newBasis[s2];
+        const Utils::Displacement oldDistance = basis[s1].getShift() - basis[s2].getShift();
+        const Utils::Displacement newDistance = shell1.getShift() - shell2.getShift();
+        const bool relativeGeometryChanged =
+            (newDistance - oldDistance).squaredNorm() > relativeGeometryTolerance * relativeGeometryTolerance;
+
+        // The overlap only depends on the relative geometry, a pair can only cross the threshold if it changed.
+        bool toBeIncluded = wasPair || !performOverlapPrescreening || shell1.getShift() == shell2.getShift();
+        if (performOverlapPrescreening && relativeGeometryChanged && shell1.getShift() != shell2.getShift()) {
+          overlapEngine->compute(libintShells[s1], libintShells[s2]);
+          const double overlapNorm =
+              Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>(buffer[0], shell1.size(), shell2.size())
+                  .norm();
+          toBeIncluded = overlapNorm > threshold;
+        }
+        if (!toBeIncluded) {
+          continue;
+        }
+        // The Schwarz factor only depends on the relative geometry as well.
+        const bool keepFactor = wasPair && !relativeGeometryChanged;
+        auto newPair = makePair(s2, shell1, shell2, libintShells[s1], libintShells[s2],
+                                keepFactor ? nullptr : coulombEngine.get());
+        if (keepFactor) {
+          newPair.cauchySchwarzFactor = oldPair->cauchySchwarzFactor;
         }
+        shellPair.emplace_back(std::move(newPair));
       }
-      std::sort(shellPair.begin(), shellPair.end(),
-                [&](const Utils::Integrals::ShellPairData& first, const Utils::Integrals::ShellPairData& second) {
-                  return first.secondShellIndex < second.secondShellIndex;
-                });
-#pragma omp critical(shellPairAddition)
-      { shellPairs->at(s1) = std::move(shellPair); }
+      shellPairs->at(s1) = std::move(shellPair);
     }
   }
   shellPairs->setCauchySchwarzFactor(calculateCauchySchwarzFactor);
-
-  basis.setShellPairs(shellPairs);
+  newBasis.setShellPairs(shellPairs);
+  return newBasis;
 }
-void BasisSetHandler::addPair(Utils::Integrals::ShellPair& ShellPair, size_t secondShell, const Utils::Integrals::Shell& shell2,
-                              double ln_prec, const bool calculateCauchySchwarzFactor) {
+
+auto BasisSetHandler::makePair(size_t secondShell, const Utils::Integrals::Shell& shell1,
+                               const Utils::Integrals::Shell& shell2, const libint2::Shell& libintShell1,
+                               const libint2::Shell& libintShell2, libint2::Engine* coulombEngine, double ln_prec)
+    -> Utils::Integrals::ShellPairData {
   Utils::Integrals::ShellPairData newPair;
   newPair.secondShellIndex = secondShell;
-  const auto libintShell1 = scineToLibint(ShellPair.getShell());
-  const auto libintShell2 = scineToLibint(shell2);
-  newPair.precomputedShellPair = std::make_unique<Utils::Integrals::ShellPairType>(ShellPair.getShell(), shell2, ln_prec);
-
-  if (calculateCauchySchwarzFactor) {
-    Libint::getInstance();
+  newPair.precomputedShellPair = std::make_unique<Utils::Integrals::ShellPairType>(shell1, shell2, ln_prec);
 
+  if (coulombEngine != nullptr) {
     auto const shell1Size = libintShell1.size();
     auto const shell2Size = libintShell2.size();
-    libint2::Engine localEngine;
-#pragma omp critical(initializeLocalEngine)
-    {
-      localEngine = Libint::getEngine(libint2::Operator::coulomb, libintShell1, libintShell2, libintShell1, libintShell2);
-    }
-
-    // Important for Cauchy-Schwarz that no native screening is performed!!
-    localEngine.set_precision(0);
-    auto const& buffer = localEngine.results();
-    localEngine.compute2<libint2::Operator::coulomb, libint2::BraKet::xx_xx, 0>(libintShell1, libintShell2,
-                                                                                libintShell1, libintShell2);
+    auto const& buffer = coulombEngine->results();
+    coulombEngine->compute2<libint2::Operator::coulomb, libint2::BraKet::xx_xx, 0>(libintShell1, libintShell2,
+                                                                                   libintShell1, libintShell2);
     newPair.cauchySchwarzFactor =
         std::sqrt(Eigen::Map<const Eigen::MatrixXd>(buffer[0], shell1Size, shell2Size).cwiseAbs().maxCoeff());
   }
-#pragma omp critical(addDataToShell)
-  { ShellPair.emplace_back(std::move(newPair)); }
+  return newPair;
+}
+
+void BasisSetHandler::addPair(Utils::Integrals::ShellPair& ShellPair, size_t secondShell, const Utils::Integrals::Shell& shell2,
+                              double ln_prec, const bool calculateCauchySchwarzFactor) {
+  Libint::getInstance();
+  const auto libintShell1 = scineToLibint(ShellPair.getShell());
+  const auto libintShell2 = scineToLibint(shell2);
+  Libint::EngineLease localEngine;
+  if (calculateCauchySchwarzFactor) {
+    localEngine =
+        Libint::leaseEngine(libint2::Operator::coulomb, libintShell1, libintShell2, libintShell1, libintShell2);
+    // Important for Cauchy-Schwarz that no native screening is performed!!
+    localEngine->set_precision(0);
+  }
+  ShellPair.emplace_back(
+      makePair(secondShell, ShellPair.getShell(), shell2, libintShell1, libintShell2, localEngine.get(), ln_prec));
 }
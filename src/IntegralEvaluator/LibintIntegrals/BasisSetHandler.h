@@ -39,6 +39,15 @@ class BasisSetHandler {
    */
   static auto libintToScine(const libint2::BasisSet& libintBasis, const Utils::AtomCollection& atoms, const bool& pure_solid)
       -> Utils::Integrals::BasisSet;
+  /**
+   * @brief converts a list of libint shells, e.g. from the BasisSetLibrary, to a `Utils::Integrals::BasisSet` object.
+   * @param libintShells
+   * @param atoms
+   * @param pure_solid
+   * @return scineBasis
+   */
+  static auto libintToScine(const std::vector<libint2::Shell>& libintShells, const Utils::AtomCollection& atoms,
+                            const bool& pure_solid) -> Utils::Integrals::BasisSet;
 
   /**
    * @brief converts Scine `AtomCollection` to `vector<libint2::Atom>`
@@ -107,12 +116,69 @@ class BasisSetHandler {
   }
   /**
    * @brief Adds a shell interaction to a given shell.
+   * Converts the shells and constructs a Coulomb engine on every call. generateShellPairs() uses makePair() instead.
+   * The shell pair must not be modified concurrently.
    * @param ln_prec This is taken as suggested by the libint hartree-fock++.cc example file.
    */
   static void addPair(Utils::Integrals::ShellPair& ShellPair, size_t secondShell, const Utils::Integrals::Shell& shell2,
                       double ln_prec = std::log(std::numeric_limits<double>::epsilon() / 1e10),
                       bool calculateCauchySchwarzFactor = true);
 
+  /**
+   * @brief Creates the data of a shell interaction from already converted shells.
+   * @param coulombEngine Engine used for the Cauchy-Schwarz factor, no factor is computed if nullptr.
+   *                      Its precision must be set to 0 and it must not be shared among threads.
+   * @param ln_prec This is taken as suggested by the libint hartree-fock++.cc example file.
+   */
+  static auto makePair(size_t secondShell, const Utils::Integrals::Shell& shell1, const Utils::Integrals::Shell& shell2,
+                       const libint2::Shell& libintShell1, const libint2::Shell& libintShell2,
+                       libint2::Engine* coulombEngine,
+                       double ln_prec = std::log(std::numeric_limits<double>::epsilon() / 1e10))
+      -> Utils::Integrals::ShellPairData;
+
+  /**
+   * @brief Candidate partners s2 <= s1 of every shell s1 whose overlap may exceed `threshold`.
+   * The shell centers are sorted into a cell list with the largest extent as cell size, and every shell gets an
+   * analytic extent from its most diffuse exponent. Pairs farther apart than the sum of their extents are rejected
+   * without calling libint, all cells within that distance are searched. The cost therefore scales linearly with
+   * the size of the system.
+   * @return For every shell, the ascending indices of its candidate partners.
+   */
+  static auto shellPairCandidates(const Utils::Integrals::BasisSet& basis, double threshold)
+      -> std::vector<std::vector<size_t>>;
+
+  /**
+   * @brief Moves a basis set to new atom positions, e.g. in a geometry optimization or MD step.
+   *
+   * If no atom moved by more than `displacementTolerance`, the shell-pair list of `basis` is updated: only the
+   * candidates of shellPairCandidates() at the new positions whose distance vector changed are checked against
+   * `threshold`, and pairs are added or dropped accordingly. The primitive data are recomputed for all pairs, the
+   * Schwarz factors only for new pairs and pairs whose distance vector changed. Otherwise, the shell pairs are
+   * generated from scratch. Both keep the flags of the existing shell pairs (Cauchy-Schwarz factors, overlap
+   * prescreening) and give the pair list of generateShellPairs() at the new positions, such that consecutive updates,
+   * e.g. over the steps of an MD run, do not drift. The update pays off if many distance vectors stay the same, e.g.
+   * for rigid fragments.
+   * @param basis The basis set at the positions of `oldAtoms`.
+   * @param oldAtoms The atoms the basis set is currently centered on.
+   * @param newAtoms The same atoms at their new positions.
+   * @param displacementTolerance Largest atomic displacement for which the shell-pair list is updated instead of
+   *                              regenerated.
+   * @param threshold Overlap threshold of the shell pairs, as in generateShellPairs(). It must be the one the shell
+   *                  pairs of `basis` were generated with, which is not stored with them.
+   * @return The basis set at the new positions, with shell pairs if `basis` had them.
+   */
+  static auto moveBasisSet(const Utils::Integrals::BasisSet& basis, const Utils::AtomCollection& oldAtoms,
+                           const Utils::AtomCollection& newAtoms, double displacementTolerance = 0.1,
+                           double threshold = 1e-12) -> Utils::Integrals::BasisSet;
+
+  /**
+   * @brief Generates the shell pairs (s2 <= s1) of a basis in parallel.
+   * With overlap prescreening, only the candidates of shellPairCandidates() are checked with libint.
+   * The shells are converted once, every thread reuses one overlap and one Coulomb engine, and every shell pair
+   * is built by a single thread without locking.
+   * The Cauchy-Schwarz factors are only computed if `calculateCauchySchwarzFactor` is set, otherwise they are not
+   * set and ShellPairs::hasCauchySchwarzFactor() is false. Release 1.0.0 computed them regardless of the flag.
+   */
   static auto generateShellPairs(Utils::Integrals::BasisSet& scineBasis, bool performOverlapPrescreening = true,
                                  double threshold = 1e-12, bool calculateCauchySchwarzFactor = true) -> void;
 };
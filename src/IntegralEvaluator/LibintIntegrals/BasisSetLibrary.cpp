@@ -0,0 +1,73 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/BasisSetLibrary.h>
+#include <algorithm>
+#include <cctype>
+
+using namespace Scine;
+using namespace Integrals;
+
+auto BasisSetLibrary::key(const std::string& name, int atomicNumber) -> std::pair<std::string, int> {
+  std::string lowerCaseName = name;
+  std::transform(lowerCaseName.begin(), lowerCaseName.end(), lowerCaseName.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return {lowerCaseName, atomicNumber};
+}
+
+auto BasisSetLibrary::getShells(const std::string& name, int atomicNumber)
+    -> std::shared_ptr<const std::vector<libint2::Shell>> {
+  const auto cacheKey = key(name, atomicNumber);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = shells_.find(cacheKey);
+  if (it == shells_.end()) {
+    Libint::getInstance();
+    // A single atom at the origin; libint throws if the element is not part of the basis set.
+    std::vector<libint2::Atom> atom = {{atomicNumber, 0.0, 0.0, 0.0}};
+    libint2::BasisSet libintBasis(name, atom, true);
+    it = shells_
+             .emplace(cacheKey,
+                      std::make_shared<const std::vector<libint2::Shell>>(libintBasis.begin(), libintBasis.end()))
+             .first;
+  }
+  return it->second;
+}
+
+auto BasisSetLibrary::makeShells(const std::string& name, const std::vector<libint2::Atom>& atoms, bool pureSolid)
+    -> std::vector<libint2::Shell> {
+  std::vector<libint2::Shell> shells;
+  for (auto const& atom : atoms) {
+    // The shells are held by this function, a concurrent clear() only drops the cache's reference.
+    const auto elementShells = getShells(name, atom.atomic_number);
+    for (auto shell : *elementShells) {
+      for (auto& contraction : shell.contr) {
+        contraction.pure = pureSolid;
+      }
+      shell.move({{atom.x, atom.y, atom.z}});
+      shells.push_back(std::move(shell));
+    }
+  }
+  return shells;
+}
+
+void BasisSetLibrary::preload(const std::vector<std::string>& names, const std::vector<int>& atomicNumbers) {
+  for (auto const& name : names) {
+    for (auto const& atomicNumber : atomicNumbers) {
+      getShells(name, atomicNumber);
+    }
+  }
+}
+
+bool BasisSetLibrary::contains(const std::string& name, int atomicNumber) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return shells_.count(key(name, atomicNumber)) > 0;
+}
+
+void BasisSetLibrary::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  shells_.clear();
+}
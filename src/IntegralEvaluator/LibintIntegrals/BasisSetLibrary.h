@@ -0,0 +1,92 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_BASISSETLIBRARY_H
+#define INTEGRALEVALUATOR_BASISSETLIBRARY_H
+
+#include <LibintIntegrals/Libint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Scine {
+namespace Integrals {
+
+/**
+ * @class BasisSetLibrary @file BasisSetLibrary.h
+ * @brief Process-wide, thread-safe cache of parsed basis-set definitions.
+ *
+ * Libint parses the basis-set file whenever a basis set is constructed. This singleton keeps the shells of every
+ * (basis-set name, element) combination that was requested once, centered at the origin, such that subsequent basis
+ * sets are assembled by placing copies of the cached shells on the atoms.
+ */
+class BasisSetLibrary {
+ public:
+  /**
+   * Deleted functions needed for the singleton pattern.
+   * @{
+   */
+  BasisSetLibrary(const BasisSetLibrary&) = delete;
+  BasisSetLibrary& operator=(const BasisSetLibrary&) = delete;
+  //! @}
+
+  /**
+   * @brief Getter for the instance of the singleton.
+   */
+  static BasisSetLibrary& getInstance() {
+    static BasisSetLibrary library;
+    return library;
+  }
+
+  /**
+   * @brief The shells of an element in a basis set, centered at the origin. Parses the basis-set file on a miss.
+   * The returned shells are shared with the cache and remain valid if it is cleared concurrently.
+   * @param name The name of the basis set, e.g., def2-SVP.
+   * @param atomicNumber The atomic number of the element.
+   * @throws std::runtime_error if the basis set does not contain the element.
+   */
+  auto getShells(const std::string& name, int atomicNumber) -> std::shared_ptr<const std::vector<libint2::Shell>>;
+
+  /**
+   * @brief The shells of all atoms in a basis set, in the order of the atoms.
+   * @param name The name of the basis set.
+   * @param atoms The atoms.
+   * @param pureSolid Whether spherical (pure solid) harmonics are used.
+   */
+  auto makeShells(const std::string& name, const std::vector<libint2::Atom>& atoms, bool pureSolid)
+      -> std::vector<libint2::Shell>;
+
+  /**
+   * @brief Parses the given basis sets for the given elements, such that later requests do not touch the disk.
+   */
+  void preload(const std::vector<std::string>& names, const std::vector<int>& atomicNumbers);
+
+  /**
+   * @brief Whether the shells of an element in a basis set are cached.
+   */
+  bool contains(const std::string& name, int atomicNumber) const;
+
+  /**
+   * @brief Empties the cache.
+   */
+  void clear();
+
+ private:
+  BasisSetLibrary() = default;
+
+  static auto key(const std::string& name, int atomicNumber) -> std::pair<std::string, int>;
+
+  mutable std::mutex mutex_;
+  std::map<std::pair<std::string, int>, std::shared_ptr<const std::vector<libint2::Shell>>> shells_;
+};
+
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_BASISSETLIBRARY_H
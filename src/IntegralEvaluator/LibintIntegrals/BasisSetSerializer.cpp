@@ -0,0 +1,326 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/BasisSetSerializer.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+using namespace Scine;
+using namespace Integrals;
+
+namespace {
+constexpr char magic[8] = {'S', 'C', 'I', 'N', 'E', 'B', 'S', '\0'};
+constexpr std::uint32_t byteOrderMark = 0x01020304;
+constexpr std::uint32_t pureSphericalFlag = 1U << 0U;
+constexpr std::uint32_t shellPairsFlag = 1U << 1U;
+constexpr std::uint32_t cauchySchwarzFlag = 1U << 2U;
+
+struct Header {
+  char magic[8];
+  std::uint32_t byteOrder;
+  std::uint32_t version;
+  std::uint32_t flags;
+  std::uint32_t reserved;
+  std::uint64_t numberOfAtoms;
+  std::uint64_t numberOfShells;
+  std::uint64_t numberOfPrimitives;
+  std::uint64_t numberOfPairs;
+  std::uint64_t numberOfPrimitivePairs;
+  std::uint64_t atomsOffset;
+  std::uint64_t shellsOffset;
+  std::uint64_t primitivesOffset;
+  std::uint64_t pairListsOffset;
+  std::uint64_t pairsOffset;
+  std::uint64_t primitivePairsOffset;
+};
+
+struct AtomRecord {
+  std::uint32_t element;
+  std::uint32_t reserved;
+  double position[3];
+};
+
+struct ShellRecord {
+  std::uint32_t l;
+  std::uint32_t pure;
+  std::uint64_t firstPrimitive;
+  std::uint64_t numberOfPrimitives;
+  double shift[3];
+};
+
+struct PrimitiveRecord {
+  double alpha;
+  double coefficient;
+};
+
+// The pairs of shell s1 with s2 <= s1.
+struct PairListRecord {
+  std::uint64_t firstPair;
+  std::uint64_t numberOfPairs;
+};
+
+struct PairRecord {
+  std::uint64_t secondShellIndex;
+  double cauchySchwarzFactor;
+  std::uint64_t firstPrimitivePair;
+  std::uint64_t numberOfPrimitivePairs;
+  double AB[3];
+};
+
+struct PrimitivePairRecord {
+  double P[3];
+  double K;
+  double one_over_gamma;
+  double scr;
+  std::int32_t p1;
+  std::int32_t p2;
+};
+
+static_assert(sizeof(Header) % 8 == 0 && sizeof(AtomRecord) % 8 == 0 && sizeof(ShellRecord) % 8 == 0 &&
+                  sizeof(PrimitiveRecord) % 8 == 0 && sizeof(PairListRecord) % 8 == 0 && sizeof(PairRecord) % 8 == 0 &&
+                  sizeof(PrimitivePairRecord) % 8 == 0,
+              "All records must keep the sections 8-byte aligned.");
+
+template<class Record>
+void writeSection(std::ostream& out, const std::vector<Record>& records) {
+  out.write(reinterpret_cast<const char*>(records.data()),
+            static_cast<std::streamsize>(records.size() * sizeof(Record)));
+}
+
+template<class Record>
+auto readSection(const char* data, std::size_t size, std::uint64_t offset, std::uint64_t count) -> std::vector<Record> {
+  if (offset > size || count > (size - offset) / sizeof(Record)) {
+    throw std::runtime_error("Truncated basis set file.");
+  }
+  std::vector<Record> records(count);
+  // memcpy, such that the buffer does not have to be aligned.
+  std::memcpy(records.data(), data + offset, count * sizeof(Record));
+  return records;
+}
+
+auto readHeader(const char* data, std::size_t size) -> Header {
+  Header header;
+  if (size < sizeof(Header)) {
+    throw std::runtime_error("Truncated basis set file.");
+  }
+  std::memcpy(&header, data, sizeof(Header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+    throw std::runtime_error("Not a basis set file.");
+  }
+  if (header.byteOrder != byteOrderMark) {
+    throw std::runtime_error("Basis set file was written with a different byte order.");
+  }
+  if (header.version != BasisSetSerializer::version) {
+    throw std::runtime_error("Unsupported basis set file version " + std::to_string(header.version) + ".");
+  }
+  return header;
+}
+
+auto readFile(const std::string& path) -> std::vector<char> {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Cannot open basis set file " + path + ".");
+  }
+  return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+} // namespace
+
+void BasisSetSerializer::write(const Utils::Integrals::BasisSet& basis, const Utils::AtomCollection& atoms,
+                               std::ostream& out) {
+  Header header{};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.byteOrder = byteOrderMark;
+  header.version = version;
+
+  std::vector<AtomRecord> atomRecords;
+  for (int i = 0; i < atoms.size(); ++i) {
+    const auto& position = atoms.getPosition(i);
+    atomRecords.push_back(
+        {static_cast<std::uint32_t>(atoms.getElement(i)), 0, {position[0], position[1], position[2]}});
+  }
+
+  std::vector<ShellRecord> shellRecords;
+  std::vector<PrimitiveRecord> primitiveRecords;
+  for (auto const& shell : basis) {
+    const auto& alphas = shell.getVecAlpha();
+    const auto& coefficients = shell.getVecCoeffs();
+    if (alphas.size() != coefficients.size()) {
+      throw std::runtime_error("Only shells with one coefficient per primitive can be stored.");
+    }
+    const auto& shift = shell.getShift();
+    shellRecords.push_back({static_cast<std::uint32_t>(shell.l()),
+                            static_cast<std::uint32_t>(shell.isPureSolid()),
+                            primitiveRecords.size(),
+                            alphas.size(),
+                            {shift[0], shift[1], shift[2]}});
+    for (std::size_t p = 0; p < alphas.size(); ++p) {
+      primitiveRecords.push_back({alphas[p], coefficients[p]});
+    }
+  }
+
+  std::vector<PairListRecord> pairListRecords;
+  std::vector<PairRecord> pairRecords;
+  std::vector<PrimitivePairRecord> primitivePairRecords;
+  header.flags = basis.isPureSpherical() ? pureSphericalFlag : 0;
+  if (basis.areShellPairsEvaluated()) {
+    const auto& shellPairs = *basis.getShellPairs();
+    header.flags |= shellPairsFlag;
+    if (shellPairs.hasCauchySchwarzFactor()) {
+      header.flags |= cauchySchwarzFlag;
+    }
+    for (auto const& shellPair : shellPairs) {
+      pairListRecords.push_back({pairRecords.size(), shellPair.size()});
+      for (auto const& pairData : shellPair) {
+        const auto& precomputed = *pairData.precomputedShellPair;
+        pairRecords.push_back({pairData.secondShellIndex,
+                               pairData.cauchySchwarzFactor,
+                               primitivePairRecords.size(),
+                               precomputed.primpairs.size(),
+                               {precomputed.AB[0], precomputed.AB[1], precomputed.AB[2]}});
+        for (auto const& primPair : precomputed.primpairs) {
+          primitivePairRecords.push_back({{primPair.P[0], primPair.P[1], primPair.P[2]},
+                                          primPair.K,
+                                          primPair.one_over_gamma,
+                                          primPair.scr,
+                                          primPair.p1,
+                                          primPair.p2});
+        }
+      }
+    }
+  }
+
+  header.numberOfAtoms = atomRecords.size();
+  header.numberOfShells = shellRecords.size();
+  header.numberOfPrimitives = primitiveRecords.size();
+  header.numberOfPairs = pairRecords.size();
+  header.numberOfPrimitivePairs = primitivePairRecords.size();
+  header.atomsOffset = sizeof(Header);
+  header.shellsOffset = header.atomsOffset + atomRecords.size() * sizeof(AtomRecord);
+  header.primitivesOffset = header.shellsOffset + shellRecords.size() * sizeof(ShellRecord);
+  header.pairListsOffset = header.primitivesOffset + primitiveRecords.size() * sizeof(PrimitiveRecord);
+  header.pairsOffset = header.pairListsOffset + pairListRecords.size() * sizeof(PairListRecord);
+  header.primitivePairsOffset = header.pairsOffset + pairRecords.size() * sizeof(PairRecord);
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  writeSection(out, atomRecords);
+  writeSection(out, shellRecords);
+  writeSection(out, primitiveRecords);
+  writeSection(out, pairListRecords);
+  writeSection(out, pairRecords);
+  writeSection(out, primitivePairRecords);
+  if (!out) {
+    throw std::runtime_error("Writing the basis set failed.");
+  }
+}
+
+void BasisSetSerializer::save(const Utils::Integrals::BasisSet& basis, const Utils::AtomCollection& atoms,
+                              const std::string& path) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Cannot open basis set file " + path + ".");
+  }
+  write(basis, atoms, out);
+}
+
+auto BasisSetSerializer::atomsFromBuffer(const char* data, std::size_t size) -> Utils::AtomCollection {
+  const auto header = readHeader(data, size);
+  const auto atomRecords = readSection<AtomRecord>(data, size, header.atomsOffset, header.numberOfAtoms);
+  Utils::ElementTypeCollection elements;
+  Utils::PositionCollection positions(atomRecords.size(), 3);
+  for (std::size_t i = 0; i < atomRecords.size(); ++i) {
+    elements.push_back(static_cast<Utils::ElementType>(atomRecords[i].element));
+    positions.row(i) << atomRecords[i].position[0], atomRecords[i].position[1], atomRecords[i].position[2];
+  }
+  return Utils::AtomCollection(elements, positions);
+}
+
+auto BasisSetSerializer::fromBuffer(const char* data, std::size_t size) -> Utils::Integrals::BasisSet {
+  const auto header = readHeader(data, size);
+  const auto shellRecords = readSection<ShellRecord>(data, size, header.shellsOffset, header.numberOfShells);
+  const auto primitiveRecords =
+      readSection<PrimitiveRecord>(data, size, header.primitivesOffset, header.numberOfPrimitives);
+
+  Utils::Integrals::BasisSet basis(atomsFromBuffer(data, size));
+  for (auto const& shellRecord : shellRecords) {
+    if (shellRecord.firstPrimitive + shellRecord.numberOfPrimitives > primitiveRecords.size()) {
+      throw std::runtime_error("Corrupted basis set file.");
+    }
+    std::vector<double> alphas;
+    std::vector<double> coefficients;
+    for (auto p = shellRecord.firstPrimitive; p < shellRecord.firstPrimitive + shellRecord.numberOfPrimitives; ++p) {
+      alphas.push_back(primitiveRecords[p].alpha);
+      coefficients.push_back(primitiveRecords[p].coefficient);
+    }
+    Utils::Displacement shift;
+    shift << shellRecord.shift[0], shellRecord.shift[1], shellRecord.shift[2];
+    basis.emplace_back(alphas, coefficients, shift, shellRecord.l, shellRecord.pure != 0);
+  }
+  basis.setPureSpherical((header.flags & pureSphericalFlag) != 0);
+
+  if ((header.flags & shellPairsFlag) == 0) {
+    return basis;
+  }
+  const auto pairListRecords = readSection<PairListRecord>(data, size, header.pairListsOffset, header.numberOfShells);
+  const auto pairRecords = readSection<PairRecord>(data, size, header.pairsOffset, header.numberOfPairs);
+  const auto primitivePairRecords =
+      readSection<PrimitivePairRecord>(data, size, header.primitivePairsOffset, header.numberOfPrimitivePairs);
+
+  const bool hasCauchySchwarzFactor = (header.flags & cauchySchwarzFlag) != 0;
+  auto shellPairs = std::make_shared<Utils::Integrals::ShellPairs>();
+  shellPairs->reserve(basis.size());
+  for (std::size_t s1 = 0; s1 < basis.size(); ++s1) {
+    const auto& pairList = pairListRecords[s1];
+    if (pairList.firstPair + pairList.numberOfPairs > pairRecords.size()) {
+      throw std::runtime_error("Corrupted basis set file.");
+    }
+    Utils::Integrals::ShellPair shellPair(basis[s1], hasCauchySchwarzFactor);
+    shellPair.reserve(pairList.numberOfPairs);
+    for (auto p = pairList.firstPair; p < pairList.firstPair + pairList.numberOfPairs; ++p) {
+      const auto& pairRecord = pairRecords[p];
+      if (pairRecord.secondShellIndex >= basis.size() ||
+          pairRecord.firstPrimitivePair + pairRecord.numberOfPrimitivePairs > primitivePairRecords.size()) {
+        throw std::runtime_error("Corrupted basis set file.");
+      }
+      Utils::Integrals::ShellPairData pairData;
+      pairData.secondShellIndex = pairRecord.secondShellIndex;
+      pairData.cauchySchwarzFactor = pairRecord.cauchySchwarzFactor;
+      pairData.precomputedShellPair = std::make_unique<Utils::Integrals::ShellPairType>();
+      auto& precomputed = *pairData.precomputedShellPair;
+      std::copy(std::begin(pairRecord.AB), std::end(pairRecord.AB), std::begin(precomputed.AB));
+      precomputed.primpairs.reserve(pairRecord.numberOfPrimitivePairs);
+      for (auto pp = pairRecord.firstPrimitivePair;
+           pp < pairRecord.firstPrimitivePair + pairRecord.numberOfPrimitivePairs; ++pp) {
+        const auto& record = primitivePairRecords[pp];
+        precomputed.primpairs.push_back({{record.P[0], record.P[1], record.P[2]},
+                                         record.K,
+                                         record.one_over_gamma,
+                                         record.scr,
+                                         record.p1,
+                                         record.p2});
+      }
+      shellPair.emplace_back(std::move(pairData));
+    }
+    shellPairs->emplace_back(std::move(shellPair));
+  }
+  shellPairs->setCauchySchwarzFactor(hasCauchySchwarzFactor);
+  basis.setShellPairs(std::move(shellPairs));
+  return basis;
+}
+
+auto BasisSetSerializer::read(std::istream& in) -> Utils::Integrals::BasisSet {
+  const std::vector<char> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  return fromBuffer(buffer.data(), buffer.size());
+}
+
+auto BasisSetSerializer::load(const std::string& path) -> Utils::Integrals::BasisSet {
+  const auto buffer = readFile(path);
+  return fromBuffer(buffer.data(), buffer.size());
+}
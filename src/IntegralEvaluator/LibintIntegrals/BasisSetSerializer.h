@@ -0,0 +1,57 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_BASISSETSERIALIZER_H
+#define INTEGRALEVALUATOR_BASISSETSERIALIZER_H
+
+#include <Utils/DataStructures/BasisSet.h>
+#include <Utils/Geometry/AtomCollection.h>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace Scine {
+namespace Integrals {
+
+/**
+ * @class BasisSetSerializer @file BasisSetSerializer.h
+ * @brief Binary storage of a basis set together with its shell pairs.
+ *
+ * The format consists of a fixed-size header followed by sections of fixed-size records (atoms, shells, primitives,
+ * shell pairs, primitive pairs). All sections are 8-byte aligned and addressed through offsets stored in the header,
+ * such that a file can be memory mapped and read in place with fromBuffer(). Data are stored in native byte order;
+ * files written on a machine with a different byte order are rejected.
+ */
+class BasisSetSerializer {
+ public:
+  //! Incremented whenever the layout changes. Files of another version are rejected.
+  static constexpr std::uint32_t version = 1;
+
+  /**
+   * @brief Writes the basis set, its atoms and, if evaluated, its shell pairs.
+   */
+  static void write(const Utils::Integrals::BasisSet& basis, const Utils::AtomCollection& atoms, std::ostream& out);
+  static void save(const Utils::Integrals::BasisSet& basis, const Utils::AtomCollection& atoms, const std::string& path);
+
+  /**
+   * @brief Restores a basis set, including its shell pairs if they were stored.
+   * @throws std::runtime_error if the data are not a basis set of this version.
+   */
+  static auto fromBuffer(const char* data, std::size_t size) -> Utils::Integrals::BasisSet;
+  static auto read(std::istream& in) -> Utils::Integrals::BasisSet;
+  static auto load(const std::string& path) -> Utils::Integrals::BasisSet;
+
+  /**
+   * @brief Restores the atoms stored with a basis set.
+   */
+  static auto atomsFromBuffer(const char* data, std::size_t size) -> Utils::AtomCollection;
+};
+
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_BASISSETSERIALIZER_H
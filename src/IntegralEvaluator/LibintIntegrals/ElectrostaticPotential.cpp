@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/BasisSetHandler.h>
+#include <LibintIntegrals/ElectrostaticPotential.h>
+#include <LibintIntegrals/Libint.h>
+#include <Utils/DataStructures/DensityMatrix.h>
+
+using namespace Scine;
+using namespace Integrals;
+
+ElectrostaticPotential::ElectrostaticPotential(const Utils::Integrals::BasisSet& basis, const Utils::DensityMatrix& density,
+                                               const Utils::PositionCollection& points, bool computeField,
+                                               double densityThreshold)
+  : basis_(basis), density_(density), points_(points), computeField_(computeField), densityThreshold_(densityThreshold) {
+  if (!basis_.areShellPairsEvaluated()) {
+    throw std::runtime_error("Evaluate shell pairs before performing the electrostatic potential evaluation!");
+  }
+  if (density_.restrictedMatrix().rows() != static_cast<Eigen::Index>(basis_.nbf()) ||
+      density_.restrictedMatrix().cols() != static_cast<Eigen::Index>(basis_.nbf())) {
+    throw std::runtime_error("Density matrix does not match the basis set.");
+  }
+  result_.potential = Eigen::VectorXd::Zero(points_.rows());
+  if (computeField_) {
+    result_.field = Utils::GradientCollection::Zero(points_.rows(), 3);
+  }
+}
+
+auto ElectrostaticPotential::compute() -> void {
+  const auto& D = density_.restrictedMatrix();
+  auto shellPairs = basis_.getShellPairs();
+  auto shell2bf = basis_.shell2bf();
+
+  std::vector<libint2::Shell> libintShells;
+  libintShells.reserve(basis_.size());
+  for (auto const& shell : basis_) {
+    libintShells.push_back(BasisSetHandler::scineToLibint(shell));
+  }
+
+  // The significant shell pairs (s2 <= s1) with the density block they are contracted with.
+  // Off-diagonal pairs count twice since the density is symmetric.
+  struct Pair {
+    std::size_t s1;
+    std::size_t s2;
+    double factor;
+  };
+  std::vector<Pair> pairs;
+  for (std::size_t s1 = 0; s1 < shellPairs->size(); ++s1) {
+    const auto bf1 = shell2bf[s1];
+    const auto n1 = basis_[s1].size();
+    for (auto const& shellPair : shellPairs->at(s1)) {
+      const auto s2 = shellPair.secondShellIndex;
+      const auto bf2 = shell2bf[s2];
+      const auto n2 = basis_[s2].size();
+      if (D.block(bf1, bf2, n1, n2).cwiseAbs().maxCoeff() < densityThreshold_) {
+        continue;
+      }
+      pairs.push_back({s1, s2, (s1 == s2) ? 1.0 : 2.0});
+    }
+  }
+
+  const auto numberOfPoints = static_cast<std::size_t>(points_.rows());
+
+#pragma omp parallel num_threads(Libint::getNumberOfThreads())
+  {
+    auto valueEngine = Libint::leaseEngine(basis_, libint2::Operator::nuclear, 0);
+    Libint::EngineLease fieldEngine;
+    if (computeField_) {
+      fieldEngine = Libint::leaseEngine(basis_, libint2::Operator::nuclear, 1);
+    }
+    std::vector<std::pair<double, std::array<double, 3>>> unitCharge = {{1.0, {0.0, 0.0, 0.0}}};
+
+#pragma omp for schedule(dynamic)
+    for (std::size_t g = 0; g < numberOfPoints; ++g) {
+      unitCharge[0].second = {points_(g, 0), points_(g, 1), points_(g, 2)};
+      valueEngine->set_params(unitCharge);
+      if (computeField_) {
+        fieldEngine->set_params(unitCharge);
+      }
+
+      // libint's nuclear operator with a unit charge at R_g yields -<mu|1/|r-R_g||nu>, i.e. the potential of a
+      // negative unit charge distribution. Its derivatives with respect to R_g are the buffers 6, 7, 8.
+      double potential = 0.0;
+      std::array<double, 3> field = {0.0, 0.0, 0.0};
+      for (auto const& pair : pairs) {
+        const auto& shell1 = libintShells[pair.s1];
+        const auto& shell2 = libintShells[pair.s2];
+        const auto n1 = shell1.size();
+        const auto n2 = shell2.size();
+        const auto densityBlock = D.block(shell2bf[pair.s1], shell2bf[pair.s2], n1, n2);
+
+        const auto& values = valueEngine->compute(shell1, shell2);
+        if (values[0] != nullptr) {
+          potential += pair.factor *
+                       (densityBlock.array() *
+                        Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>(values[0], n1, n2).array())
+                           .sum();
+        }
+        if (computeField_) {
+          const auto& derivatives = fieldEngine->compute(shell1, shell2);
+          for (int k = 0; k < 3; ++k) {
+            if (derivatives[6 + k] == nullptr) {
+              continue;
+            }
+            field[k] -= pair.factor * (densityBlock.array() * Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>(
+                                                                  derivatives[6 + k], n1, n2)
+                                                                  .array())
+                                          .sum();
+          }
+        }
+      }
+
+      result_.potential[g] = potential;
+      if (computeField_) {
+        result_.field.row(g) << field[0], field[1], field[2];
+      }
+    }
+  }
+}
+
+auto ElectrostaticPotential::getResult() -> GridPotential {
+  return std::move(result_);
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_ELECTROSTATICPOTENTIAL_H
+#define INTEGRALEVALUATOR_ELECTROSTATICPOTENTIAL_H
+
+/* external */
+#include <Utils/DataStructures/BasisSet.h>
+#include <Utils/Typenames.h>
+#include <Eigen/Core>
+
+namespace Scine {
+namespace Utils {
+class DensityMatrix;
+} // namespace Utils
+namespace Integrals {
+
+/**
+ * @brief Electrostatic potential and electric field of a charge density at a set of grid points.
+ */
+struct GridPotential {
+  //! The potential at every point.
+  Eigen::VectorXd potential;
+  //! The electric field at every point, empty if it was not requested.
+  Utils::GradientCollection field;
+};
+
+/**
+ * @class ElectrostaticPotential
+ * This class computes the electrostatic potential of an electronic density, and optionally its electric field, at
+ * many points in one parallel pass.
+ *
+ * The points are distributed among the threads. For every point, the integrals \f$ \langle\mu|1/|r-R_g||\nu\rangle \f$
+ * of the significant shell pairs of the basis are contracted with the density block by block, such that no matrix
+ * of the size of the basis is ever built per point.
+ */
+class ElectrostaticPotential {
+ public:
+  /**
+   * @brief Constructor.
+   * @param basis The basis, the shell pairs must have been generated.
+   * @param density The (restricted, i.e. total) density matrix of the electrons.
+   * @param points The grid points.
+   * @param computeField Whether the electric field is evaluated as well.
+   * @param densityThreshold Shell pairs whose density block is below this threshold are skipped.
+   */
+  ElectrostaticPotential(const Utils::Integrals::BasisSet& basis, const Utils::DensityMatrix& density,
+                         const Utils::PositionCollection& points, bool computeField = false,
+                         double densityThreshold = 1e-14);
+
+  /**
+   * @brief Do the actual computation
+   */
+  auto compute() -> void;
+
+  /**
+   * @brief After `compute` has been called, the result can be retrieved with this method.
+   */
+  auto getResult() -> GridPotential;
+
+ private:
+  const Utils::Integrals::BasisSet& basis_;
+  const Utils::DensityMatrix& density_;
+  const Utils::PositionCollection& points_;
+  bool computeField_;
+  double densityThreshold_;
+  GridPotential result_;
+};
+
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_ELECTROSTATICPOTENTIAL_H
@@ -2,18 +2,32 @@ set(LIBINTINTEGRALS_HEADERS
         LibintIntegrals/LibintIntegrals.h
         LibintIntegrals/Libint.h
         LibintIntegrals/BasisSetHandler.h
+        LibintIntegrals/BasisSetLibrary.h
+        LibintIntegrals/BasisSetSerializer.h
         LibintIntegrals/OneBodyIntegrals.h
         LibintIntegrals/IntegralEvaluatorSettings.h
+        LibintIntegrals/ElectrostaticPotential.h
+        LibintIntegrals/IntegralTensor.h
+        LibintIntegrals/IntegralSession.h
+        LibintIntegrals/PointChargeIntegrals.h
+        LibintIntegrals/PointChargeOctree.h
+        LibintIntegrals/ShellReordering.h
         LibintIntegrals/TwoBodyIntegrals/Digester.h
         LibintIntegrals/TwoBodyIntegrals/Evaluator.h
+        LibintIntegrals/TwoBodyIntegrals/LibintBasis.h
         LibintIntegrals/TwoBodyIntegrals/Prescreener.h
+        LibintIntegrals/TwoBodyIntegrals/QuartetScheduler.h
         LibintIntegrals/TwoBodyIntegrals/SaverDigester.h
         LibintIntegrals/TwoBodyIntegrals/SymmetryHelper.h
         LibintIntegrals/TwoBodyIntegrals/VoidPrescreener.h
         LibintIntegrals/TwoBodyIntegrals/COMSaverDigester.h
         LibintIntegrals/TwoBodyIntegrals/CauchySchwarzDensityPrescreener.h
+        LibintIntegrals/TwoBodyIntegrals/TwoTypeCauchySchwarzPrescreener.h
+        LibintIntegrals/TwoBodyIntegrals/HartreeFock/CenterOfMassCorrection.h
         LibintIntegrals/TwoBodyIntegrals/HartreeFock/CoulombExchangeDigester.h
         LibintIntegrals/TwoBodyIntegrals/HartreeFock/CoulombExchangeConstructor.h
+        LibintIntegrals/TwoBodyIntegrals/HartreeFock/DirectFockBuilder.h
+        LibintIntegrals/TwoBodyIntegrals/HartreeFock/MultiComponentCoulombBuilder.h
         LibintIntegrals/TwoBodyIntegrals/HartreeFock/TwoTypeCoulombDigester.h
         LibintIntegrals/TwoBodyIntegrals/HartreeFock/TwoTypeCoulombConstructor.h
         )
@@ -21,13 +35,27 @@ set(LIBINTINTEGRALS_HEADERS
 set(LIBINTINTEGRALS_SOURCES
         LibintIntegrals/LibintIntegrals.cpp
         LibintIntegrals/BasisSetHandler.cpp
+        LibintIntegrals/BasisSetLibrary.cpp
+        LibintIntegrals/BasisSetSerializer.cpp
         LibintIntegrals/OneBodyIntegrals.cpp
+        LibintIntegrals/ElectrostaticPotential.cpp
+        LibintIntegrals/IntegralTensor.cpp
+        LibintIntegrals/IntegralSession.cpp
+        LibintIntegrals/PointChargeIntegrals.cpp
+        LibintIntegrals/PointChargeOctree.cpp
+        LibintIntegrals/ShellReordering.cpp
         LibintIntegrals/Libint.cpp
+        LibintIntegrals/TwoBodyIntegrals/LibintBasis.cpp
+        LibintIntegrals/TwoBodyIntegrals/QuartetScheduler.cpp
         LibintIntegrals/TwoBodyIntegrals/SaverDigester.cpp
         LibintIntegrals/TwoBodyIntegrals/COMSaverDigester.cpp
         LibintIntegrals/TwoBodyIntegrals/CauchySchwarzDensityPrescreener.cpp
+        LibintIntegrals/TwoBodyIntegrals/TwoTypeCauchySchwarzPrescreener.cpp
+        LibintIntegrals/TwoBodyIntegrals/HartreeFock/CenterOfMassCorrection.cpp
         LibintIntegrals/TwoBodyIntegrals/HartreeFock/CoulombExchangeDigester.cpp
         LibintIntegrals/TwoBodyIntegrals/HartreeFock/CoulombExchangeConstructor.cpp
+        LibintIntegrals/TwoBodyIntegrals/HartreeFock/DirectFockBuilder.cpp
+        LibintIntegrals/TwoBodyIntegrals/HartreeFock/MultiComponentCoulombBuilder.cpp
         LibintIntegrals/TwoBodyIntegrals/HartreeFock/TwoTypeCoulombDigester.cpp
         LibintIntegrals/TwoBodyIntegrals/HartreeFock/TwoTypeCoulombConstructor.cpp
         )
@@ -0,0 +1,183 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#include <LibintIntegrals/IntegralSession.h>
+#include <LibintIntegrals/Libint.h>
+#include <LibintIntegrals/TwoBodyIntegrals/Evaluator.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/DirectFockBuilder.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/TwoTypeCoulombDigester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/LibintBasis.h>
+#include <LibintIntegrals/TwoBodyIntegrals/TwoTypeCauchySchwarzPrescreener.h>
+#include <Utils/DataStructures/DensityMatrix.h>
+#include <algorithm>
+#include <limits>
+
+namespace Scine {
+namespace Integrals {
+
+namespace {
+auto maxDisplacement(const Utils::AtomCollection& from, const Utils::AtomCollection& to) -> double {
+  if (from.size() != to.size()) {
+    throw std::runtime_error("The number of atoms must not change when moving a basis set.");
+  }
+  double displacement = 0.0;
+  for (int atom = 0; atom < from.size(); ++atom) {
+    displacement = std::max(displacement, (to.getPosition(atom) - from.getPosition(atom)).norm());
+  }
+  return displacement;
+}
+} // namespace
+
+IntegralSession::IntegralSession(Utils::Integrals::BasisSet basis, Utils::AtomCollection atoms,
+                                 Utils::Integrals::ParticleType particleType, double prescreeningThreshold)
+  : basis_(std::move(basis)),
+    atoms_(std::move(atoms)),
+    particleType_(std::move(particleType)),
+    prescreeningThreshold_(prescreeningThreshold) {
+  Libint::getInstance();
+  if (!basis_.areShellPairsEvaluated()) {
+    LibintIntegrals::generateShellPairs(basis_);
+  }
+  resetBasisData();
+}
+
+IntegralSession::~IntegralSession() = default;
+
+const Utils::Integrals::BasisSet& IntegralSession::getBasis() const {
+  return basis_;
+}
+
+const Utils::AtomCollection& IntegralSession::getAtoms() const {
+  return atoms_;
+}
+
+const Utils::Integrals::ParticleType& IntegralSession::getParticleType() const {
+  return particleType_;
+}
+
+auto IntegralSession::overlap() -> const Eigen::MatrixXd& {
+  if (overlap_.size() == 0) {
+    Libint::ThreadCountScope threadCount(numberThreads_);
+    Utils::Integrals::IntegralSpecifier specifier;
+    specifier.op = Utils::Integrals::Operator::Overlap;
+    specifier.typeVector = {particleType_};
+    overlap_ = LibintIntegrals::evaluateTensor(specifier, basis_, basis_).matrix(0);
+  }
+  return overlap_;
+}
+
+auto IntegralSession::coreHamiltonian() -> const Eigen::MatrixXd& {
+  if (coreHamiltonian_.size() == 0) {
+    Libint::ThreadCountScope threadCount(numberThreads_);
+    std::vector<Utils::Integrals::IntegralSpecifier> specifiers(2);
+    specifiers[0].op = Utils::Integrals::Operator::Kinetic;
+    specifiers[0].typeVector = {particleType_};
+    specifiers[1].op = Utils::Integrals::Operator::PointCharges;
+    specifiers[1].typeVector = {particleType_};
+    specifiers[1].atoms = atoms_;
+    coreHamiltonian_ = LibintIntegrals::evaluateOneBodySum(specifiers, basis_, basis_).matrix(0);
+  }
+  return coreHamiltonian_;
+}
+
+auto IntegralSession::oneBody(const std::vector<Utils::Integrals::IntegralSpecifier>& specifiers) const
+    -> std::vector<IntegralTensor> {
+  Libint::ThreadCountScope threadCount(numberThreads_);
+  return LibintIntegrals::evaluateOneBodyOperators(specifiers, basis_, basis_);
+}
+
+auto IntegralSession::oneBodyGradient(Utils::Integrals::IntegralSpecifier specifier,
+                                      const Eigen::MatrixXd& density) const -> Utils::GradientCollection {
+  Libint::ThreadCountScope threadCount(numberThreads_);
+  if (specifier.op == Utils::Integrals::Operator::PointCharges) {
+    specifier.atoms = atoms_;
+  }
+  return LibintIntegrals::evaluateOneBodyGradient(specifier, basis_, density, atoms_);
+}
+
+void IntegralSession::coulombExchange(const Utils::DensityMatrix& density,
+                                      std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& coulombExchange) {
+  Libint::ThreadCountScope threadCount(numberThreads_);
+  if (!fockBuilder_) {
+    fockBuilder_ = std::make_unique<TwoBody::DirectFockBuilder>(basis_, twoBodySpecifier(particleType_),
+                                                                prescreeningThreshold_, libintBasis_);
+  }
+  fockBuilder_->compute(density, coulombExchange);
+}
+
+auto IntegralSession::coulombWith(const Utils::DensityMatrix& density, const IntegralSession& other,
+                                  const Utils::DensityMatrix& otherDensity) const
+    -> std::pair<Eigen::MatrixXd, Eigen::MatrixXd> {
+  Libint::ThreadCountScope threadCount(numberThreads_);
+  // As LibintIntegrals::evaluateTwoBodyDirectPreBo(), with the libint conversions of both sessions.
+  const auto specifier = twoBodySpecifier(other.particleType_);
+  if (specifier.typeVector.at(0).symbol == specifier.typeVector.at(1).symbol) {
+    throw std::runtime_error("coulombWith requires sessions of different particle types.");
+  }
+  auto prescreener = TwoBody::TwoTypeCauchySchwarzPrescreener(basis_, other.basis_, density, otherDensity,
+                                                              prescreeningThreshold_);
+  auto digester = TwoBody::TwoTypeCoulombDigester(basis_, other.basis_, specifier, density, otherDensity);
+  auto evaluator = TwoBody::Evaluator<TwoBody::TwoTypeCoulombDigester, TwoBody::TwoTypeCauchySchwarzPrescreener>(
+      basis_, other.basis_, specifier, std::move(digester), std::move(prescreener));
+  evaluator.setLibintBases(libintBasis_, other.libintBasis_);
+  evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+  return evaluator.takeResult();
+}
+
+void IntegralSession::updateGeometry(const Utils::AtomCollection& atoms, double displacementTolerance) {
+  Libint::ThreadCountScope threadCount(numberThreads_);
+  // The decision is taken with respect to the geometry of the last generation instead of the previous step: a
+  // negative tolerance always regenerates, an infinite one always keeps the shell pairs.
+  const bool regenerate = maxDisplacement(pairReferenceAtoms_, atoms) > displacementTolerance;
+  const double tolerance = regenerate ? -1.0 : std::numeric_limits<double>::infinity();
+  basis_ = LibintIntegrals::moveBasisSet(basis_, atoms_, atoms, tolerance);
+  atoms_ = atoms;
+  if (regenerate) {
+    pairReferenceAtoms_ = atoms_;
+  }
+  libintBasis_ = std::make_shared<const TwoBody::LibintBasis>(basis_);
+  invalidate();
+}
+
+void IntegralSession::setBasis(Utils::Integrals::BasisSet basis, Utils::AtomCollection atoms) {
+  Libint::ThreadCountScope threadCount(numberThreads_);
+  basis_ = std::move(basis);
+  atoms_ = std::move(atoms);
+  if (!basis_.areShellPairsEvaluated()) {
+    LibintIntegrals::generateShellPairs(basis_);
+  }
+  resetBasisData();
+  invalidate();
+}
+
+void IntegralSession::setNumberOfThreads(int numberThreads) {
+  if (numberThreads < 0) {
+    throw std::invalid_argument("The number of threads must not be negative.");
+  }
+  numberThreads_ = numberThreads;
+}
+
+void IntegralSession::invalidate() {
+  overlap_.resize(0, 0);
+  coreHamiltonian_.resize(0, 0);
+  fockBuilder_.reset();
+}
+
+void IntegralSession::resetBasisData() {
+  pairReferenceAtoms_ = atoms_;
+  libintBasis_ = std::make_shared<const TwoBody::LibintBasis>(basis_);
+}
+
+auto IntegralSession::twoBodySpecifier(const Utils::Integrals::ParticleType& otherType) const
+    -> Utils::Integrals::IntegralSpecifier {
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+  specifier.typeVector = {particleType_, otherType};
+  return specifier;
+}
+
+} // namespace Integrals
+} // namespace Scine
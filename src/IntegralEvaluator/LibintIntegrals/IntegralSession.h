@@ -0,0 +1,143 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_INTEGRALSESSION_H
+#define INTEGRALEVALUATOR_INTEGRALSESSION_H
+
+#include <LibintIntegrals/LibintIntegrals.h>
+#include <Eigen/Core>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Scine {
+namespace Integrals {
+namespace TwoBody {
+class DirectFockBuilder;
+class LibintBasis;
+} // namespace TwoBody
+
+/**
+ * @class IntegralSession @file IntegralSession.h
+ * @brief Long-lived integral evaluation for one particle type in a fixed basis, e.g. for the iterations of an SCF or
+ *        the steps of a molecular dynamics run.
+ *
+ * The session owns the basis set with its shell pairs and everything that LibintIntegrals rebuilds on every call:
+ * the density-independent one-body matrices (overlap and core Hamiltonian) are evaluated once, the basis is
+ * converted to libint shells and shell pairs once (see TwoBody::LibintBasis) for all two-body evaluations, and the
+ * direct J/K builds reuse their output and per-thread scratch matrices (see TwoBody::DirectFockBuilder). All of this
+ * remains valid until the geometry or the basis changes through updateGeometry() or setBasis(); invalidate()
+ * discards the matrices and scratch data.
+ *
+ * The session refers to its own members, it can therefore neither be copied nor moved.
+ */
+class IntegralSession {
+ public:
+  /**
+   * @brief Constructor.
+   * @param basis The basis, its shell pairs are generated if necessary.
+   * @param atoms The atoms the basis is centered on. Their nuclear charges enter the core Hamiltonian.
+   * @param particleType The particle type described by the basis, by default the electron.
+   * @param prescreeningThreshold Threshold of the Cauchy-Schwarz screening of the two-body contributions.
+   */
+  IntegralSession(Utils::Integrals::BasisSet basis, Utils::AtomCollection atoms,
+                  Utils::Integrals::ParticleType particleType = Utils::Integrals::getParticleType("e"),
+                  double prescreeningThreshold = 1e-12);
+  ~IntegralSession();
+
+  IntegralSession(const IntegralSession& rhs) = delete;
+  IntegralSession& operator=(const IntegralSession& rhs) = delete;
+
+  const Utils::Integrals::BasisSet& getBasis() const;
+  const Utils::AtomCollection& getAtoms() const;
+  const Utils::Integrals::ParticleType& getParticleType() const;
+
+  /**
+   * @brief The overlap matrix, evaluated on the first call.
+   */
+  auto overlap() -> const Eigen::MatrixXd&;
+  /**
+   * @brief The kinetic energy and the attraction to the nuclei (the atoms as point charges), evaluated on the first
+   * call in a single pass.
+   */
+  auto coreHamiltonian() -> const Eigen::MatrixXd&;
+  /**
+   * @brief Evaluates several one-body operators in a single pass, see LibintIntegrals::evaluateOneBodyOperators().
+   * These results are not cached.
+   */
+  auto oneBody(const std::vector<Utils::Integrals::IntegralSpecifier>& specifiers) const
+      -> std::vector<IntegralTensor>;
+  /**
+   * @brief Contracts the first derivatives of a one-body operator with a density, see
+   * LibintIntegrals::evaluateOneBodyGradient(). For PointCharges, the atoms of the session are set as the charges.
+   */
+  auto oneBodyGradient(Utils::Integrals::IntegralSpecifier specifier, const Eigen::MatrixXd& density) const
+      -> Utils::GradientCollection;
+  /**
+   * @brief Evaluates J and K of the density into coulombExchange. The output matrices and the per-thread scratch are
+   * reused from call to call as long as the dimensions do not change.
+   */
+  void coulombExchange(const Utils::DensityMatrix& density,
+                       std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& coulombExchange);
+  /**
+   * @brief Evaluates the Coulomb interaction with another particle type, see
+   * LibintIntegrals::evaluateTwoBodyDirectPreBo().
+   * @param density The density of this session.
+   * @param other The session of the other particle type.
+   * @param otherDensity The density of the other particle type.
+   * @return (Coulomb matrix of this particle type, Coulomb matrix of the other particle type)
+   * @throws std::runtime_error if both sessions have the same particle type.
+   */
+  auto coulombWith(const Utils::DensityMatrix& density, const IntegralSession& other,
+                   const Utils::DensityMatrix& otherDensity) const -> std::pair<Eigen::MatrixXd, Eigen::MatrixXd>;
+
+  /**
+   * @brief Moves the basis to new positions of the same atoms and invalidates all cached data.
+   * The shell pairs are updated instead of regenerated as long as no atom moved farther than displacementTolerance
+   * from where they were last generated, see LibintIntegrals::moveBasisSet(). Many small steps therefore cannot
+   * accumulate to a large displacement of the shell-pair list.
+   */
+  void updateGeometry(const Utils::AtomCollection& atoms, double displacementTolerance = 0.1);
+  /**
+   * @brief Replaces the basis and the atoms and invalidates all cached data.
+   */
+  void setBasis(Utils::Integrals::BasisSet basis, Utils::AtomCollection atoms);
+  /**
+   * @brief Discards all cached matrices and scratch data, they are rebuilt on their next use.
+   */
+  void invalidate();
+  /**
+   * @brief Sets the number of threads of all evaluations of this session, see Libint::ThreadCountScope. By default 0,
+   * i.e. Libint::getNumberOfThreads(). Sessions on different host threads may thus be used concurrently with their
+   * own thread counts.
+   */
+  void setNumberOfThreads(int numberThreads);
+
+ private:
+  auto twoBodySpecifier(const Utils::Integrals::ParticleType& otherType) const -> Utils::Integrals::IntegralSpecifier;
+
+  // Converts the basis to libint and records the atoms as those of the last shell-pair generation.
+  void resetBasisData();
+
+  Utils::Integrals::BasisSet basis_;
+  Utils::AtomCollection atoms_;
+  // The atoms at which the shell pairs were last generated.
+  Utils::AtomCollection pairReferenceAtoms_;
+  std::shared_ptr<const TwoBody::LibintBasis> libintBasis_;
+  Utils::Integrals::ParticleType particleType_;
+  double prescreeningThreshold_;
+  int numberThreads_ = 0;
+  // Cached data, empty if invalid.
+  Eigen::MatrixXd overlap_;
+  Eigen::MatrixXd coreHamiltonian_;
+  std::unique_ptr<TwoBody::DirectFockBuilder> fockBuilder_;
+};
+
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_INTEGRALSESSION_H
@@ -0,0 +1,201 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/IntegralTensor.h>
+#include <LibintIntegrals/Libint.h>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#ifdef __linux__
+#  include <sys/mman.h>
+#endif
+
+using namespace Scine;
+using namespace Integrals;
+
+namespace {
+constexpr std::uintptr_t pageSize = 4096;
+} // namespace
+
+IntegralTensor::IntegralTensor(std::vector<Utils::Integrals::Component> components, std::size_t numberOfCenters,
+                               std::vector<Utils::Integrals::DerivKey> derivKeys, Eigen::Index rows, Eigen::Index cols,
+                               TensorPlacement placement)
+  : components_(std::move(components)),
+    numberOfCenters_(numberOfCenters),
+    derivKeys_(std::move(derivKeys)),
+    rows_(rows),
+    cols_(cols),
+    placement_(placement) {
+  const auto matrixSize = static_cast<std::size_t>(rows_ * cols_);
+  stride_ = (matrixSize + alignment_ - 1) / alignment_ * alignment_;
+
+  for (std::size_t i = 0; i < components_.size(); ++i) {
+    const auto value = static_cast<std::size_t>(components_[i]);
+    if (componentIndices_.size() <= value) {
+      componentIndices_.resize(value + 1, -1);
+    }
+    componentIndices_[value] = static_cast<int>(i);
+  }
+  for (std::size_t i = 0; i < derivKeys_.size(); ++i) {
+    const auto value = static_cast<std::size_t>(derivKeys_[i]);
+    if (derivKeyIndices_.size() <= value) {
+      derivKeyIndices_.resize(value + 1, -1);
+    }
+    derivKeyIndices_[value] = static_cast<int>(i);
+  }
+
+  keyIndices_.reserve(size());
+  for (std::size_t c = 0; c < components_.size(); ++c) {
+    for (std::size_t center = 0; center < numberOfCenters_; ++center) {
+      for (std::size_t d = 0; d < derivKeys_.size(); ++d) {
+        keyIndices_[{components_[c], derivKeys_[d], static_cast<int>(center)}] = index(c, center, d);
+      }
+    }
+  }
+
+  // No page is touched by resize(), the pages are placed by setZero().
+  buffer_.resize(size() * stride_);
+#ifdef __linux__
+  if (placement_ == TensorPlacement::parallelFirstTouchHugePages && !buffer_.empty()) {
+    const auto begin = (reinterpret_cast<std::uintptr_t>(buffer_.data()) + pageSize - 1) & ~(pageSize - 1);
+    const auto end = reinterpret_cast<std::uintptr_t>(buffer_.data() + buffer_.size()) & ~(pageSize - 1);
+    if (end > begin) {
+      // Only a hint, the buffer stays usable if the kernel does not support it.
+      madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+    }
+  }
+#endif
+  setZero();
+}
+
+std::size_t IntegralTensor::index(Utils::Integrals::Component component, std::size_t center,
+                                  Utils::Integrals::DerivKey derivKey) const {
+  const auto componentValue = static_cast<std::size_t>(component);
+  const auto derivKeyValue = static_cast<std::size_t>(derivKey);
+  if (componentValue >= componentIndices_.size() || componentIndices_[componentValue] < 0 ||
+      derivKeyValue >= derivKeyIndices_.size() || derivKeyIndices_[derivKeyValue] < 0 || center >= numberOfCenters_) {
+    throw std::out_of_range("Integral not contained in the result tensor.");
+  }
+  return index(componentIndices_[componentValue], center, derivKeyIndices_[derivKeyValue]);
+}
+
+std::size_t IntegralTensor::index(const Utils::Integrals::ReturnKey& key) const {
+  auto it = keyIndices_.find(key);
+  if (it == keyIndices_.end()) {
+    throw std::out_of_range("Integral not contained in the result tensor.");
+  }
+  return it->second;
+}
+
+IntegralTensor::MatrixMap IntegralTensor::operator[](const Utils::Integrals::ReturnKey& key) {
+  return matrix(index(key));
+}
+
+IntegralTensor::ConstMatrixMap IntegralTensor::operator[](const Utils::Integrals::ReturnKey& key) const {
+  return matrix(index(key));
+}
+
+IntegralTensor::MatrixMap IntegralTensor::at(const Utils::Integrals::ReturnKey& key) {
+  return matrix(index(key));
+}
+
+IntegralTensor::ConstMatrixMap IntegralTensor::at(const Utils::Integrals::ReturnKey& key) const {
+  return matrix(index(key));
+}
+
+std::size_t IntegralTensor::count(const Utils::Integrals::ReturnKey& key) const {
+  return keyIndices_.count(key);
+}
+
+std::vector<Utils::Integrals::ReturnKey> IntegralTensor::keys() const {
+  std::vector<Utils::Integrals::ReturnKey> result(size());
+  for (auto const& keyIndex : keyIndices_) {
+    result[keyIndex.second] = keyIndex.first;
+  }
+  return result;
+}
+
+IntegralEvaluatorMap IntegralTensor::toMap() const& {
+  IntegralEvaluatorMap result;
+  result.reserve(size());
+  for (auto const& keyIndex : keyIndices_) {
+    result.emplace(keyIndex.first, matrix(keyIndex.second));
+  }
+  return result;
+}
+
+IntegralEvaluatorMap IntegralTensor::toMap() && {
+  IntegralEvaluatorMap result;
+  result.reserve(size());
+  // The matrices are copied in buffer order, such that the copied part of the buffer is always a prefix of it.
+  const auto allKeys = keys();
+  const Eigen::Index matrixSize = rows_ * cols_;
+#ifdef __linux__
+  // The first partial page may be shared with other allocations and is never released.
+  std::uintptr_t released = (reinterpret_cast<std::uintptr_t>(buffer_.data()) + pageSize - 1) & ~(pageSize - 1);
+#endif
+  for (std::size_t i = 0; i < allKeys.size(); ++i) {
+    auto& copy = result[allKeys[i]];
+    copy.resize(rows_, cols_);
+    const double* source = data(i);
+    for (Eigen::Index begin = 0; begin < matrixSize; begin += releaseChunk_) {
+      const auto end = std::min(begin + releaseChunk_, matrixSize);
+      std::copy(source + begin, source + end, copy.data() + begin);
+#ifdef __linux__
+      const auto copied = reinterpret_cast<std::uintptr_t>(source + end) & ~(pageSize - 1);
+      if (copied > released) {
+        // Only a hint, the pages are freed with the buffer below otherwise.
+        madvise(reinterpret_cast<void*>(released), copied - released, MADV_DONTNEED);
+        released = copied;
+      }
+#endif
+    }
+  }
+  *this = IntegralTensor();
+  return result;
+}
+
+std::size_t IntegralTensor::size() const {
+  return components_.size() * numberOfCenters_ * derivKeys_.size();
+}
+
+bool IntegralTensor::empty() const {
+  return size() == 0;
+}
+
+Eigen::Index IntegralTensor::rows() const {
+  return rows_;
+}
+
+Eigen::Index IntegralTensor::cols() const {
+  return cols_;
+}
+
+std::size_t IntegralTensor::numberOfCenters() const {
+  return numberOfCenters_;
+}
+
+const std::vector<Utils::Integrals::Component>& IntegralTensor::components() const {
+  return components_;
+}
+
+const std::vector<Utils::Integrals::DerivKey>& IntegralTensor::derivKeys() const {
+  return derivKeys_;
+}
+
+void IntegralTensor::setZero() {
+  if (placement_ == TensorPlacement::serial) {
+    std::fill(buffer_.begin(), buffer_.end(), 0.0);
+    return;
+  }
+  const auto numberOfElements = static_cast<std::ptrdiff_t>(buffer_.size());
+  double* data = buffer_.data();
+#pragma omp parallel for schedule(static) num_threads(Libint::getNumberOfThreads())
+  for (std::ptrdiff_t i = 0; i < numberOfElements; ++i) {
+    data[i] = 0.0;
+  }
+}
@@ -0,0 +1,198 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_INTEGRALTENSOR_H
+#define INTEGRALEVALUATOR_INTEGRALTENSOR_H
+
+#include <Utils/DataStructures/IntegralSpecifier.h>
+#include <boost/functional/hash.hpp>
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Scine {
+namespace Integrals {
+
+/**
+ * @brief Result type of the integral evaluation with one independently allocated matrix per key.
+ * See IntegralTensor for the contiguous result type of the performance-critical entry points.
+ */
+using IntegralEvaluatorMap =
+    std::unordered_map<Utils::Integrals::ReturnKey, Eigen::MatrixXd, boost::hash<Utils::Integrals::ReturnKey>>;
+
+/**
+ * @brief How the pages of a large IntegralTensor are placed in memory.
+ */
+enum class TensorPlacement {
+  //! The buffer is zeroed by the calling thread, i.e. all pages reside on its NUMA node.
+  serial,
+  //! The buffer is zeroed by all OpenMP threads with a static schedule, such that the pages are spread over the NUMA
+  //! nodes and every thread owns a contiguous range of matrix columns.
+  parallelFirstTouch,
+  //! As parallelFirstTouch, the buffer is in addition marked for transparent huge pages (Linux only).
+  parallelFirstTouchHugePages
+};
+
+/**
+ * @class IntegralTensor @file IntegralTensor.h
+ * @brief Result container of the integral evaluation.
+ *
+ * All matrices of one evaluation are stored in one contiguous, aligned buffer. Every matrix is identified by its
+ * (component, center, derivative key) triple. The position of a matrix in the buffer is obtained by index
+ * arithmetic, such that hot loops do not need to hash any key.
+ * The map-style accessors operator[] and at() return Eigen::Map objects, i.e. views into the buffer, and throw for
+ * keys that are not part of the tensor. Assign them to an Eigen::MatrixXd to obtain an independent copy, or convert
+ * the whole tensor with toMap().
+ */
+class IntegralTensor {
+ public:
+  using MatrixMap = Eigen::Map<Eigen::MatrixXd>;
+  using ConstMatrixMap = Eigen::Map<const Eigen::MatrixXd>;
+
+  IntegralTensor() = default;
+  /**
+   * @brief Constructor allocating a zero-initialized matrix for every (component, center, derivative key) triple.
+   * @param components The operator components, e.g. x, y, z for the dipole operator.
+   * @param numberOfCenters The number of centers, 1 for values, 2 (or more) for derivatives.
+   * @param derivKeys The derivative keys, i.e. value or x, y, z.
+   * @param rows The number of rows of every matrix.
+   * @param cols The number of columns of every matrix.
+   * @param placement How the buffer is placed in memory. The parallel placements pay off for large tensors that are
+   *                  filled by many threads, such as stored two-body integrals.
+   */
+  IntegralTensor(std::vector<Utils::Integrals::Component> components, std::size_t numberOfCenters,
+                 std::vector<Utils::Integrals::DerivKey> derivKeys, Eigen::Index rows, Eigen::Index cols,
+                 TensorPlacement placement = TensorPlacement::serial);
+
+  /**
+   * @brief Position of a matrix given the positions of its component and derivative key in the layout.
+   */
+  inline std::size_t index(std::size_t componentIndex, std::size_t center, std::size_t derivKeyIndex) const {
+    return (componentIndex * numberOfCenters_ + center) * derivKeys_.size() + derivKeyIndex;
+  }
+  /**
+   * @brief Position of a matrix given its component, center and derivative key.
+   * @throws std::out_of_range if the triple is not part of this tensor.
+   */
+  std::size_t index(Utils::Integrals::Component component, std::size_t center, Utils::Integrals::DerivKey derivKey) const;
+  /**
+   * @brief Position of a matrix given its key.
+   * @throws std::out_of_range if the key is not part of this tensor.
+   */
+  std::size_t index(const Utils::Integrals::ReturnKey& key) const;
+
+  /**
+   * @brief Pointer to the first (column-major) element of the matrix at position `index`.
+   */
+  inline double* data(std::size_t index) {
+    return buffer_.data() + index * stride_;
+  }
+  inline const double* data(std::size_t index) const {
+    return buffer_.data() + index * stride_;
+  }
+  /**
+   * @brief View of the matrix at position `index`.
+   */
+  inline MatrixMap matrix(std::size_t index) {
+    return MatrixMap(data(index), rows_, cols_);
+  }
+  inline ConstMatrixMap matrix(std::size_t index) const {
+    return ConstMatrixMap(data(index), rows_, cols_);
+  }
+
+  /**
+   * @brief Map-style accessors.
+   * @throws std::out_of_range if the key is not part of this tensor.
+   * @{
+   */
+  MatrixMap operator[](const Utils::Integrals::ReturnKey& key);
+  ConstMatrixMap operator[](const Utils::Integrals::ReturnKey& key) const;
+  MatrixMap at(const Utils::Integrals::ReturnKey& key);
+  ConstMatrixMap at(const Utils::Integrals::ReturnKey& key) const;
+  //! @}
+  /**
+   * @brief Returns 1 if the key is part of this tensor, 0 otherwise.
+   */
+  std::size_t count(const Utils::Integrals::ReturnKey& key) const;
+  /**
+   * @brief All keys of this tensor, ordered by their position in the buffer.
+   */
+  std::vector<Utils::Integrals::ReturnKey> keys() const;
+  /**
+   * @brief Copies every matrix into an IntegralEvaluatorMap.
+   */
+  IntegralEvaluatorMap toMap() const&;
+  /**
+   * @brief Moves the matrices into an IntegralEvaluatorMap, e.g. `std::move(tensor).toMap()`.
+   * The pages of the buffer are returned to the system as soon as they are copied (Linux only), such that the
+   * conversion of a large tensor does not hold both copies at once. The tensor is empty afterwards.
+   */
+  IntegralEvaluatorMap toMap() &&;
+
+  /**
+   * @brief The number of matrices.
+   */
+  std::size_t size() const;
+  bool empty() const;
+  Eigen::Index rows() const;
+  Eigen::Index cols() const;
+  std::size_t numberOfCenters() const;
+  const std::vector<Utils::Integrals::Component>& components() const;
+  const std::vector<Utils::Integrals::DerivKey>& derivKeys() const;
+
+  /**
+   * @brief Zeroes the buffer, in parallel for the parallel placements such that the pages stay where they are.
+   */
+  void setZero();
+
+ private:
+  // Allocator leaving the elements uninitialized on resize, such that the pages are first touched when zeroed.
+  template<typename T>
+  struct UninitializedAllocator : Eigen::aligned_allocator<T> {
+    template<typename U>
+    struct rebind {
+      using other = UninitializedAllocator<U>;
+    };
+    UninitializedAllocator() = default;
+    template<typename U>
+    UninitializedAllocator(const UninitializedAllocator<U>& /*other*/) {
+    }
+    template<typename U>
+    void construct(U* p) {
+      ::new (static_cast<void*>(p)) U;
+    }
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+      ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+  };
+
+  // Number of doubles a matrix is padded to, such that every matrix starts on a cache line.
+  static constexpr std::size_t alignment_ = 8;
+  // Number of doubles copied by toMap() && before the copied pages are released.
+  static constexpr Eigen::Index releaseChunk_ = 1 << 17;
+
+  std::vector<Utils::Integrals::Component> components_;
+  std::size_t numberOfCenters_ = 0;
+  std::vector<Utils::Integrals::DerivKey> derivKeys_;
+  Eigen::Index rows_ = 0;
+  Eigen::Index cols_ = 0;
+  std::size_t stride_ = 0;
+  // Lookup tables from the enum values to the positions in the layout, -1 if absent.
+  std::vector<int> componentIndices_;
+  std::vector<int> derivKeyIndices_;
+  std::unordered_map<Utils::Integrals::ReturnKey, std::size_t, boost::hash<Utils::Integrals::ReturnKey>> keyIndices_;
+  TensorPlacement placement_ = TensorPlacement::serial;
+  std::vector<double, UninitializedAllocator<double>> buffer_;
+};
+
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_INTEGRALTENSOR_H
@@ -6,18 +6,68 @@
  */
 
 #include <LibintIntegrals/Libint.h>
+#include <omp.h>
+#include <limits>
+#include <stdexcept>
 
 using namespace Scine;
 using namespace Integrals;
 
-int Libint::nThreads_ = 1;
+std::atomic<int> Libint::nThreads_{0};
+thread_local int Libint::scopedNumberThreads_ = 0;
+
+namespace {
+// The maximal number of primitives and angular momentum of a set of shells.
+auto engineDimensions(std::initializer_list<const libint2::Shell*> shells) -> std::pair<std::size_t, int> {
+  std::size_t nPrimitives = 0;
+  int angularMomentum = 0;
+  for (const auto* shell : shells) {
+    nPrimitives = std::max(shell->nprim(), nPrimitives);
+    for (const auto& contraction : shell->contr) {
+      angularMomentum = std::max(contraction.l, angularMomentum);
+    }
+  }
+  return {nPrimitives, angularMomentum};
+}
+} // namespace
 
 Libint::Libint() {
   libint2::initialize();
-  nThreads_ = omp_get_max_threads();
+}
+
+int Libint::getNumberOfThreads() {
+  if (scopedNumberThreads_ > 0) {
+    return scopedNumberThreads_;
+  }
+  const int processNumberThreads = nThreads_.load();
+  if (processNumberThreads > 0) {
+    return processNumberThreads;
+  }
+  return omp_in_parallel() ? 1 : omp_get_max_threads();
+}
+
+void Libint::setNumberOfThreads(int numberThreads) {
+  if (numberThreads < 0) {
+    throw std::invalid_argument("The number of threads must not be negative.");
+  }
+  nThreads_ = numberThreads;
+}
+
+Libint::ThreadCountScope::ThreadCountScope(int numberThreads) : previous_(scopedNumberThreads_) {
+  if (numberThreads < 0) {
+    throw std::invalid_argument("The number of threads must not be negative.");
+  }
+  if (numberThreads > 0) {
+    scopedNumberThreads_ = numberThreads;
+  }
+}
+
+Libint::ThreadCountScope::~ThreadCountScope() {
+  scopedNumberThreads_ = previous_;
 }
 
 Libint::~Libint() {
+  enginePool_.clear();
   libint2::finalize();
 }
 
@@ -32,29 +82,103 @@ auto Libint::getEngine(const Scine::Utils::Integrals::BasisSet& basis1, const Sc
 auto Libint::getEngine(const libint2::Operator& op, const libint2::Shell& shell1, const libint2::Shell& shell2,
                        const libint2::Shell& shell3, const libint2::Shell& shell4) -> libint2::Engine {
   getInstance();
-  int angularMomentum = 0;
-  for (const auto& primitive : shell1.contr) {
-    angularMomentum = std::max(primitive.l, angularMomentum);
+  const auto dimensions = engineDimensions({&shell1, &shell2, &shell3, &shell4});
+  return {op, dimensions.first, dimensions.second};
+}
+
+auto Libint::getEngine(const Scine::Utils::Integrals::BasisSet& basis, const libint2::Operator& op, const int& derivOrder)
+    -> libint2::Engine {
+  getInstance();
+  return {op, basis.max_nprim(), static_cast<int>(basis.max_l()), derivOrder};
+}
+
+namespace {
+// Operator parameters as set by the engine constructor.
+void resetParams(libint2::Engine& engine, libint2::Operator op) {
+  switch (op) {
+    case libint2::Operator::nuclear:
+      engine.set_params(std::vector<std::pair<double, std::array<double, 3>>>{});
+      break;
+    case libint2::Operator::emultipole1:
+    case libint2::Operator::emultipole2:
+    case libint2::Operator::emultipole3:
+      engine.set_params(std::array<double, 3>{0.0, 0.0, 0.0});
+      break;
+    default:
+      break;
   }
-  for (const auto& primitive : shell2.contr) {
-    angularMomentum = std::max(primitive.l, angularMomentum);
+}
+} // namespace
+
+Libint::EngineLease::EngineLease(Key key, std::unique_ptr<libint2::Engine> engine)
+  : key_(std::move(key)), engine_(std::move(engine)) {
+}
+
+auto Libint::EngineLease::operator=(EngineLease&& rhs) noexcept -> EngineLease& {
+  if (this != &rhs) {
+    giveBack();
+    key_ = rhs.key_;
+    engine_ = std::move(rhs.engine_);
   }
-  for (const auto& primitive : shell3.contr) {
-    angularMomentum = std::max(primitive.l, angularMomentum);
+  return *this;
+}
+
+Libint::EngineLease::~EngineLease() {
+  giveBack();
+}
+
+void Libint::EngineLease::giveBack() {
+  if (!engine_) {
+    return;
   }
-  for (const auto& primitive : shell4.contr) {
-    angularMomentum = std::max(primitive.l, angularMomentum);
+  auto& libint = getInstance();
+  std::lock_guard<std::mutex> lock(libint.poolMutex_);
+  libint.enginePool_[key_].push_back(std::move(engine_));
+}
+
+auto Libint::leaseEngine(const libint2::Operator& op, std::size_t maxNumberPrimitives, int maxAngularMomentum,
+                         int derivOrder) -> EngineLease {
+  auto& libint = getInstance();
+  EngineLease::Key key(op, maxNumberPrimitives, maxAngularMomentum, derivOrder, omp_get_thread_num());
+  std::unique_ptr<libint2::Engine> engine;
+  {
+    std::lock_guard<std::mutex> lock(libint.poolMutex_);
+    auto& engines = libint.enginePool_[key];
+    if (!engines.empty()) {
+      engine = std::move(engines.back());
+      engines.pop_back();
+    }
   }
-  auto nPrimitives = shell1.nprim();
-  nPrimitives = std::max(shell2.nprim(), nPrimitives);
-  nPrimitives = std::max(shell3.nprim(), nPrimitives);
-  nPrimitives = std::max(shell4.nprim(), nPrimitives);
+  if (engine) {
+    engine->set_precision(std::numeric_limits<double>::epsilon());
+    engine->prescale_by(1.0);
+    resetParams(*engine, op);
+  }
+  else {
+    engine = std::make_unique<libint2::Engine>(op, maxNumberPrimitives, maxAngularMomentum, derivOrder);
+  }
+  return {std::move(key), std::move(engine)};
+}
 
-  return {op, nPrimitives, angularMomentum};
+auto Libint::leaseEngine(const Scine::Utils::Integrals::BasisSet& basis, const libint2::Operator& op, int derivOrder)
+    -> EngineLease {
+  return leaseEngine(op, basis.max_nprim(), static_cast<int>(basis.max_l()), derivOrder);
 }
 
-auto Libint::getEngine(const Scine::Utils::Integrals::BasisSet& basis, const libint2::Operator& op, const int& derivOrder)
-    -> libint2::Engine {
-  getInstance();
-  return {op, basis.max_nprim(), static_cast<int>(basis.max_l()), derivOrder};
+auto Libint::leaseEngine(const Scine::Utils::Integrals::BasisSet& basis1, const Scine::Utils::Integrals::BasisSet& basis2,
+                         const libint2::Operator& op, int derivOrder) -> EngineLease {
+  return leaseEngine(op, std::max(basis1.max_nprim(), basis2.max_nprim()),
+                     static_cast<int>(std::max(basis1.max_l(), basis2.max_l())), derivOrder);
+}
+
+auto Libint::leaseEngine(const libint2::Operator& op, const libint2::Shell& shell1, const libint2::Shell& shell2,
+                         const libint2::Shell& shell3, const libint2::Shell& shell4) -> EngineLease {
+  const auto dimensions = engineDimensions({&shell1, &shell2, &shell3, &shell4});
+  return leaseEngine(op, dimensions.first, dimensions.second, 0);
+}
+
+auto Libint::clearEnginePool() -> void {
+  auto& libint = getInstance();
+  std::lock_guard<std::mutex> lock(libint.poolMutex_);
+  libint.enginePool_.clear();
 }
@@ -20,6 +20,12 @@
 #pragma GCC diagnostic pop
 
 #include <Utils/DataStructures/BasisSet.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
 
 namespace Scine {
 namespace Integrals {
@@ -55,12 +61,41 @@ class Libint {
   }
 
   /**
-   * @brief Function returning the max number of threads in use.
-   * @return the value of omp_get_max_threads() at initialization time of this class.
+   * @brief The number of threads requested for the parallel regions of an integral evaluation started by the calling
+   * thread.
+   * In order of precedence, this is the count of the innermost ThreadCountScope of the calling thread, the count set
+   * with setNumberOfThreads(), or omp_get_max_threads() at the time of the call. Within a parallel region of the host
+   * program, the default is a single thread, such that independent evaluations started concurrently from several
+   * host threads do not oversubscribe the machine. Per-thread data is sized from the team size actually granted.
+   */
+  static int getNumberOfThreads();
+  /**
+   * @brief Sets the process-wide number of threads of the integral evaluation, 0 restores the default.
+   */
+  static void setNumberOfThreads(int numberThreads);
+  /**
+   * @brief Function returning the number of threads in use.
+   * @return getNumberOfThreads(); kept for compatibility.
    */
   static int getMaxNumberThreads() {
-    return nThreads_;
+    return getNumberOfThreads();
   }
+
+  /**
+   * @class ThreadCountScope
+   * @brief Sets the number of threads of all integral evaluations started by the current thread for its lifetime,
+   * e.g. for one call or for all calls of an IntegralSession. Scopes can be nested, 0 keeps the current count.
+   */
+  class ThreadCountScope {
+   public:
+    explicit ThreadCountScope(int numberThreads);
+    ThreadCountScope(const ThreadCountScope&) = delete;
+    ThreadCountScope& operator=(const ThreadCountScope&) = delete;
+    ~ThreadCountScope();
+
+   private:
+    int previous_;
+  };
   /**
    * @brief Destructor. Must finalize Libint.
    */
@@ -75,13 +110,72 @@ class Libint {
   static auto getEngine(const libint2::Operator& op, const libint2::Shell& shell1, const libint2::Shell& shell2,
                         const libint2::Shell& shell3, const libint2::Shell& shell4) -> libint2::Engine;
 
+  /**
+   * @class EngineLease
+   * @brief An engine lent out from the engine pool. It is handed back to the pool when the lease is destroyed.
+   * Behaves like a pointer to the engine; a default-constructed lease is empty.
+   */
+  class EngineLease {
+   public:
+    EngineLease() = default;
+    EngineLease(const EngineLease&) = delete;
+    EngineLease& operator=(const EngineLease&) = delete;
+    EngineLease(EngineLease&& rhs) noexcept = default;
+    EngineLease& operator=(EngineLease&& rhs) noexcept;
+    ~EngineLease();
+
+    libint2::Engine* get() const {
+      return engine_.get();
+    }
+    libint2::Engine& operator*() const {
+      return *engine_;
+    }
+    libint2::Engine* operator->() const {
+      return engine_.get();
+    }
+
+   private:
+    friend class Libint;
+    using Key = std::tuple<libint2::Operator, std::size_t, int, int, int>;
+    EngineLease(Key key, std::unique_ptr<libint2::Engine> engine);
+    void giveBack();
+    Key key_;
+    std::unique_ptr<libint2::Engine> engine_;
+  };
+
+  /**
+   * @brief Lends an engine out of the process-wide engine pool.
+   * Engines are kept per operator, maximal number of primitives, maximal angular momentum, derivative order and
+   * OpenMP thread, such that repeated evaluations (e.g. in an SCF loop) do not reallocate the engines' scratch
+   * buffers. The precision is reset to the libint default and the operator parameters to their defaults every time
+   * an engine is lent out. Thread-safe.
+   */
+  static auto leaseEngine(const Scine::Utils::Integrals::BasisSet& basis, const libint2::Operator& op,
+                          int derivOrder = 0) -> EngineLease;
+  static auto leaseEngine(const Scine::Utils::Integrals::BasisSet& basis1, const Scine::Utils::Integrals::BasisSet& basis2,
+                          const libint2::Operator& op, int derivOrder) -> EngineLease;
+  static auto leaseEngine(const libint2::Operator& op, std::size_t maxNumberPrimitives, int maxAngularMomentum,
+                          int derivOrder) -> EngineLease;
+  static auto leaseEngine(const libint2::Operator& op, const libint2::Shell& shell1, const libint2::Shell& shell2,
+                          const libint2::Shell& shell3, const libint2::Shell& shell4) -> EngineLease;
+
+  /**
+   * @brief Frees all engines that are currently not lent out.
+   */
+  static auto clearEnginePool() -> void;
+
  private:
+  std::mutex poolMutex_;
+  std::map<EngineLease::Key, std::vector<std::unique_ptr<libint2::Engine>>> enginePool_;
+
   // Dependent on the basis.
   static constexpr int maxPrimitiveNumber = 20;
   // Dependent on how the libint2 library was generated. Use Libint2 macro
   static constexpr int maxAngularMomentum = LIBINT2_MAX_AM;
-  // Saves the number of OMP threads to use
-  static int nThreads_;
+  // The process-wide number of threads, 0 if not set.
+  static std::atomic<int> nThreads_;
+  // The number of threads of the innermost ThreadCountScope of a thread, 0 if there is none.
+  static thread_local int scopedNumberThreads_;
 };
 
 } // namespace Integrals
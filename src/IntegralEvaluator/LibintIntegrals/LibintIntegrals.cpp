@@ -6,16 +6,22 @@
  */
 /* Internal includes */
 #include <LibintIntegrals/BasisSetHandler.h>
+#include <LibintIntegrals/BasisSetLibrary.h>
+#include <LibintIntegrals/BasisSetSerializer.h>
 #include <LibintIntegrals/IntegralEvaluatorSettings.h>
 #include <LibintIntegrals/Libint.h>
 #include <LibintIntegrals/LibintIntegrals.h>
 #include <LibintIntegrals/OneBodyIntegrals.h>
+#include <LibintIntegrals/PointChargeIntegrals.h>
+#include <LibintIntegrals/ShellReordering.h>
 #include <LibintIntegrals/TwoBodyIntegrals/COMSaverDigester.h>
 #include <LibintIntegrals/TwoBodyIntegrals/CauchySchwarzDensityPrescreener.h>
 #include <LibintIntegrals/TwoBodyIntegrals/Evaluator.h>
 #include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/CoulombExchangeDigester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/DirectFockBuilder.h>
 #include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/TwoTypeCoulombDigester.h>
 #include <LibintIntegrals/TwoBodyIntegrals/SaverDigester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/TwoTypeCauchySchwarzPrescreener.h>
 /* External includes */
 #include <Utils/Geometry/ElementInfo.h>
 #include <Utils/Settings.h>
@@ -34,12 +40,11 @@ auto LibintIntegrals::initializeBasisSet(const std::string& name, const Utils::A
                                          bool generateShellPairs) -> Utils::Integrals::BasisSet {
   std::vector<libint2::Atom> libint_atoms = BasisSetHandler::scineToLibint(atoms);
 
-  auto libint_basis = libint2::BasisSet(name, libint_atoms, true);
+  // The basis-set file is only parsed on the first request of every element.
+  const bool pureSolid = _settings->getBool("use_pure_spherical");
+  auto libintShells = BasisSetLibrary::getInstance().makeShells(name, libint_atoms, pureSolid);
 
-  libint_basis.set_pure(_settings->getBool("use_pure_spherical"));
-
-  Utils::Integrals::BasisSet scineBasis =
-      BasisSetHandler::libintToScine(libint_basis, atoms, _settings->getBool("use_pure_spherical"));
+  Utils::Integrals::BasisSet scineBasis = BasisSetHandler::libintToScine(libintShells, atoms, pureSolid);
 
   if (generateShellPairs) {
     BasisSetHandler::generateShellPairs(scineBasis);
@@ -66,9 +71,9 @@ auto LibintIntegrals::initializeBasisSet(const std::unordered_map<Utils::Element
       throw std::runtime_error("Element not contained in molecular structure");
     }
     std::vector<libint2::Atom> libint_atoms = BasisSetHandler::scineToLibint(tmp_atom_coll);
-    auto libint_basis = libint2::BasisSet(elem_name_pair.second, libint_atoms, true);
-    libint_basis.set_pure(_settings->getBool("use_pure_spherical"));
-    scineBasis.append(BasisSetHandler::libintToScine(libint_basis, tmp_atom_coll, _settings->getBool("use_pure_spherical")));
+    const bool pureSolid = _settings->getBool("use_pure_spherical");
+    auto libintShells = BasisSetLibrary::getInstance().makeShells(elem_name_pair.second, libint_atoms, pureSolid);
+    scineBasis.append(BasisSetHandler::libintToScine(libintShells, tmp_atom_coll, pureSolid));
   }
 
   if (generateShellPairs) {
@@ -77,17 +82,93 @@ auto LibintIntegrals::initializeBasisSet(const std::unordered_map<Utils::Element
   return scineBasis;
 }
 
+auto LibintIntegrals::preloadBasisSets(const std::vector<std::string>& names,
+                                       const std::vector<Utils::ElementType>& elements) -> void {
+  std::vector<int> atomicNumbers;
+  atomicNumbers.reserve(elements.size());
+  for (auto const& element : elements) {
+    atomicNumbers.push_back(Utils::ElementInfo::Z(element));
+  }
+  BasisSetLibrary::getInstance().preload(names, atomicNumbers);
+}
+
+auto LibintIntegrals::clearBasisSetCache() -> void {
+  BasisSetLibrary::getInstance().clear();
+}
+
 auto LibintIntegrals::evaluateOneBody(const Utils::Integrals::IntegralSpecifier& specifier,
                                       const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2)
-    -> IntegralEvaluatorMap {
+    -> IntegralTensor {
   auto oneBodyInts = OneBodyIntegrals(basis1, basis2, specifier);
   oneBodyInts.compute();
   return oneBodyInts.getResult();
 }
 
+auto LibintIntegrals::evaluateOneBodyOperators(const std::vector<Utils::Integrals::IntegralSpecifier>& specifiers,
+                                               const Utils::Integrals::BasisSet& basis1,
+                                               const Utils::Integrals::BasisSet& basis2) -> std::vector<IntegralTensor> {
+  for (auto const& specifier : specifiers) {
+    if (!isOneBodyOperator(specifier.op)) {
+      throw std::runtime_error("Operator not available in the one-body integral routine!");
+    }
+  }
+  auto oneBodyInts = OneBodyIntegrals(basis1, basis2, specifiers);
+  oneBodyInts.compute();
+  return oneBodyInts.getResults();
+}
+
+auto LibintIntegrals::evaluateOneBodySum(const std::vector<Utils::Integrals::IntegralSpecifier>& specifiers,
+                                         const Utils::Integrals::BasisSet& basis1,
+                                         const Utils::Integrals::BasisSet& basis2) -> IntegralTensor {
+  for (auto const& specifier : specifiers) {
+    if (!isOneBodyOperator(specifier.op)) {
+      throw std::runtime_error("Operator not available in the one-body integral routine!");
+    }
+  }
+  auto oneBodyInts = OneBodyIntegrals(basis1, basis2, specifiers, true);
+  oneBodyInts.compute();
+  return oneBodyInts.getResult();
+}
+
+auto LibintIntegrals::evaluateOneBodyGradient(const Utils::Integrals::IntegralSpecifier& specifier,
+                                              const Utils::Integrals::BasisSet& basis, const Eigen::MatrixXd& density,
+                                              const Utils::AtomCollection& atoms) -> Utils::GradientCollection {
+  if (!isOneBodyOperator(specifier.op)) {
+    throw std::runtime_error("Operator not available in the one-body integral routine!");
+  }
+  auto oneBodyInts = OneBodyIntegrals(basis, specifier, density, atoms);
+  oneBodyInts.compute();
+  return oneBodyInts.getGradient();
+}
+
+auto LibintIntegrals::evaluatePointCharges(const Utils::Integrals::IntegralSpecifier& specifier,
+                                           const std::vector<PointCharge>& charges,
+                                           const Utils::Integrals::BasisSet& basis1,
+                                           const Utils::Integrals::BasisSet& basis2, double openingAngle)
+    -> IntegralTensor {
+  auto pointChargeInts = PointChargeIntegrals(basis1, basis2, specifier, charges, openingAngle);
+  pointChargeInts.compute();
+  return pointChargeInts.getResult();
+}
+
+auto LibintIntegrals::evaluateElectrostaticPotential(const Utils::Integrals::BasisSet& basis,
+                                                     const Utils::DensityMatrix& density,
+                                                     const Utils::PositionCollection& points, bool computeField)
+    -> GridPotential {
+  auto electrostaticPotential = ElectrostaticPotential(basis, density, points, computeField);
+  electrostaticPotential.compute();
+  return electrostaticPotential.getResult();
+}
+
+bool LibintIntegrals::isOneBodyOperator(const Utils::Integrals::Operator& op) {
+  return op == Utils::Integrals::Operator::Kinetic || op == Utils::Integrals::Operator::KineticCOM ||
+         op == Utils::Integrals::Operator::PointCharges || op == Utils::Integrals::Operator::Overlap ||
+         op == Utils::Integrals::Operator::Dipole;
+}
+
 auto LibintIntegrals::evaluateTwoBody(const Utils::Integrals::IntegralSpecifier& specifier,
                                       const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2)
-    -> IntegralEvaluatorMap {
+    -> IntegralTensor {
   if (!basis1.areShellPairsEvaluated()) {
     throw std::runtime_error("Evaluate shell pairs before performing the two-body integral evaluation!");
   }
@@ -97,7 +178,7 @@ auto LibintIntegrals::evaluateTwoBody(const Utils::Integrals::IntegralSpecifier&
 
   auto prescreener = TwoBody::VoidPrescreener();
 
-  IntegralEvaluatorMap result;
+  IntegralTensor result;
 
   if (specifier.op == Utils::Integrals::Operator::Coulomb) {
     if (basis1 == basis2) {
@@ -105,14 +186,14 @@ auto LibintIntegrals::evaluateTwoBody(const Utils::Integrals::IntegralSpecifier&
       auto eval = TwoBody::Evaluator<TwoBody::SaverDigester<TwoBody::IntegralSymmetry::eightfold>>(
           basis1, basis2, specifier, std::move(saver), std::move(prescreener));
       eval.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
-      result = eval.getResult();
+      result = eval.takeResult();
     }
     else {
       auto saver = TwoBody::SaverDigester<TwoBody::IntegralSymmetry::fourfold>(basis1, basis2, specifier);
       auto eval = TwoBody::Evaluator<TwoBody::SaverDigester<TwoBody::IntegralSymmetry::fourfold>>(
           basis1, basis2, specifier, std::move(saver), std::move(prescreener));
       eval.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
-      result = eval.getResult();
+      result = eval.takeResult();
     }
   }
   else if (specifier.op == Utils::Integrals::Operator::CoulombCOM) {
@@ -121,14 +202,14 @@ auto LibintIntegrals::evaluateTwoBody(const Utils::Integrals::IntegralSpecifier&
       auto eval = TwoBody::Evaluator<TwoBody::COMSaverDigester<TwoBody::IntegralSymmetry::fourfold>>(
           basis1, basis2, specifier, std::move(saver), std::move(prescreener));
       eval.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
-      result = eval.getResult();
+      result = eval.takeResult();
     }
     else {
       auto saver = TwoBody::COMSaverDigester<TwoBody::IntegralSymmetry::twofold>(basis1, basis2, specifier);
       auto eval = TwoBody::Evaluator<TwoBody::COMSaverDigester<TwoBody::IntegralSymmetry::twofold>>(
           basis1, basis2, specifier, std::move(saver), std::move(prescreener));
       eval.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
-      result = eval.getResult();
+      result = eval.takeResult();
     }
   }
   else {
@@ -152,9 +233,14 @@ const Utils::Settings& LibintIntegrals::settings() const {
 
 auto LibintIntegrals::evaluate(const Utils::Integrals::IntegralSpecifier& specifier, const Utils::Integrals::BasisSet& basis1,
                                const Utils::Integrals::BasisSet& basis2) -> IntegralEvaluatorMap {
-  if (specifier.op == Utils::Integrals::Operator::Kinetic || specifier.op == Utils::Integrals::Operator::KineticCOM ||
-      specifier.op == Utils::Integrals::Operator::PointCharges || specifier.op == Utils::Integrals::Operator::Overlap ||
-      specifier.op == Utils::Integrals::Operator::Dipole) {
+  // The temporary binds to IntegralTensor::toMap() &&, which releases the tensor while the map is filled.
+  return evaluateTensor(specifier, basis1, basis2).toMap();
+}
+
+auto LibintIntegrals::evaluateTensor(const Utils::Integrals::IntegralSpecifier& specifier,
+                                     const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2)
+    -> IntegralTensor {
+  if (isOneBodyOperator(specifier.op)) {
     return evaluateOneBody(specifier, basis1, basis2);
   }
   else if (specifier.op == Utils::Integrals::Operator::Coulomb || specifier.op == Utils::Integrals::Operator::CoulombCOM) {
@@ -172,24 +258,33 @@ auto LibintIntegrals::generateShellPairs(Utils::Integrals::BasisSet& basis, bool
   BasisSetHandler::generateShellPairs(basis, performOverlapPrescreening, threshold, calculateCauchySchwarzFactor);
 }
 
+auto LibintIntegrals::moveBasisSet(const Utils::Integrals::BasisSet& basis, const Utils::AtomCollection& oldAtoms,
+                                   const Utils::AtomCollection& newAtoms, double displacementTolerance,
+                                   double threshold) -> Utils::Integrals::BasisSet {
+  return BasisSetHandler::moveBasisSet(basis, oldAtoms, newAtoms, displacementTolerance, threshold);
+}
+
+auto LibintIntegrals::saveBasisSet(const Utils::Integrals::BasisSet& basis, const Utils::AtomCollection& atoms,
+                                   const std::string& path) -> void {
+  BasisSetSerializer::save(basis, atoms, path);
+}
+
+auto LibintIntegrals::loadBasisSet(const std::string& path) -> Utils::Integrals::BasisSet {
+  return BasisSetSerializer::load(path);
+}
+
 auto LibintIntegrals::evaluateTwoBodyDirectBo(const Utils::Integrals::IntegralSpecifier& specifier,
                                               const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
-                                              const Utils::DensityMatrix& dm1, double prescreeningThreshold)
+                                              const Utils::DensityMatrix& dm1, double prescreeningThreshold,
+                                              bool reorderShells)
     -> std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix> {
+  if (reorderShells && basis1 == basis2) {
+    return evaluateTwoBodyDirectBo(specifier, ShellReordering(basis1), dm1, prescreeningThreshold);
+  }
   if (basis1 == basis2) {
-    auto prescreener = Integrals::TwoBody::CauchySchwarzDensityPrescreener(basis1, dm1, prescreeningThreshold);
-
-    auto saver = Integrals::TwoBody::CoulombExchangeDigester(basis1, basis2, specifier, dm1);
-    auto evaluator =
-        Integrals::TwoBody::Evaluator<Integrals::TwoBody::CoulombExchangeDigester, Integrals::TwoBody::CauchySchwarzDensityPrescreener>(
-            basis1, basis2, specifier, std::move(saver), std::move(prescreener));
-
-    evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
-
-    Utils::SpinAdaptedMatrix J = evaluator.getResult().first;
-    Utils::SpinAdaptedMatrix K = evaluator.getResult().second;
-
-    return {J, K};
+    std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix> JK;
+    Integrals::TwoBody::DirectFockBuilder(basis1, specifier, prescreeningThreshold).compute(dm1, JK);
+    return JK;
   }
   else {
     auto prescreener = Integrals::TwoBody::VoidPrescreener();
@@ -201,28 +296,36 @@ auto LibintIntegrals::evaluateTwoBodyDirectBo(const Utils::Integrals::IntegralSp
 
     evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
 
-    Utils::SpinAdaptedMatrix J = evaluator.getResult().first;
-    Utils::SpinAdaptedMatrix K = evaluator.getResult().second;
-
-    return {J, K};
+    return evaluator.takeResult();
   }
 }
 
+auto LibintIntegrals::evaluateTwoBodyDirectBo(const Utils::Integrals::IntegralSpecifier& specifier,
+                                              const ShellReordering& reordering, const Utils::DensityMatrix& dm1,
+                                              double prescreeningThreshold)
+    -> std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix> {
+  const auto& basis = reordering.getBasis();
+  auto JK = evaluateTwoBodyDirectBo(specifier, basis, basis, reordering.toReordered(dm1), prescreeningThreshold);
+  return {reordering.toOriginal(JK.first), reordering.toOriginal(JK.second)};
+}
+
 auto LibintIntegrals::evaluateTwoBodyDirectPreBo(const Utils::Integrals::IntegralSpecifier& specifier,
                                                  const Utils::Integrals::BasisSet& basis1,
                                                  const Utils::Integrals::BasisSet& basis2,
-                                                 const Utils::DensityMatrix& dm1, const Utils::DensityMatrix& dm2)
+                                                 const Utils::DensityMatrix& dm1, const Utils::DensityMatrix& dm2,
+                                                 double prescreeningThreshold)
     -> std::pair<Eigen::MatrixXd, Eigen::MatrixXd> {
   if (specifier.typeVector.at(0).symbol == specifier.typeVector.at(1).symbol) {
     throw std::runtime_error("BO routine was called with different particle types.");
   }
 
-  auto prescreener = Integrals::TwoBody::VoidPrescreener();
+  auto prescreener = Integrals::TwoBody::TwoTypeCauchySchwarzPrescreener(basis1, basis2, dm1, dm2, prescreeningThreshold);
 
   auto saver = Integrals::TwoBody::TwoTypeCoulombDigester(basis1, basis2, specifier, dm1, dm2);
-  auto evaluator = Integrals::TwoBody::Evaluator<Integrals::TwoBody::TwoTypeCoulombDigester>(
-      basis1, basis2, specifier, std::move(saver), std::move(prescreener));
+  auto evaluator =
+      Integrals::TwoBody::Evaluator<Integrals::TwoBody::TwoTypeCoulombDigester, Integrals::TwoBody::TwoTypeCauchySchwarzPrescreener>(
+          basis1, basis2, specifier, std::move(saver), std::move(prescreener));
   evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
 
-  return {evaluator.getResult().first, evaluator.getResult().second};
+  return evaluator.takeResult();
 }
@@ -8,6 +8,9 @@
 #ifndef INTEGRALEVALUATOR_LIBINTINTEGRALEVALUATOR_H
 #define INTEGRALEVALUATOR_LIBINTINTEGRALEVALUATOR_H
 
+#include <LibintIntegrals/ElectrostaticPotential.h>
+#include <LibintIntegrals/IntegralTensor.h>
+#include <LibintIntegrals/PointChargeOctree.h>
 #include <Utils/DataStructures/BasisSet.h>
 #include <Utils/DataStructures/IntegralSpecifier.h>
 #include <Utils/DataStructures/SpinAdaptedMatrix.h>
@@ -21,9 +24,7 @@ class Settings;
 class DensityMatrix;
 } // namespace Utils
 namespace Integrals {
-
-using IntegralEvaluatorMap =
-    std::unordered_map<Utils::Integrals::ReturnKey, Eigen::MatrixXd, boost::hash<Utils::Integrals::ReturnKey>>;
+class ShellReordering;
 
 class LibintIntegrals {
  public:
@@ -40,11 +41,80 @@ class LibintIntegrals {
    */
   static auto evaluate(const Utils::Integrals::IntegralSpecifier& specifier, const Utils::Integrals::BasisSet& basis1,
                        const Utils::Integrals::BasisSet& basis2) -> IntegralEvaluatorMap;
+  /**
+   * @brief Evaluate integrals between two basis sets, as evaluate(), into one contiguous IntegralTensor.
+   * Avoids copying every matrix into the unordered_map, which matters for the stored two-body integrals.
+   * @return IntegralTensor containing matrices of type Eigen::MatrixXd
+   */
+  static auto evaluateTensor(const Utils::Integrals::IntegralSpecifier& specifier,
+                             const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2)
+      -> IntegralTensor;
+  /**
+   * @brief Evaluate several one-body operators between two basis sets in a single pass.
+   * The shell conversion, the shell-pair loop and the thread scheduling are shared among all operators.
+   * @param specifiers One specifier per operator.
+   * @return One IntegralTensor per specifier, in the same order as the specifiers.
+   */
+  static auto evaluateOneBodyOperators(const std::vector<Utils::Integrals::IntegralSpecifier>& specifiers,
+                                       const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2)
+      -> std::vector<IntegralTensor>;
+  /**
+   * @brief Evaluate the sum of several one-body operators between two basis sets in a single pass.
+   * E.g., the core Hamiltonian is obtained from a Kinetic and a PointCharges specifier without storing the two
+   * contributions separately. All operators must have the same result layout, i.e. the same components, derivative
+   * order and number of centers.
+   * @param specifiers One specifier per operator.
+   * @return IntegralTensor containing the summed matrices of type Eigen::MatrixXd
+   */
+  static auto evaluateOneBodySum(const std::vector<Utils::Integrals::IntegralSpecifier>& specifiers,
+                                 const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2)
+      -> IntegralTensor;
+  /**
+   * @brief Evaluate the first derivatives of a one-body operator contracted with a density matrix.
+   * The derivatives are contracted shell pair by shell pair, no derivative matrix is stored.
+   * @param specifier The operator, derivOrder must be 1. For PointCharges, the charges must be the `atoms`.
+   * @param basis The basis.
+   * @param density The symmetric matrix the derivatives are contracted with, e.g. the density matrix or, for the
+   *                overlap, the energy-weighted density matrix.
+   * @param atoms The atoms the basis functions are centered on.
+   * @return The contracted derivatives, one row per atom.
+   */
+  static auto evaluateOneBodyGradient(const Utils::Integrals::IntegralSpecifier& specifier,
+                                      const Utils::Integrals::BasisSet& basis, const Eigen::MatrixXd& density,
+                                      const Utils::AtomCollection& atoms) -> Utils::GradientCollection;
+  /**
+   * @brief Evaluate the interaction integrals with a set of classical point charges, e.g. the MM charges in QM/MM.
+   * The charges are grouped in an octree. Charges far from a shell pair are treated through a second-order expansion
+   * of their potential around the shell pair, only near charges are evaluated exactly.
+   * @param specifier Defines the particle type of the basis functions, derivOrder must be 0. `atoms` is ignored.
+   * @param charges The point charges.
+   * @param openingAngle Controls the accuracy of the expansion, the error is of third order in it.
+   *                     0 evaluates all charges exactly.
+   * @return IntegralTensor containing matrices of type Eigen::MatrixXd
+   */
+  static auto evaluatePointCharges(const Utils::Integrals::IntegralSpecifier& specifier,
+                                   const std::vector<PointCharge>& charges, const Utils::Integrals::BasisSet& basis1,
+                                   const Utils::Integrals::BasisSet& basis2, double openingAngle = 0.25)
+      -> IntegralTensor;
+  /**
+   * @brief Evaluates the electrostatic potential of the electrons, and optionally their electric field, at many points.
+   * The integrals of every significant shell pair are contracted with the density on the fly in one parallel pass
+   * over the points. Nuclear contributions are not included.
+   * @param basis The basis, the shell pairs must have been generated.
+   * @param density The density matrix of the electrons, the restricted (total) matrix is used.
+   * @param points The grid points.
+   * @param computeField Whether the electric field is evaluated as well.
+   * @return The potential and, if requested, the electric field at every point.
+   */
+  static auto evaluateElectrostaticPotential(const Utils::Integrals::BasisSet& basis, const Utils::DensityMatrix& density,
+                                             const Utils::PositionCollection& points, bool computeField = false)
+      -> GridPotential;
   /**
    * @brief Simple initialization routine of a basis set object, that uses libint functionality.
    * Must be passed the name of the basis set and the atoms object.
    * The libint routine searches in the basis set file with the given `name` for the basis set specifics of the
-   * atoms that are contained in the `atoms` object.
+   * atoms that are contained in the `atoms` object. Every element is parsed only once per process, later calls
+   * take its shells from the basis-set cache.
    * @param name
    * @param atoms
    * @return Scine BasisSet object
@@ -60,6 +130,19 @@ class LibintIntegrals {
    */
   auto initializeBasisSet(const std::unordered_map<Utils::ElementType, std::string>& names,
                           const Utils::AtomCollection& atoms, bool generateShellPairs = true) -> Utils::Integrals::BasisSet;
+  /**
+   * @brief Parses the given basis sets for the given elements into the process-wide basis-set cache.
+   * Basis-set files are parsed only once per element and basis set anyway; preloading moves this cost out of,
+   * e.g., a high-throughput loop. Thread-safe.
+   * @param names Names of the basis sets, e.g., def2-SVP.
+   * @param elements The elements to load.
+   */
+  static auto preloadBasisSets(const std::vector<std::string>& names, const std::vector<Utils::ElementType>& elements)
+      -> void;
+  /**
+   * @brief Empties the process-wide basis-set cache.
+   */
+  static auto clearBasisSetCache() -> void;
 
   /**
    * @brief Computes non-negligible shell pair list; shells \c i and \c j form a
@@ -70,39 +153,94 @@ class LibintIntegrals {
    * @param threshold Overlap threshold for computing relevant shell-pairs. Defaults to 1e-12.
    * @param calculateCauchySchwarzFactor Decides whether the maximal Cauchy-Schwarz factor for the shell-pair
    *                                     has to be calculated. Needed to do a Cauchy-Schwartz ERI prescreening.
+   *                                     If false, no (ab|ab) integral is evaluated and the factors are not set.
+   *                                     Release 1.0.0 computed them regardless of this flag.
    */
   static auto generateShellPairs(Utils::Integrals::BasisSet& basis, bool performOverlapPrescreening = true,
                                  double threshold = 1e-12, bool calculateCauchySchwarzFactor = true) -> void;
 
+  /**
+   * @brief Moves a basis set to new atom positions, updating its shell-pair list if all displacements are small.
+   * See BasisSetHandler::moveBasisSet().
+   * @param basis The basis set at the positions of `oldAtoms`.
+   * @param oldAtoms The atoms the basis set is currently centered on.
+   * @param newAtoms The same atoms at their new positions.
+   * @param displacementTolerance Largest atomic displacement for which the shell-pair list is updated instead of
+   *                              regenerated.
+   * @param threshold Overlap threshold of the shell pairs, see generateShellPairs().
+   * @return The basis set at the new positions.
+   */
+  static auto moveBasisSet(const Utils::Integrals::BasisSet& basis, const Utils::AtomCollection& oldAtoms,
+                           const Utils::AtomCollection& newAtoms, double displacementTolerance = 0.1,
+                           double threshold = 1e-12) -> Utils::Integrals::BasisSet;
+
+  /**
+   * @brief Stores a basis set, its atoms and its shell pairs in a binary file, see BasisSetSerializer.
+   * Loading the file is considerably cheaper than parsing the basis set and generating the shell pairs again.
+   */
+  static auto saveBasisSet(const Utils::Integrals::BasisSet& basis, const Utils::AtomCollection& atoms,
+                           const std::string& path) -> void;
+  /**
+   * @brief Loads a basis set, including its shell pairs, that was stored with saveBasisSet().
+   * @throws std::runtime_error if the file is not a basis set file of the current format version.
+   */
+  static auto loadBasisSet(const std::string& path) -> Utils::Integrals::BasisSet;
+
   /**
    * @brief Evaluates the pre-BO contribution to the Fock matrix for different particle types.
-   * Operator and other infos are contained in the specifier object.
+   * Operator and other infos are contained in the specifier object. For Operator::CoulombCOM, the separable
+   * center-of-mass term is added to the screened Coulomb part, see TwoBody::CenterOfMassCorrection.
    * @param specifier
    * @param basis1
    * @param basis2
    * @param dm1
    * @param dm2
+   * @param prescreeningThreshold Quartets whose Cauchy-Schwarz bound times the largest density element of their
+   *                              shell blocks is below this threshold are skipped, see
+   *                              TwoBody::TwoTypeCauchySchwarzPrescreener. A threshold of 0 only skips quartets
+   *                              with a vanishing bound.
    * @return (Matrix corresponding to dm1 contraction, Matrix corresponding to dm2 contraction)
    */
   static auto evaluateTwoBodyDirectPreBo(const Utils::Integrals::IntegralSpecifier& specifier,
                                          const Utils::Integrals::BasisSet& basis1,
                                          const Utils::Integrals::BasisSet& basis2, const Utils::DensityMatrix& dm1,
-                                         const Utils::DensityMatrix& dm2) -> std::pair<Eigen::MatrixXd, Eigen::MatrixXd>;
+                                         const Utils::DensityMatrix& dm2, double prescreeningThreshold = 1e-12)
+      -> std::pair<Eigen::MatrixXd, Eigen::MatrixXd>;
 
   /**
    * @brief Evaluates the BO contribution to the Fock matrix for different particle types.
    * Cauchy-Schwarz pre-screening is performed if basis1==basis2
-   * Operator and other infos are contained in the specifier object.
+   * Operator and other infos are contained in the specifier object. For Operator::CoulombCOM (basis1==basis2 only),
+   * the separable center-of-mass term is added to the screened Coulomb part, see TwoBody::CenterOfMassCorrection.
    * @param specifier
    * @param basis1
    * @param basis2
    * @param dm1
    * @param prescreeningThreshold
-   * @return J, K matrices.
+   * @param reorderShells If true and basis1==basis2, the shells are internally sorted by angular momentum and center
+   *                      (see ShellReordering). J and K are returned in the original basis-function order.
+   *                      A ShellReordering is built on every call; in an SCF loop, build it once and use the
+   *                      overload taking it.
+   * @return J, K matrices. In an SCF loop with basis1==basis2, TwoBody::DirectFockBuilder keeps the output and
+   *         per-thread scratch matrices between iterations instead.
    */
   static auto evaluateTwoBodyDirectBo(const Utils::Integrals::IntegralSpecifier& specifier,
                                       const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
-                                      const Utils::DensityMatrix& dm1, double prescreeningThreshold)
+                                      const Utils::DensityMatrix& dm1, double prescreeningThreshold,
+                                      bool reorderShells = false)
+      -> std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>;
+  /**
+   * @brief Evaluates the BO contribution to the Fock matrix in the reordered basis of a prebuilt ShellReordering.
+   * The density is permuted to the reordered basis and J and K back to the original basis-function order.
+   * @param specifier
+   * @param reordering The reordering of the basis, it can be kept for all iterations of an SCF.
+   * @param dm1 The density matrix in the original basis-function order.
+   * @param prescreeningThreshold
+   * @return J, K matrices in the original basis-function order.
+   */
+  static auto evaluateTwoBodyDirectBo(const Utils::Integrals::IntegralSpecifier& specifier,
+                                      const ShellReordering& reordering, const Utils::DensityMatrix& dm1,
+                                      double prescreeningThreshold)
       -> std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>;
   /**
    * @brief Accessor for the settings.
@@ -124,17 +262,21 @@ class LibintIntegrals {
   /**
    * @brief Evaluate one-body integrals between two basis sets.
    * Operator and other infos are contained in the specifier object.
-   * @return unordered_map containing matrices of type Eigen::MatrixXd
+   * @return IntegralTensor containing matrices of type Eigen::MatrixXd
    */
   static auto evaluateOneBody(const Utils::Integrals::IntegralSpecifier& specifier, const Utils::Integrals::BasisSet& basis1,
-                              const Utils::Integrals::BasisSet& basis2) -> IntegralEvaluatorMap;
+                              const Utils::Integrals::BasisSet& basis2) -> IntegralTensor;
+  /**
+   * @brief Checks whether the operator is handled by the one-body integral routine.
+   */
+  static bool isOneBodyOperator(const Utils::Integrals::Operator& op);
   /**
    * @brief Evaluate two-body integrals between two basis sets.
    * Operator and other infos are contained in the specifier object.
-   * @return unordered_map containing matrices of type Eigen::MatrixXd
+   * @return IntegralTensor containing matrices of type Eigen::MatrixXd
    */
   static auto evaluateTwoBody(const Utils::Integrals::IntegralSpecifier& specifier, const Utils::Integrals::BasisSet& basis1,
-                              const Utils::Integrals::BasisSet& basis2) -> IntegralEvaluatorMap;
+                              const Utils::Integrals::BasisSet& basis2) -> IntegralTensor;
 };
 
 } // namespace Integrals
@@ -14,81 +14,118 @@ using namespace Integrals;
 
 OneBodyIntegrals::OneBodyIntegrals(const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
                                    const Utils::Integrals::IntegralSpecifier& specifier)
-  : basis1_(basis1), basis2_(basis2), specifier_(specifier) {
+  : basis1_(basis1), basis2_(basis2) {
   dimension_.first = basis1.nbf();
   dimension_.second = basis2.nbf();
 
+  operators_.emplace_back(specifier);
+
+  _constructResultMap();
+}
+
+OneBodyIntegrals::OneBodyIntegrals(const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
+                                   const std::vector<Utils::Integrals::IntegralSpecifier>& specifiers, bool sumResults)
+  : sumResults_(sumResults), basis1_(basis1), basis2_(basis2) {
+  if (specifiers.empty()) {
+    throw std::runtime_error("No operator given for the one-body integral evaluation.");
+  }
+  dimension_.first = basis1.nbf();
+  dimension_.second = basis2.nbf();
+
+  operators_.reserve(specifiers.size());
+  for (auto const& specifier : specifiers) {
+    operators_.emplace_back(specifier);
+  }
+
   _constructResultMap();
 }
 
+OneBodyIntegrals::OneBodyIntegrals(const Utils::Integrals::BasisSet& basis,
+                                   const Utils::Integrals::IntegralSpecifier& specifier, const Eigen::MatrixXd& density,
+                                   const Utils::AtomCollection& atoms)
+  : basis1_(basis), basis2_(basis), density_(&density) {
+  dimension_.first = basis.nbf();
+  dimension_.second = basis.nbf();
+  if (density.rows() != static_cast<Eigen::Index>(basis.nbf()) || density.cols() != static_cast<Eigen::Index>(basis.nbf())) {
+    throw std::runtime_error("Density matrix does not match the basis set.");
+  }
+  if (specifier.derivOrder != 1) {
+    throw std::runtime_error("The contracted one-body gradient requires derivOrder = 1.");
+  }
+  if (specifier.op == Utils::Integrals::Operator::Dipole) {
+    throw std::runtime_error("The contracted one-body gradient is not available for the dipole operator.");
+  }
+
+  operators_.emplace_back(specifier);
+  _setUpOperator(operators_.front());
+  if (specifier.op == Utils::Integrals::Operator::PointCharges && specifier.atoms.get().size() != atoms.size()) {
+    throw std::runtime_error("The point charges of the contracted one-body gradient must be the atoms.");
+  }
+
+  shellToAtom_ = basis.shellToAtom(atoms);
+  for (auto const& atom : shellToAtom_) {
+    if (atom < 0) {
+      throw std::runtime_error("Basis function not centered on any of the atoms.");
+    }
+  }
+  gradient_ = Utils::GradientCollection::Zero(atoms.size(), 3);
+}
+
 auto OneBodyIntegrals::compute() -> void {
-  _integral();
+  if (density_ != nullptr) {
+    _contractedGradient();
+  }
+  else {
+    _integral();
+  }
 }
 
-auto OneBodyIntegrals::_constructResultMap() -> void {
-  libint2::Operator op = BasisSetHandler::scineToLibint(specifier_.op);
+auto OneBodyIntegrals::_setUpOperator(OperatorData& operatorData) -> void {
+  const auto& specifier = operatorData.specifier;
+  libint2::Operator op = BasisSetHandler::scineToLibint(specifier.op);
 
   switch (op) {
     case libint2::Operator::overlap:
-      relevantComponents_ = {Utils::Integrals::Component::none};
+      operatorData.relevantComponents = {Utils::Integrals::Component::none};
       break;
     case libint2::Operator::kinetic:
-      relevantComponents_ = {Utils::Integrals::Component::none};
+      operatorData.relevantComponents = {Utils::Integrals::Component::none};
       break;
     case libint2::Operator::nuclear:
-      relevantComponents_ = {Utils::Integrals::Component::none};
+      operatorData.relevantComponents = {Utils::Integrals::Component::none};
       break;
     case libint2::Operator::emultipole1:
-      relevantComponents_ = {Utils::Integrals::Component::x, Utils::Integrals::Component::y, Utils::Integrals::Component::z};
+      operatorData.relevantComponents = {Utils::Integrals::Component::x, Utils::Integrals::Component::y,
+                                         Utils::Integrals::Component::z};
       break;
     default:
       throw std::runtime_error("Operator not available in the one-body integral routine!");
   }
 
-  numberOfOperators_ = relevantComponents_.size();
-
-  if (specifier_.derivOrder == 1) {
-    relevantDerivKeys_ = {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y, Utils::Integrals::DerivKey::z};
+  if (specifier.derivOrder == 1) {
+    operatorData.relevantDerivKeys = {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y,
+                                      Utils::Integrals::DerivKey::z};
   }
   else {
-    relevantDerivKeys_ = {
+    operatorData.relevantDerivKeys = {
         Utils::Integrals::DerivKey::value,
     };
   }
 
   // The first center is the bra, the second center is the ket.
   // For the PointCharges operator, the remaining centers are the centers of the atoms (shells in the general case).
-  if (specifier_.derivOrder > 0 && specifier_.op == Utils::Integrals::Operator::PointCharges) {
-    assert(specifier_.atoms.has_value());
-    numberOfCenters_ = specifier_.atoms.get().size() + 2;
-    numberOfGeometricalDerivatives_ =
-        libint2::num_geometrical_derivatives(specifier_.atoms.get().size(), specifier_.derivOrder);
+  if (specifier.derivOrder > 0 && specifier.op == Utils::Integrals::Operator::PointCharges) {
+    assert(specifier.atoms.has_value());
+    operatorData.numberOfCenters = specifier.atoms.get().size() + 2;
   }
   else {
-    numberOfCenters_ = (specifier_.derivOrder > 0) ? 2 : 1;
+    operatorData.numberOfCenters = (specifier.derivOrder > 0) ? 2 : 1;
   }
-  numberOfResults_ = numberOfOperators_ * numberOfCenters_ * relevantDerivKeys_.size();
 
-  result_.reserve(numberOfResults_);
-
-  for (auto const& component : relevantComponents_) {
-    for (std::size_t center = 0; center < numberOfCenters_; ++center) {
-      for (auto const& derivKey : relevantDerivKeys_) {
-        result_[{component, derivKey, center}] = Eigen::MatrixXd::Zero(dimension_.first, dimension_.second);
-      }
-    }
-  }
-}
-
-auto OneBodyIntegrals::_integral() -> void {
+  // The prefactors and parameters are checked here, such that no exception is thrown inside the parallel region.
   double scaling = 1;
-
-  libint2::Operator op = BasisSetHandler::scineToLibint(specifier_.op);
-
-  auto s_engine = Libint::getEngine(basis1_, basis2_, op, specifier_.derivOrder);
-
   if (op == libint2::Operator::nuclear) {
-    scaling = specifier_.typeVector[0].charge;
+    scaling = specifier.typeVector[0].charge;
     // libint assumes negatively charged electrons with charge=(-1) and positive point charges.
     // therefore, we account for nuclear-nuclear repulsion with a ``-1``.
     // In the case of negatively charged particles, we have to take the absolute since the ``-`` is already implied.
@@ -96,22 +133,19 @@ auto OneBodyIntegrals::_integral() -> void {
       scaling *= (-1);
     else
       scaling = std::abs(scaling);
-    if (!specifier_.atoms.has_value())
+    if (!specifier.atoms.has_value())
       throw std::runtime_error("No atoms given in integral specifier.");
-    auto libintAtoms = BasisSetHandler::scineToLibint(specifier_.atoms.get());
-    auto pointCharges = libint2::make_point_charges(libintAtoms);
-    s_engine.set_params(pointCharges);
   }
   else if (op == libint2::Operator::kinetic) {
-    scaling = 1. / specifier_.typeVector[0].mass;
-    if (specifier_.op == Utils::Integrals::Operator::KineticCOM) {
-      if (!specifier_.totalMass.has_value())
+    scaling = 1. / specifier.typeVector[0].mass;
+    if (specifier.op == Utils::Integrals::Operator::KineticCOM) {
+      if (!specifier.totalMass.has_value())
         throw std::runtime_error("No total Mass given in integral specifier.");
-      scaling -= 1 / specifier_.totalMass.get();
+      scaling -= 1 / specifier.totalMass.get();
     }
   }
   else if (op == libint2::Operator::emultipole1) {
-    scaling = specifier_.typeVector[0].charge;
+    scaling = specifier.typeVector[0].charge;
     // libint assumes negatively charged electrons with charge=(-1) and positive point charges.
     // therefore, we account for nuclear-nuclear repulsion with a ``-1``.
     // In the case of negatively charged particles, we have to take the absolute since the ``-`` is already implied.
@@ -119,56 +153,229 @@ auto OneBodyIntegrals::_integral() -> void {
       scaling *= (-1);
     else
       scaling = std::abs(scaling);
-    if (!specifier_.multipoleOrigin.has_value())
+    if (!specifier.multipoleOrigin.has_value())
       throw std::runtime_error("No multipole origin given in integral specifier.");
-    s_engine.set_params(std::array<double, 3>{specifier_.multipoleOrigin.get()[0], specifier_.multipoleOrigin.get()[1],
-                                              specifier_.multipoleOrigin.get()[2]});
   }
+  operatorData.scaling = scaling;
+}
 
-  const auto& buf_vec = s_engine.results(); // will point to computed shell sets --> const auto& is very important
+auto OneBodyIntegrals::_constructResultMap() -> void {
+  for (auto& operatorData : operators_) {
+    _setUpOperator(operatorData);
+  }
+
+  if (sumResults_) {
+    const auto& first = operators_.front();
+    for (auto const& operatorData : operators_) {
+      if (operatorData.relevantComponents != first.relevantComponents ||
+          operatorData.relevantDerivKeys != first.relevantDerivKeys ||
+          operatorData.numberOfCenters != first.numberOfCenters) {
+        throw std::runtime_error("Only one-body operators with the same result layout can be summed.");
+      }
+    }
+  }
+
+  results_.reserve(sumResults_ ? 1 : operators_.size());
+  for (std::size_t i = 0; i < (sumResults_ ? 1 : operators_.size()); ++i) {
+    const auto& operatorData = operators_[i];
+    results_.emplace_back(operatorData.relevantComponents, operatorData.numberOfCenters, operatorData.relevantDerivKeys,
+                          dimension_.first, dimension_.second);
+  }
+}
+
+auto OneBodyIntegrals::_integral() -> void {
+  // All operators handled here are Hermitian. If both basis sets are the same, only the lower triangle of shell pairs
+  // is computed and the transposed block is mirrored into the upper triangle.
+  const bool isSymmetric = basis1_ == basis2_;
+
+  // Convert the shells once instead of once per shell pair.
+  std::vector<libint2::Shell> libintShells1;
+  libintShells1.reserve(basis1_.size());
+  for (auto const& shell : basis1_) {
+    libintShells1.push_back(BasisSetHandler::scineToLibint(shell));
+  }
+  std::vector<libint2::Shell> libintShells2;
+  if (!isSymmetric) {
+    libintShells2.reserve(basis2_.size());
+    for (auto const& shell : basis2_) {
+      libintShells2.push_back(BasisSetHandler::scineToLibint(shell));
+    }
+  }
+  const auto& shells2 = isSymmetric ? libintShells1 : libintShells2;
+
+  // Point charges are converted once and shared among the threads.
+  std::vector<std::vector<std::pair<double, std::array<double, 3>>>> pointCharges(operators_.size());
+  for (std::size_t i = 0; i < operators_.size(); ++i) {
+    if (operators_[i].specifier.op == Utils::Integrals::Operator::PointCharges) {
+      pointCharges[i] = libint2::make_point_charges(BasisSetHandler::scineToLibint(operators_[i].specifier.atoms.get()));
+    }
+  }
+
+  // The matrices each libint buffer is written to are resolved once by index arithmetic.
+  struct Target {
+    std::size_t bufferIndex;
+    double* matrix;
+    double* mirroredMatrix;
+  };
+  std::vector<std::vector<Target>> targets(operators_.size());
+  for (std::size_t i = 0; i < operators_.size(); ++i) {
+    const auto& operatorData = operators_[i];
+    auto& result = results_[sumResults_ ? 0 : i];
+    const auto numberOfDerivKeys = operatorData.relevantDerivKeys.size();
+    for (std::size_t c = 0; c < operatorData.relevantComponents.size(); ++c) {
+      const auto component = operatorData.relevantComponents[c];
+      for (std::size_t center = 0; center < operatorData.numberOfCenters; ++center) {
+        for (std::size_t d = 0; d < numberOfDerivKeys; ++d) {
+          auto index = static_cast<int>(component) * numberOfDerivKeys * operatorData.numberOfCenters +
+                       center * numberOfDerivKeys + static_cast<int>(operatorData.relevantDerivKeys[d]);
+          // Swapping bra and ket swaps the role of the first two derivative centers.
+          // Any further center (point charges) is unaffected by the transposition.
+          const auto mirroredCenter = (operatorData.specifier.derivOrder > 0 && center < 2) ? 1 - center : center;
+          targets[i].push_back({static_cast<std::size_t>(index), result.data(result.index(c, center, d)),
+                                result.data(result.index(c, mirroredCenter, d))});
+        }
+      }
+    }
+  }
 
   auto shell2bf1 = basis1_.shell2bf();
   auto shell2bf2 = basis2_.shell2bf();
 
-  // This is the most delicate part: retrieving the correct indices.
-  // iter1 and iter2 store the index of shell1 and shell2
-  for (size_t s1 = 0; s1 < basis1_.size(); ++s1) {
-    auto shell1 = BasisSetHandler::scineToLibint(basis1_[s1]);
-    for (size_t s2 = 0; s2 < basis2_.size(); ++s2) {
-      auto shell2 = BasisSetHandler::scineToLibint(basis2_[s2]);
-
-      s_engine.compute(shell1, shell2);
-
-      // Number of functions in shell 1 and 2. This depends on the angular momentum of the shell.
-      auto n1 = shell1.size();
-      auto bf1 = shell2bf1.at(s1);
-      auto n2 = shell2.size();
-      auto bf2 = shell2bf2.at(s2);
-
-      for (auto const& component : relevantComponents_) {
-        for (std::size_t center = 0; center < numberOfCenters_; ++center) {
-          for (auto const& derivKey : relevantDerivKeys_) {
-            auto index = static_cast<int>(component) * relevantDerivKeys_.size() * numberOfCenters_ +
-                         center * relevantDerivKeys_.size() + static_cast<int>(derivKey);
-            const auto* ints_shellset = buf_vec[index];
+#pragma omp parallel num_threads(Libint::getNumberOfThreads())
+  {
+    // One engine per operator and thread.
+    std::vector<Libint::EngineLease> engines;
+    engines.reserve(operators_.size());
+    for (std::size_t i = 0; i < operators_.size(); ++i) {
+      const auto& specifier = operators_[i].specifier;
+      libint2::Operator op = BasisSetHandler::scineToLibint(specifier.op);
+      engines.push_back(Libint::leaseEngine(basis1_, basis2_, op, specifier.derivOrder));
+      if (op == libint2::Operator::nuclear) {
+        engines.back()->set_params(pointCharges[i]);
+      }
+      else if (op == libint2::Operator::emultipole1) {
+        engines.back()->set_params(std::array<double, 3>{
+            specifier.multipoleOrigin.get()[0], specifier.multipoleOrigin.get()[1], specifier.multipoleOrigin.get()[2]});
+      }
+    }
+
+    // This is the most delicate part: retrieving the correct indices.
+    // s1 and s2 store the index of shell1 and shell2.
+    // The blocks of one s1 are only written by one thread, also the mirrored ones.
+#pragma omp for schedule(dynamic)
+    for (size_t s1 = 0; s1 < basis1_.size(); ++s1) {
+      const auto& shell1 = libintShells1[s1];
+      const auto s2_max = isSymmetric ? s1 + 1 : basis2_.size();
+      for (size_t s2 = 0; s2 < s2_max; ++s2) {
+        const auto& shell2 = shells2[s2];
+
+        // Number of functions in shell 1 and 2. This depends on the angular momentum of the shell.
+        auto n1 = shell1.size();
+        auto bf1 = shell2bf1.at(s1);
+        auto n2 = shell2.size();
+        auto bf2 = shell2bf2.at(s2);
+        const bool mirror = isSymmetric && s1 != s2;
+
+        for (std::size_t i = 0; i < operators_.size(); ++i) {
+          // will point to computed shell sets --> const auto& is very important
+          const auto& buf_vec = engines[i]->compute(shell1, shell2);
+          const auto scaling = operators_[i].scaling;
+
+          for (auto const& target : targets[i]) {
+            const auto* ints_shellset = buf_vec[target.bufferIndex];
             // nullptr returned if the entire shell-set was screened out
-            if (ints_shellset != nullptr) {
-              Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>> tmp(buf_vec[index], n1, n2);
-              result_[{component, derivKey, center}].block(bf1, bf2, n1, n2) = tmp * scaling;
-              // for (std::size_t f1 = 0; f1 < n1; ++f1) {
-              //  for (std::size_t f2 = 0; f2 < n2; ++f2) {
-              //    // Eigen::Map<const Eigen::MatrixXd> buf_mat(ints_shellset, n1, n2);
-              //    result_[{component, derivKey, center}](bf1 + f1, bf2 + f2) = ints_shellset[f1 * n2 + f2] * scaling;
-              //  }
-              //}
+            if (ints_shellset == nullptr) {
+              continue;
+            }
+            Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>> tmp(ints_shellset, n1, n2);
+            Eigen::Map<Eigen::MatrixXd> matrix(target.matrix, dimension_.first, dimension_.second);
+            Eigen::Map<Eigen::MatrixXd> mirroredMatrix(target.mirroredMatrix, dimension_.first, dimension_.second);
+            if (sumResults_) {
+              matrix.block(bf1, bf2, n1, n2) += tmp * scaling;
+              if (mirror) {
+                mirroredMatrix.block(bf2, bf1, n2, n1) += tmp.transpose() * scaling;
+              }
+            }
+            else {
+              matrix.block(bf1, bf2, n1, n2) = tmp * scaling;
+              if (mirror) {
+                mirroredMatrix.block(bf2, bf1, n2, n1) = tmp.transpose() * scaling;
+              }
             }
           }
         }
-      }
-    } // s2
-  }   // s1
+      } // s2
+    }   // s1
+  }
+}
+
+auto OneBodyIntegrals::_contractedGradient() -> void {
+  const auto& operatorData = operators_.front();
+  const auto& specifier = operatorData.specifier;
+  const auto& D = *density_;
+  libint2::Operator op = BasisSetHandler::scineToLibint(specifier.op);
+
+  std::vector<libint2::Shell> libintShells;
+  libintShells.reserve(basis1_.size());
+  for (auto const& shell : basis1_) {
+    libintShells.push_back(BasisSetHandler::scineToLibint(shell));
+  }
+  std::vector<std::pair<double, std::array<double, 3>>> pointCharges;
+  if (op == libint2::Operator::nuclear) {
+    pointCharges = libint2::make_point_charges(BasisSetHandler::scineToLibint(specifier.atoms.get()));
+  }
+  auto shell2bf = basis1_.shell2bf();
+  const auto numberOfCenters = operatorData.numberOfCenters;
+
+#pragma omp parallel num_threads(Libint::getNumberOfThreads())
+  {
+    auto engine = Libint::leaseEngine(basis1_, basis2_, op, 1);
+    if (op == libint2::Operator::nuclear) {
+      engine->set_params(pointCharges);
+    }
+    Utils::GradientCollection localGradient = Utils::GradientCollection::Zero(gradient_.rows(), 3);
+
+    // Only s2 <= s1 is evaluated. The transposed block yields the same contraction since the density is symmetric.
+#pragma omp for schedule(dynamic)
+    for (size_t s1 = 0; s1 < basis1_.size(); ++s1) {
+      const auto& shell1 = libintShells[s1];
+      for (size_t s2 = 0; s2 <= s1; ++s2) {
+        const auto& shell2 = libintShells[s2];
+        auto n1 = shell1.size();
+        auto n2 = shell2.size();
+        const auto densityBlock = D.block(shell2bf[s1], shell2bf[s2], n1, n2);
+        const double factor = (s1 == s2 ? 1.0 : 2.0) * operatorData.scaling;
+
+        const auto& buf_vec = engine->compute(shell1, shell2);
+        // The first center is the bra, the second center is the ket, the remaining ones are the point charges.
+        for (std::size_t center = 0; center < numberOfCenters; ++center) {
+          const auto atom = (center == 0) ? shellToAtom_[s1] : (center == 1) ? shellToAtom_[s2] : center - 2;
+          for (int k = 0; k < 3; ++k) {
+            const auto* ints_shellset = buf_vec[center * 3 + k];
+            if (ints_shellset == nullptr) {
+              continue;
+            }
+            localGradient(atom, k) +=
+                factor *
+                (densityBlock.array() * Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>(ints_shellset, n1, n2).array())
+                    .sum();
+          }
+        }
+      } // s2
+    }   // s1
+#pragma omp critical(oneBodyGradientReduction)
+    { gradient_ += localGradient; }
+  }
+}
+
+auto OneBodyIntegrals::getGradient() -> Utils::GradientCollection {
+  return std::move(gradient_);
+}
+
+auto OneBodyIntegrals::getResult() -> IntegralTensor {
+  return std::move(results_.front());
 }
 
-auto OneBodyIntegrals::getResult() -> IntegralEvaluatorMap {
-  return std::move(result_);
+auto OneBodyIntegrals::getResults() -> std::vector<IntegralTensor> {
+  return std::move(results_);
 }
@@ -20,20 +20,36 @@ namespace Integrals {
 /**
  * @class OneBodyIntegrals
  * This class is called by the `LibintInterface`, and it computes the one-body integrals.
+ * Several operators can be evaluated in a single pass over the shell pairs. In that case the shell conversion, the
+ * shell-pair loop and the thread scheduling are shared among all operators.
+ * In gradient mode, the first derivatives are contracted with a density matrix shell pair by shell pair, and only the
+ * resulting nuclear gradient is stored.
  */
 class OneBodyIntegrals {
  private:
-  IntegralEvaluatorMap result_;
-  std::vector<Utils::Integrals::Component> relevantComponents_;
-  std::vector<Utils::Integrals::DerivKey> relevantDerivKeys_;
+  /**
+   * @brief Result layout and prefactor of one operator.
+   */
+  struct OperatorData {
+    explicit OperatorData(const Utils::Integrals::IntegralSpecifier& specifier) : specifier(specifier) {
+    }
+    const Utils::Integrals::IntegralSpecifier& specifier;
+    std::vector<Utils::Integrals::Component> relevantComponents;
+    std::vector<Utils::Integrals::DerivKey> relevantDerivKeys;
+    std::size_t numberOfCenters = 1;
+    double scaling = 1.;
+  };
+
+  std::vector<IntegralTensor> results_;
+  std::vector<OperatorData> operators_;
   std::pair<size_t, size_t> dimension_;
-  std::size_t numberOfOperators_;
-  std::size_t numberOfResults_;
-  std::size_t numberOfGeometricalDerivatives_;
-  std::size_t numberOfCenters_;
+  bool sumResults_ = false;
   const Utils::Integrals::BasisSet& basis1_;
   const Utils::Integrals::BasisSet& basis2_;
-  const Utils::Integrals::IntegralSpecifier& specifier_;
+  // Gradient mode, only set if the derivatives are contracted on the fly.
+  const Eigen::MatrixXd* density_ = nullptr;
+  std::vector<long> shellToAtom_;
+  Utils::GradientCollection gradient_;
 
  public:
   /**
@@ -45,6 +61,31 @@ class OneBodyIntegrals {
   OneBodyIntegrals(const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
                    const Utils::Integrals::IntegralSpecifier& specifier);
 
+  /**
+   * @brief Constructor for several one-body operators evaluated in a single pass.
+   * The specifiers are referenced, they must outlive this object.
+   * @param basis1
+   * @param basis2
+   * @param specifiers One specifier per operator.
+   * @param sumResults If true, all operators are accumulated into one result (e.g., T + V for the core
+   *                   Hamiltonian). This requires all operators to have the same result layout.
+   */
+  OneBodyIntegrals(const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
+                   const std::vector<Utils::Integrals::IntegralSpecifier>& specifiers, bool sumResults = false);
+
+  /**
+   * @brief Constructor for the gradient mode.
+   * The first derivatives of the operator are contracted with `density`, no derivative matrix is stored.
+   * The specifier and the density are referenced, they must outlive this object.
+   * @param basis The basis of both the bra and the ket.
+   * @param specifier The operator, derivOrder must be 1. For PointCharges, the charges must be the `atoms`.
+   * @param density The symmetric matrix the derivatives are contracted with, e.g. the density matrix or, for the
+   *                overlap, the energy-weighted density matrix.
+   * @param atoms The atoms the basis functions are centered on.
+   */
+  OneBodyIntegrals(const Utils::Integrals::BasisSet& basis, const Utils::Integrals::IntegralSpecifier& specifier,
+                   const Eigen::MatrixXd& density, const Utils::AtomCollection& atoms);
+
   /**
    * @brief Do the actual computation
    */
@@ -52,14 +93,31 @@ class OneBodyIntegrals {
 
   /**
    * @brief After `compute` has been called, the result can be retrieved with this method.
+   * If several operators were evaluated, this is the result of the first one, or the sum if the results were summed.
    * @return
    */
-  auto getResult() -> IntegralEvaluatorMap;
+  auto getResult() -> IntegralTensor;
+
+  /**
+   * @brief After `compute` has been called, the results of all operators can be retrieved with this method.
+   * @return One result per specifier, in the order of the specifiers. A single result if the results were summed.
+   */
+  auto getResults() -> std::vector<IntegralTensor>;
+
+  /**
+   * @brief After `compute` has been called in gradient mode, the gradient can be retrieved with this method.
+   * @return The contraction of the derivatives with the density, one row per atom.
+   */
+  auto getGradient() -> Utils::GradientCollection;
 
  private:
   auto _integral() -> void;
 
+  auto _contractedGradient() -> void;
+
   auto _constructResultMap() -> void;
+
+  auto _setUpOperator(OperatorData& operatorData) -> void;
 };
 
 } // namespace Integrals
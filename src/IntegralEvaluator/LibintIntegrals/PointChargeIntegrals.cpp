@@ -0,0 +1,171 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/BasisSetHandler.h>
+#include <LibintIntegrals/Libint.h>
+#include <LibintIntegrals/PointChargeIntegrals.h>
+#include <cmath>
+#include <limits>
+
+using namespace Scine;
+using namespace Integrals;
+
+namespace {
+/*
+ * Center and radius of the charge distribution of a shell pair.
+ * The center is the Gaussian product center of the most diffuse primitive pair. The radius encloses the region in
+ * which any non-negligible primitive product exceeds `threshold`.
+ */
+auto shellPairExtent(const libint2::Shell& shell1, const libint2::Shell& shell2, double threshold)
+    -> std::pair<Eigen::Vector3d, double> {
+  const Eigen::Vector3d A(shell1.O[0], shell1.O[1], shell1.O[2]);
+  const Eigen::Vector3d B(shell2.O[0], shell2.O[1], shell2.O[2]);
+  const double AB2 = (A - B).squaredNorm();
+  const double logThreshold = -std::log(threshold);
+  int l = 0;
+  for (const auto& contraction : shell1.contr) {
+    l = std::max(contraction.l, l);
+  }
+  for (const auto& contraction : shell2.contr) {
+    l = std::max(contraction.l, l);
+  }
+
+  std::vector<std::pair<Eigen::Vector3d, double>> primitivePairs;
+  double minimalGamma = std::numeric_limits<double>::max();
+  Eigen::Vector3d center = 0.5 * (A + B);
+  for (auto const& a : shell1.alpha) {
+    for (auto const& b : shell2.alpha) {
+      const double gamma = a + b;
+      const double exponent = logThreshold - a * b / gamma * AB2;
+      if (exponent <= 0) {
+        continue;
+      }
+      const Eigen::Vector3d P = (a * A + b * B) / gamma;
+      // The polynomial part widens the distribution for higher angular momenta.
+      primitivePairs.emplace_back(P, std::sqrt(exponent / gamma) + std::sqrt(l / (2 * gamma)));
+      if (gamma < minimalGamma) {
+        minimalGamma = gamma;
+        center = P;
+      }
+    }
+  }
+
+  double radius = 0.0;
+  for (auto const& primitivePair : primitivePairs) {
+    radius = std::max(radius, (primitivePair.first - center).norm() + primitivePair.second);
+  }
+  return {center, radius};
+}
+} // namespace
+
+PointChargeIntegrals::PointChargeIntegrals(const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
+                                           const Utils::Integrals::IntegralSpecifier& specifier,
+                                           std::vector<PointCharge> charges, double openingAngle, double extentThreshold)
+  : basis1_(basis1),
+    basis2_(basis2),
+    octree_(std::move(charges)),
+    openingAngle_(openingAngle),
+    extentThreshold_(extentThreshold),
+    particleCharge_(specifier.typeVector.at(0).charge),
+    result_({Utils::Integrals::Component::none}, 1, {Utils::Integrals::DerivKey::value}, basis1.nbf(), basis2.nbf()) {
+  if (specifier.derivOrder != 0) {
+    throw std::runtime_error("Only integral values are available for the expanded point-charge integrals.");
+  }
+  if (openingAngle_ < 0 || openingAngle_ >= 1) {
+    throw std::runtime_error("The opening angle of the point-charge expansion must be in [0, 1).");
+  }
+}
+
+auto PointChargeIntegrals::compute() -> void {
+  const bool isSymmetric = basis1_ == basis2_;
+
+  std::vector<libint2::Shell> libintShells1;
+  libintShells1.reserve(basis1_.size());
+  for (auto const& shell : basis1_) {
+    libintShells1.push_back(BasisSetHandler::scineToLibint(shell));
+  }
+  std::vector<libint2::Shell> libintShells2;
+  if (!isSymmetric) {
+    libintShells2.reserve(basis2_.size());
+    for (auto const& shell : basis2_) {
+      libintShells2.push_back(BasisSetHandler::scineToLibint(shell));
+    }
+  }
+  const auto& shells2 = isSymmetric ? libintShells1 : libintShells2;
+
+  auto shell2bf1 = basis1_.shell2bf();
+  auto shell2bf2 = basis2_.shell2bf();
+  double* resultPtr = result_.data(0);
+  const auto nRows = result_.rows();
+  const auto nCols = result_.cols();
+
+#pragma omp parallel num_threads(Libint::getNumberOfThreads())
+  {
+    auto nuclearEngine = Libint::leaseEngine(basis1_, basis2_, libint2::Operator::nuclear, 0);
+    auto multipoleEngine = Libint::leaseEngine(basis1_, basis2_, libint2::Operator::emultipole2, 0);
+    std::vector<std::pair<double, std::array<double, 3>>> nearCharges;
+    Eigen::Map<Eigen::MatrixXd> result(resultPtr, nRows, nCols);
+
+    // The blocks of one s1 are only written by one thread, also the mirrored ones.
+#pragma omp for schedule(dynamic)
+    for (size_t s1 = 0; s1 < basis1_.size(); ++s1) {
+      const auto& shell1 = libintShells1[s1];
+      const auto s2_max = isSymmetric ? s1 + 1 : basis2_.size();
+      for (size_t s2 = 0; s2 < s2_max; ++s2) {
+        const auto& shell2 = shells2[s2];
+        auto n1 = shell1.size();
+        auto bf1 = shell2bf1.at(s1);
+        auto n2 = shell2.size();
+        auto bf2 = shell2bf2.at(s2);
+
+        const auto extent = shellPairExtent(shell1, shell2, extentThreshold_);
+        PointChargeOctree::PotentialExpansion expansion;
+        octree_.collect(extent.first, extent.second, openingAngle_, expansion, nearCharges);
+
+        Eigen::Matrix<double, -1, -1, Eigen::RowMajor> block = Eigen::Matrix<double, -1, -1, Eigen::RowMajor>::Zero(n1, n2);
+
+        // libint's nuclear operator yields -sum_C q_C <1/|r-C|>, i.e. the attraction of a particle with charge -1.
+        if (!nearCharges.empty()) {
+          nuclearEngine->set_params(nearCharges);
+          const auto& buf_vec = nuclearEngine->compute(shell1, shell2);
+          if (buf_vec[0] != nullptr) {
+            block -= particleCharge_ * Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>(buf_vec[0], n1, n2);
+          }
+        }
+
+        // Far field: q <phi(P) + grad phi(P) (r-P) + 1/2 (r-P)^T H(P) (r-P)>.
+        // libint's multipole integrals carry a minus sign for all moments beyond the overlap.
+        if (nearCharges.size() < octree_.size()) {
+          multipoleEngine->set_params(std::array<double, 3>{extent.first[0], extent.first[1], extent.first[2]});
+          const auto& buf_vec = multipoleEngine->compute(shell1, shell2);
+          if (buf_vec[0] != nullptr) {
+            using ShellBlock = Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>;
+            Eigen::Matrix<double, -1, -1, Eigen::RowMajor> farField = expansion.potential * ShellBlock(buf_vec[0], n1, n2);
+            for (int a = 0; a < 3; ++a) {
+              farField -= expansion.gradient[a] * ShellBlock(buf_vec[1 + a], n1, n2);
+            }
+            // Second moments are xx, xy, xz, yy, yz, zz, the off-diagonal ones appear twice in the contraction.
+            constexpr std::array<double, 6> hessianWeights = {0.5, 1.0, 1.0, 0.5, 1.0, 0.5};
+            for (int h = 0; h < 6; ++h) {
+              farField -= hessianWeights[h] * expansion.hessian[h] * ShellBlock(buf_vec[4 + h], n1, n2);
+            }
+            block += particleCharge_ * farField;
+          }
+        }
+
+        result.block(bf1, bf2, n1, n2) = block;
+        if (isSymmetric && s1 != s2) {
+          result.block(bf2, bf1, n2, n1) = block.transpose();
+        }
+      } // s2
+    }   // s1
+  }
+}
+
+auto PointChargeIntegrals::getResult() -> IntegralTensor {
+  return std::move(result_);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_POINTCHARGEINTEGRALS_H
+#define INTEGRALEVALUATOR_POINTCHARGEINTEGRALS_H
+
+/* internal */
+#include <LibintIntegrals/LibintIntegrals.h>
+#include <LibintIntegrals/PointChargeOctree.h>
+/* external */
+#include <Utils/DataStructures/IntegralSpecifier.h>
+
+namespace Scine {
+namespace Integrals {
+
+/**
+ * @class PointChargeIntegrals
+ * This class computes the attraction/repulsion integrals of a particle with a large number of classical point
+ * charges, e.g. the MM charges of a QM/MM calculation.
+ *
+ * The charges are grouped in an octree. For every shell pair, the potential of the charges that are far from the
+ * pair's charge distribution is Taylor expanded around the center of the pair up to second order, such that only the
+ * overlap, dipole and quadrupole integrals of the pair are needed. Distant octree nodes enter this expansion through
+ * their multipole moments. Only the charges close to the shell pair are evaluated exactly with libint.
+ */
+class PointChargeIntegrals {
+ public:
+  /**
+   * @brief Constructor.
+   * @param basis1
+   * @param basis2
+   * @param specifier Particle type of the basis functions. Only integral values (derivOrder == 0) are supported.
+   * @param charges The point charges.
+   * @param openingAngle Ratio of the extent of a shell pair (plus the node radius) and the distance to a charge (node)
+   *                     below which the charge (node) is treated by the expansion. 0 evaluates all charges exactly.
+   * @param extentThreshold Density threshold defining the extent of a shell pair.
+   */
+  PointChargeIntegrals(const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
+                       const Utils::Integrals::IntegralSpecifier& specifier, std::vector<PointCharge> charges,
+                       double openingAngle = 0.25, double extentThreshold = 1e-10);
+
+  /**
+   * @brief Do the actual computation
+   */
+  auto compute() -> void;
+
+  /**
+   * @brief After `compute` has been called, the result can be retrieved with this method.
+   */
+  auto getResult() -> IntegralTensor;
+
+ private:
+  const Utils::Integrals::BasisSet& basis1_;
+  const Utils::Integrals::BasisSet& basis2_;
+  PointChargeOctree octree_;
+  double openingAngle_;
+  double extentThreshold_;
+  double particleCharge_;
+  IntegralTensor result_;
+};
+
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_POINTCHARGEINTEGRALS_H
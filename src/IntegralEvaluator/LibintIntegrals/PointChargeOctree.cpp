@@ -0,0 +1,216 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/PointChargeOctree.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace Scine;
+using namespace Integrals;
+
+namespace {
+// Pairs of Cartesian indices in the order of PotentialExpansion::hessian.
+constexpr std::array<std::array<int, 2>, 6> hessianIndices = {{{0, 0}, {0, 1}, {0, 2}, {1, 1}, {1, 2}, {2, 2}}};
+
+inline double delta(int a, int b) {
+  return a == b ? 1.0 : 0.0;
+}
+
+/*
+ * Cartesian derivatives of 1/r at R.
+ * T2_ab = (3 R_a R_b - r^2 d_ab) / r^5
+ * T3_abc = -(15 R_a R_b R_c - 3 r^2 (R_a d_bc + R_b d_ac + R_c d_ab)) / r^7
+ * T4_abcd = (105 R_a R_b R_c R_d - 15 r^2 (R_a R_b d_cd + 5 perm.) + 3 r^4 (d_ab d_cd + d_ac d_bd + d_ad d_bc)) / r^9
+ */
+inline double t2(const Eigen::Vector3d& R, double r2, double invR5, int a, int b) {
+  return (3 * R[a] * R[b] - r2 * delta(a, b)) * invR5;
+}
+
+inline double t3(const Eigen::Vector3d& R, double r2, double invR7, int a, int b, int c) {
+  return -(15 * R[a] * R[b] * R[c] - 3 * r2 * (R[a] * delta(b, c) + R[b] * delta(a, c) + R[c] * delta(a, b))) * invR7;
+}
+
+inline double t4(const Eigen::Vector3d& R, double r2, double invR9, int a, int b, int c, int d) {
+  const double sixTerms = R[a] * R[b] * delta(c, d) + R[a] * R[c] * delta(b, d) + R[a] * R[d] * delta(b, c) +
+                          R[b] * R[c] * delta(a, d) + R[b] * R[d] * delta(a, c) + R[c] * R[d] * delta(a, b);
+  const double threeTerms = delta(a, b) * delta(c, d) + delta(a, c) * delta(b, d) + delta(a, d) * delta(b, c);
+  return (105 * R[a] * R[b] * R[c] * R[d] - 15 * r2 * sixTerms + 3 * r2 * r2 * threeTerms) * invR9;
+}
+} // namespace
+
+PointChargeOctree::PointChargeOctree(std::vector<PointCharge> charges, std::size_t leafSize)
+  : leafSize_(std::max<std::size_t>(leafSize, 1)), charges_(std::move(charges)) {
+  if (charges_.empty()) {
+    return;
+  }
+  Eigen::Vector3d lower = charges_.front().position;
+  Eigen::Vector3d upper = charges_.front().position;
+  for (auto const& charge : charges_) {
+    lower = lower.cwiseMin(charge.position);
+    upper = upper.cwiseMax(charge.position);
+  }
+  Node root;
+  root.center = 0.5 * (lower + upper);
+  root.halfWidth = 0.5 * (upper - lower).maxCoeff();
+  root.begin = 0;
+  root.end = charges_.size();
+  nodes_.push_back(root);
+  build(0, 0);
+}
+
+void PointChargeOctree::build(std::size_t nodeIndex, int depth) {
+  // nodes_ grows during the recursion, therefore the node is only accessed by index.
+  {
+    auto& node = nodes_[nodeIndex];
+    for (std::size_t i = node.begin; i < node.end; ++i) {
+      const auto& charge = charges_[i];
+      const Eigen::Vector3d distance = charge.position - node.center;
+      node.charge += charge.charge;
+      node.dipole += charge.charge * distance;
+      node.secondMoment += charge.charge * distance * distance.transpose();
+      node.radius = std::max(node.radius, distance.norm());
+    }
+    if (node.end - node.begin <= leafSize_ || depth >= maxDepth_) {
+      return;
+    }
+  }
+
+  const Eigen::Vector3d center = nodes_[nodeIndex].center;
+  const double childHalfWidth = 0.5 * nodes_[nodeIndex].halfWidth;
+  const auto begin = nodes_[nodeIndex].begin;
+  const auto end = nodes_[nodeIndex].end;
+  auto octant = [&center](const PointCharge& charge) {
+    return int(charge.position[0] > center[0]) + 2 * int(charge.position[1] > center[1]) +
+           4 * int(charge.position[2] > center[2]);
+  };
+  std::stable_sort(charges_.begin() + begin, charges_.begin() + end,
+                   [&octant](const PointCharge& a, const PointCharge& b) { return octant(a) < octant(b); });
+
+  const auto firstChild = nodes_.size();
+  std::size_t childBegin = begin;
+  for (int o = 0; o < 8 && childBegin < end; ++o) {
+    auto childEnd = childBegin;
+    while (childEnd < end && octant(charges_[childEnd]) == o) {
+      ++childEnd;
+    }
+    if (childEnd == childBegin) {
+      continue;
+    }
+    Node child;
+    child.halfWidth = childHalfWidth;
+    child.center = center + childHalfWidth * Eigen::Vector3d((o & 1) ? 1 : -1, (o & 2) ? 1 : -1, (o & 4) ? 1 : -1);
+    child.begin = childBegin;
+    child.end = childEnd;
+    nodes_.push_back(child);
+    childBegin = childEnd;
+  }
+  nodes_[nodeIndex].firstChild = firstChild;
+  nodes_[nodeIndex].numberOfChildren = nodes_.size() - firstChild;
+  for (auto child = firstChild; child < firstChild + nodes_[nodeIndex].numberOfChildren; ++child) {
+    build(child, depth + 1);
+  }
+}
+
+void PointChargeOctree::collect(const Eigen::Vector3d& center, double extent, double openingAngle,
+                                PotentialExpansion& expansion,
+                                std::vector<std::pair<double, std::array<double, 3>>>& nearCharges) const {
+  nearCharges.clear();
+  if (nodes_.empty()) {
+    return;
+  }
+  std::vector<std::size_t> stack = {0};
+  while (!stack.empty()) {
+    const auto& node = nodes_[stack.back()];
+    stack.pop_back();
+    const Eigen::Vector3d nodeDistance = center - node.center;
+    if (node.radius + extent < openingAngle * nodeDistance.norm()) {
+      addNode(node, nodeDistance, expansion);
+    }
+    else if (node.numberOfChildren == 0) {
+      for (auto i = node.begin; i < node.end; ++i) {
+        const auto& charge = charges_[i];
+        const Eigen::Vector3d distance = center - charge.position;
+        if (extent < openingAngle * distance.norm()) {
+          addPointCharge(charge.charge, distance, expansion);
+        }
+        else {
+          nearCharges.push_back({charge.charge, {charge.position[0], charge.position[1], charge.position[2]}});
+        }
+      }
+    }
+    else {
+      for (auto child = node.firstChild; child < node.firstChild + node.numberOfChildren; ++child) {
+        stack.push_back(child);
+      }
+    }
+  }
+}
+
+void PointChargeOctree::addPointCharge(double charge, const Eigen::Vector3d& distance, PotentialExpansion& expansion) {
+  const double r2 = distance.squaredNorm();
+  const double invR = 1.0 / std::sqrt(r2);
+  const double invR3 = invR * invR * invR;
+  const double invR5 = invR3 * invR * invR;
+  expansion.potential += charge * invR;
+  for (int a = 0; a < 3; ++a) {
+    expansion.gradient[a] -= charge * distance[a] * invR3;
+  }
+  for (std::size_t h = 0; h < hessianIndices.size(); ++h) {
+    expansion.hessian[h] += charge * t2(distance, r2, invR5, hessianIndices[h][0], hessianIndices[h][1]);
+  }
+}
+
+void PointChargeOctree::addNode(const Node& node, const Eigen::Vector3d& distance, PotentialExpansion& expansion) {
+  // Taylor expansion of 1/|R - s| in the charge displacements s from the node center:
+  // sum_i q_i / |R - s_i| = q T0 - p_a T1_a + 1/2 Q_ab T2_ab, and accordingly for the derivatives.
+  const double r2 = distance.squaredNorm();
+  const double invR = 1.0 / std::sqrt(r2);
+  const double invR2 = invR * invR;
+  const double invR3 = invR2 * invR;
+  const double invR5 = invR3 * invR2;
+  const double invR7 = invR5 * invR2;
+  const double invR9 = invR7 * invR2;
+  const auto& p = node.dipole;
+  const auto& Q = node.secondMoment;
+
+  double potential = node.charge * invR;
+  for (int a = 0; a < 3; ++a) {
+    potential += p[a] * distance[a] * invR3;
+    for (int b = 0; b < 3; ++b) {
+      potential += 0.5 * Q(a, b) * t2(distance, r2, invR5, a, b);
+    }
+  }
+  expansion.potential += potential;
+
+  for (int c = 0; c < 3; ++c) {
+    double gradient = -node.charge * distance[c] * invR3;
+    for (int a = 0; a < 3; ++a) {
+      gradient -= p[a] * t2(distance, r2, invR5, a, c);
+      for (int b = 0; b < 3; ++b) {
+        gradient += 0.5 * Q(a, b) * t3(distance, r2, invR7, a, b, c);
+      }
+    }
+    expansion.gradient[c] += gradient;
+  }
+
+  for (std::size_t h = 0; h < hessianIndices.size(); ++h) {
+    const int c = hessianIndices[h][0];
+    const int d = hessianIndices[h][1];
+    double hessian = node.charge * t2(distance, r2, invR5, c, d);
+    for (int a = 0; a < 3; ++a) {
+      hessian -= p[a] * t3(distance, r2, invR7, a, c, d);
+      for (int b = 0; b < 3; ++b) {
+        hessian += 0.5 * Q(a, b) * t4(distance, r2, invR9, a, b, c, d);
+      }
+    }
+    expansion.hessian[h] += hessian;
+  }
+}
+
+std::size_t PointChargeOctree::size() const {
+  return charges_.size();
+}
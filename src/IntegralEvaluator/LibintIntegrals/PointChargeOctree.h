@@ -0,0 +1,99 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_POINTCHARGEOCTREE_H
+#define INTEGRALEVALUATOR_POINTCHARGEOCTREE_H
+
+#include <Eigen/Core>
+#include <array>
+#include <vector>
+
+namespace Scine {
+namespace Integrals {
+
+/**
+ * @brief A classical point charge, e.g. an MM atom in a QM/MM calculation.
+ */
+struct PointCharge {
+  double charge;
+  Eigen::Vector3d position;
+};
+
+/**
+ * @class PointChargeOctree @file PointChargeOctree.h
+ * @brief Spatial grouping of point charges.
+ *
+ * Every node stores the monopole, dipole and (Cartesian) second moment of its charges about the center of its box,
+ * such that the electrostatic potential of a whole node can be expanded at a distant point.
+ */
+class PointChargeOctree {
+ public:
+  /**
+   * @brief Taylor expansion of the electrostatic potential around a point, up to the second derivatives.
+   * The Hessian is stored as xx, xy, xz, yy, yz, zz.
+   */
+  struct PotentialExpansion {
+    double potential = 0.0;
+    std::array<double, 3> gradient = {0.0, 0.0, 0.0};
+    std::array<double, 6> hessian = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  };
+
+  /**
+   * @brief Constructor building the tree.
+   * @param charges The point charges. They are copied and reordered such that the charges of a node are contiguous.
+   * @param leafSize A node is split if it contains more charges than this.
+   */
+  explicit PointChargeOctree(std::vector<PointCharge> charges, std::size_t leafSize = 32);
+
+  /**
+   * @brief Collects the contribution of all charges to the potential expansion around `center`.
+   *
+   * A node is expanded in its moments if (node radius + `extent`) < `openingAngle` * distance, a single charge
+   * is expanded if `extent` < `openingAngle` * distance. All remaining charges are returned in `nearCharges`
+   * (in the libint format) and must be treated exactly.
+   * The truncation error of both expansions is of third order in `openingAngle`.
+   * @param center The expansion point, e.g. the center of a shell pair.
+   * @param extent The radius around `center` within which the expansion must not be applied.
+   * @param openingAngle 0 treats all charges exactly.
+   * @param expansion The far-field potential expansion, accumulated.
+   * @param nearCharges The near charges, cleared first.
+   */
+  void collect(const Eigen::Vector3d& center, double extent, double openingAngle, PotentialExpansion& expansion,
+               std::vector<std::pair<double, std::array<double, 3>>>& nearCharges) const;
+
+  std::size_t size() const;
+
+ private:
+  struct Node {
+    Eigen::Vector3d center;
+    double halfWidth;
+    // Largest distance of a charge of the node from its center.
+    double radius = 0.0;
+    double charge = 0.0;
+    Eigen::Vector3d dipole = Eigen::Vector3d::Zero();
+    Eigen::Matrix3d secondMoment = Eigen::Matrix3d::Zero();
+    std::size_t begin;
+    std::size_t end;
+    // Index of the first of the consecutively stored children, 0 for leaves.
+    std::size_t firstChild = 0;
+    std::size_t numberOfChildren = 0;
+  };
+
+  void build(std::size_t nodeIndex, int depth);
+  static void addPointCharge(double charge, const Eigen::Vector3d& distance, PotentialExpansion& expansion);
+  static void addNode(const Node& node, const Eigen::Vector3d& distance, PotentialExpansion& expansion);
+
+  static constexpr int maxDepth_ = 20;
+  std::size_t leafSize_;
+  std::vector<PointCharge> charges_;
+  std::vector<Node> nodes_;
+};
+
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_POINTCHARGEOCTREE_H
@@ -0,0 +1,181 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/Libint.h>
+#include <LibintIntegrals/ShellReordering.h>
+#include <Utils/DataStructures/DensityMatrix.h>
+#include <Utils/DataStructures/SpinAdaptedMatrix.h>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+using namespace Scine;
+using namespace Integrals;
+
+namespace {
+// Interleaves the lowest 10 bits of x, y and z.
+auto mortonCode(std::uint32_t x, std::uint32_t y, std::uint32_t z) -> std::uint32_t {
+  auto spread = [](std::uint32_t v) {
+    v &= 0x3ffU;
+    v = (v | (v << 16U)) & 0x030000ffU;
+    v = (v | (v << 8U)) & 0x0300f00fU;
+    v = (v | (v << 4U)) & 0x030c30c3U;
+    v = (v | (v << 2U)) & 0x09249249U;
+    return v;
+  };
+  return spread(x) | (spread(y) << 1U) | (spread(z) << 2U);
+}
+
+auto permute(const Eigen::MatrixXd& matrix, const std::vector<Eigen::Index>& order) -> Eigen::MatrixXd {
+  const auto n = static_cast<Eigen::Index>(order.size());
+  Eigen::MatrixXd permuted(n, n);
+  for (Eigen::Index j = 0; j < n; ++j) {
+    for (Eigen::Index i = 0; i < n; ++i) {
+      permuted(i, j) = matrix(order[i], order[j]);
+    }
+  }
+  return permuted;
+}
+} // namespace
+
+ShellReordering::ShellReordering(const Utils::Integrals::BasisSet& basis, double ln_prec)
+  : basis_(basis.getAtoms()), shellOrder_(basis.size()) {
+  std::iota(shellOrder_.begin(), shellOrder_.end(), 0);
+
+  std::vector<std::uint32_t> codes(basis.size(), 0);
+  if (!basis.empty()) {
+    Eigen::RowVector3d lower = basis[0].getShift();
+    Eigen::RowVector3d upper = basis[0].getShift();
+    for (auto const& shell : basis) {
+      lower = lower.cwiseMin(shell.getShift());
+      upper = upper.cwiseMax(shell.getShift());
+    }
+    const double extent = std::max((upper - lower).maxCoeff(), 1e-12);
+    for (std::size_t s = 0; s < basis.size(); ++s) {
+      const Eigen::RowVector3d cell = (basis[s].getShift() - lower) / extent * 1023.0;
+      codes[s] = mortonCode(static_cast<std::uint32_t>(cell[0]), static_cast<std::uint32_t>(cell[1]),
+                            static_cast<std::uint32_t>(cell[2]));
+    }
+  }
+  // Stable: shells of one center and angular momentum keep their original order.
+  std::stable_sort(shellOrder_.begin(), shellOrder_.end(), [&](std::size_t lhs, std::size_t rhs) {
+    if (basis[lhs].l() != basis[rhs].l()) {
+      return basis[lhs].l() < basis[rhs].l();
+    }
+    return codes[lhs] < codes[rhs];
+  });
+
+  const auto shell2bf = basis.shell2bf();
+  functionOrder_.reserve(basis.nbf());
+  for (auto const s : shellOrder_) {
+    basis_.push_back(basis[s]);
+    for (std::size_t f = 0; f < basis[s].size(); ++f) {
+      functionOrder_.push_back(static_cast<Eigen::Index>(shell2bf[s] + f));
+    }
+  }
+  basis_.setPureSpherical(basis.isPureSpherical());
+
+  if (basis.areShellPairsEvaluated()) {
+    permuteShellPairs(basis, ln_prec);
+  }
+}
+
+void ShellReordering::permuteShellPairs(const Utils::Integrals::BasisSet& basis, double ln_prec) {
+  const auto& shellPairs = *basis.getShellPairs();
+  std::vector<std::size_t> newIndex(basis.size());
+  for (std::size_t s = 0; s < shellOrder_.size(); ++s) {
+    newIndex[shellOrder_[s]] = s;
+  }
+
+  // Every pair is stored with the shell of larger index first, i.e. in the list of its larger new index.
+  // (original shell, position of the pair in its list) of all pairs of every reordered shell:
+  std::vector<std::vector<std::pair<std::size_t, std::size_t>>> origins(basis_.size());
+  for (std::size_t s1 = 0; s1 < shellPairs.size(); ++s1) {
+    for (std::size_t p = 0; p < shellPairs[s1].size(); ++p) {
+      const auto n2 = newIndex[shellPairs[s1][p].secondShellIndex];
+      origins[std::max(newIndex[s1], n2)].emplace_back(s1, p);
+    }
+  }
+
+  const bool hasCauchySchwarzFactor = shellPairs.hasCauchySchwarzFactor();
+  auto reorderedPairs = std::make_shared<Utils::Integrals::ShellPairs>();
+  reorderedPairs->resize(basis_.size());
+#pragma omp parallel for schedule(dynamic) num_threads(Libint::getNumberOfThreads())
+  for (std::size_t n1 = 0; n1 < basis_.size(); ++n1) {
+    Utils::Integrals::ShellPair shellPair(basis_[n1], hasCauchySchwarzFactor);
+    shellPair.reserve(origins[n1].size());
+    for (auto const& origin : origins[n1]) {
+      const auto& pair = shellPairs[origin.first][origin.second];
+      const bool sameOrientation = newIndex[origin.first] == n1;
+      Utils::Integrals::ShellPairData reorderedPair;
+      reorderedPair.secondShellIndex = sameOrientation ? newIndex[pair.secondShellIndex] : newIndex[origin.first];
+      if (hasCauchySchwarzFactor) {
+        // (ab|ab) and (ba|ba) have the same elements.
+        reorderedPair.cauchySchwarzFactor = pair.cauchySchwarzFactor;
+      }
+      if (sameOrientation) {
+        reorderedPair.precomputedShellPair =
+            std::make_unique<Utils::Integrals::ShellPairType>(*pair.precomputedShellPair);
+      }
+      else {
+        // The primitive data depend on the order of the shells, they are rebuilt without evaluating any integral.
+        reorderedPair.precomputedShellPair = std::make_unique<Utils::Integrals::ShellPairType>(
+            basis_[n1], basis_[reorderedPair.secondShellIndex], ln_prec);
+      }
+      shellPair.emplace_back(std::move(reorderedPair));
+    }
+    std::sort(shellPair.begin(), shellPair.end(),
+              [](const Utils::Integrals::ShellPairData& first, const Utils::Integrals::ShellPairData& second) {
+                return first.secondShellIndex < second.secondShellIndex;
+              });
+    reorderedPairs->at(n1) = std::move(shellPair);
+  }
+  reorderedPairs->setCauchySchwarzFactor(hasCauchySchwarzFactor);
+  basis_.setShellPairs(reorderedPairs);
+}
+
+auto ShellReordering::toReordered(const Eigen::MatrixXd& matrix) const -> Eigen::MatrixXd {
+  return permute(matrix, functionOrder_);
+}
+
+auto ShellReordering::toReordered(const Utils::DensityMatrix& density) const -> Utils::DensityMatrix {
+  Utils::DensityMatrix reordered;
+  if (density.unrestricted()) {
+    reordered.setDensity(toReordered(density.alphaMatrix()), toReordered(density.betaMatrix()),
+                         density.numberElectrons(), density.numberElectronsInBetaMatrix());
+  }
+  else {
+    reordered.setDensity(toReordered(density.restrictedMatrix()), density.numberElectrons());
+  }
+  return reordered;
+}
+
+auto ShellReordering::toOriginal(const Eigen::MatrixXd& matrix) const -> Eigen::MatrixXd {
+  const auto n = static_cast<Eigen::Index>(functionOrder_.size());
+  Eigen::MatrixXd original(n, n);
+  for (Eigen::Index j = 0; j < n; ++j) {
+    for (Eigen::Index i = 0; i < n; ++i) {
+      original(functionOrder_[i], functionOrder_[j]) = matrix(i, j);
+    }
+  }
+  return original;
+}
+
+auto ShellReordering::toOriginal(const Utils::SpinAdaptedMatrix& matrix) const -> Utils::SpinAdaptedMatrix {
+  // Only the matrices that were filled are permuted, e.g. the beta matrix is empty for a single electron.
+  Utils::SpinAdaptedMatrix original;
+  if (matrix.restrictedMatrix().size() != 0) {
+    original.restrictedMatrix() = toOriginal(matrix.restrictedMatrix());
+  }
+  if (matrix.alphaMatrix().size() != 0) {
+    original.alphaMatrix() = toOriginal(matrix.alphaMatrix());
+  }
+  if (matrix.betaMatrix().size() != 0) {
+    original.betaMatrix() = toOriginal(matrix.betaMatrix());
+  }
+  return original;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_SHELLREORDERING_H
+#define INTEGRALEVALUATOR_SHELLREORDERING_H
+
+#include <Utils/DataStructures/BasisSet.h>
+#include <Eigen/Core>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace Scine {
+namespace Utils {
+class DensityMatrix;
+class SpinAdaptedMatrix;
+} // namespace Utils
+namespace Integrals {
+
+/**
+ * @class ShellReordering @file ShellReordering.h
+ * @brief A copy of a basis set with its shells sorted by angular momentum and, within one angular momentum, along a
+ *        space-filling curve through their centers.
+ *
+ * Consecutive shell quartets then mostly belong to the same angular-momentum class and to nearby centers, which keeps
+ * libint on the same code path and the density and Fock blocks touched by the digesters close in memory.
+ * Matrices are translated between the original and the internal basis-function order with toReordered() and
+ * toOriginal().
+ */
+class ShellReordering {
+ public:
+  /**
+   * @brief Builds the reordered basis. If `basis` has shell pairs, they are permuted along: the reordered basis has
+   * the same pairs, screening and Cauchy-Schwarz factors, and no integral is evaluated.
+   * @param ln_prec The precision of the primitive screening of the pairs whose shell order is swapped. It must be the
+   *                one the pairs of `basis` were built with, see BasisSetHandler::makePair().
+   */
+  explicit ShellReordering(const Utils::Integrals::BasisSet& basis,
+                           double ln_prec = std::log(std::numeric_limits<double>::epsilon() / 1e10));
+
+  //! The reordered basis.
+  auto getBasis() const -> const Utils::Integrals::BasisSet& {
+    return basis_;
+  }
+  //! Shell s of the reordered basis is shell shellOrder()[s] of the original basis.
+  auto shellOrder() const -> const std::vector<std::size_t>& {
+    return shellOrder_;
+  }
+  //! Basis function i of the reordered basis is function functionOrder()[i] of the original basis.
+  auto functionOrder() const -> const std::vector<Eigen::Index>& {
+    return functionOrder_;
+  }
+
+  /**
+   * @brief Permutes rows and columns of a matrix in the original basis-function order to the reordered one.
+   */
+  auto toReordered(const Eigen::MatrixXd& matrix) const -> Eigen::MatrixXd;
+  auto toReordered(const Utils::DensityMatrix& density) const -> Utils::DensityMatrix;
+  /**
+   * @brief Permutes rows and columns of a matrix in the reordered basis-function order back to the original one.
+   */
+  auto toOriginal(const Eigen::MatrixXd& matrix) const -> Eigen::MatrixXd;
+  auto toOriginal(const Utils::SpinAdaptedMatrix& matrix) const -> Utils::SpinAdaptedMatrix;
+
+ private:
+  void permuteShellPairs(const Utils::Integrals::BasisSet& basis, double ln_prec);
+
+  Utils::Integrals::BasisSet basis_;
+  std::vector<std::size_t> shellOrder_;
+  std::vector<Eigen::Index> functionOrder_;
+};
+
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_SHELLREORDERING_H
@@ -25,9 +25,10 @@ void COMSaverDigester<IntegralSymmetry::fourfold>::digestImpl(double integralVal
   auto& ptr_data = resultPtr_[index];
 
   double COM = 0;
-  for (auto const& derivKey : {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y, Utils::Integrals::DerivKey::z}) {
-    COM -= (1 / totalMass_) * vectorMomentumIntegrals_[0][{Utils::Integrals::Component::none, derivKey, 0}](i, j) *
-           vectorMomentumIntegrals_[0][{Utils::Integrals::Component::none, derivKey, 0}](k, l);
+  // The first three matrices are the x, y and z derivatives with respect to the bra center.
+  for (std::size_t derivKey = 0; derivKey < 3; ++derivKey) {
+    COM -= (1 / totalMass_) * vectorMomentumIntegrals_[0].matrix(derivKey)(i, j) *
+           vectorMomentumIntegrals_[0].matrix(derivKey)(k, l);
   }
   integralValue *= this->scaling_;
   // two-fold
@@ -63,9 +64,10 @@ void COMSaverDigester<IntegralSymmetry::twofold>::digestImpl(double integralValu
 
   double COM = 0;
 
-  for (auto const& derivKey : {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y, Utils::Integrals::DerivKey::z}) {
-    COM -= (1 / totalMass_) * vectorMomentumIntegrals_[0][{Utils::Integrals::Component::none, derivKey, 0}](i, j) *
-           vectorMomentumIntegrals_[1][{Utils::Integrals::Component::none, derivKey, 0}](k, l);
+  // The first three matrices are the x, y and z derivatives with respect to the bra center.
+  for (std::size_t derivKey = 0; derivKey < 3; ++derivKey) {
+    COM -= (1 / totalMass_) * vectorMomentumIntegrals_[0].matrix(derivKey)(i, j) *
+           vectorMomentumIntegrals_[1].matrix(derivKey)(k, l);
   }
   integralValue *= this->scaling_;
   // two-fold
@@ -81,10 +83,16 @@ void COMSaverDigester<IntegralSymmetry::twofold>::digestImpl(double integralValu
 }
 
 template<IntegralSymmetry symmetry>
-const IntegralEvaluatorMap& COMSaverDigester<symmetry>::getResultImpl() const {
+const IntegralTensor& COMSaverDigester<symmetry>::getResultImpl() const {
   return result_;
 }
 
+template<IntegralSymmetry symmetry>
+IntegralTensor COMSaverDigester<symmetry>::takeResultImpl() {
+  resultPtr_.clear();
+  return std::move(result_);
+}
+
 template<IntegralSymmetry symmetry>
 double COMSaverDigester<symmetry>::computeDegeneracyImpl(int shell1, int shell2, int shell3, int shell4) {
   UNUSED(shell1);
@@ -114,20 +122,16 @@ COMSaverDigester<symmetry>::COMSaverDigester(const Utils::Integrals::BasisSet& s
   if (specifier.typeVector.size() == 2) {
     this->scaling_ = specifier.typeVector[0].charge * specifier.typeVector[1].charge;
   }
-  for (int center = 0; center < this->numberOfCenters_; ++center) {
-    if (this->specifier_.derivOrder == 0) {
-      result_[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, center}] =
-          Eigen::MatrixXd::Zero(this->dim1_ * this->dim1_, this->dim2_ * this->dim2_);
-      resultPtr_.push_back(result_[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, center}].data());
-    }
-    else {
-      for (auto const& derivKey :
-           {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y, Utils::Integrals::DerivKey::z}) {
-        result_[{Utils::Integrals::Component::none, derivKey, center}] =
-            Eigen::MatrixXd::Zero(this->dim1_ * this->dim1_, this->dim2_ * this->dim2_);
-        resultPtr_.push_back(result_[{Utils::Integrals::Component::none, derivKey, center}].data());
-      }
-    }
+  std::vector<Utils::Integrals::DerivKey> derivKeys = {Utils::Integrals::DerivKey::value};
+  if (this->specifier_.derivOrder != 0) {
+    derivKeys = {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y, Utils::Integrals::DerivKey::z};
+  }
+  result_ = IntegralTensor({Utils::Integrals::Component::none}, this->numberOfCenters_, derivKeys,
+                                 this->dim1_ * this->dim1_, this->dim2_ * this->dim2_,
+                                 TensorPlacement::parallelFirstTouch);
+  // The digester index is center * numberOfDerivKeys + derivKey, i.e. the position in the result tensor.
+  for (std::size_t index = 0; index < result_.size(); ++index) {
+    resultPtr_.push_back(result_.data(index));
   }
 
   if (!specifier.totalMass.has_value()) {
@@ -28,16 +28,17 @@ class COMSaverDigester : public Digester<COMSaverDigester<symmetry>> {
 
   double computeDegeneracyImpl(int shell1, int shell2, int shell3, int shell4);
 
-  const IntegralEvaluatorMap& getResultImpl() const;
+  const IntegralTensor& getResultImpl() const;
+  IntegralTensor takeResultImpl();
   void initializeImpl(int numberThreads);
   void finalizeImpl();
 
  private:
-  IntegralEvaluatorMap result_;
+  IntegralTensor result_;
 
   std::vector<double*> resultPtr_;
 
-  std::vector<IntegralEvaluatorMap> vectorMomentumIntegrals_;
+  std::vector<IntegralTensor> vectorMomentumIntegrals_;
   double totalMass_;
 };
 
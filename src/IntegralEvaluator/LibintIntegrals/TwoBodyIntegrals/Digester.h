@@ -9,6 +9,7 @@
 
 #include <LibintIntegrals/TwoBodyIntegrals/SymmetryHelper.h>
 #include <Utils/DataStructures/IntegralSpecifier.h>
+#include <array>
 
 namespace Scine {
 namespace Utils {
@@ -19,6 +20,13 @@ class BasisSet;
 
 namespace Integrals {
 namespace TwoBody {
+/**
+ * @brief Number of integral buffers of a shell quartet: the values, or 4 centers times 3 coordinates.
+ */
+constexpr int numberOfTwoBodyResults(int derivOrder) {
+  return (derivOrder > 0) ? 4 * 3 : 1;
+}
+
 /**
  * @class TwoBodiesIntegralsDigester @file TwoBodiesIntegralsDigester
  * @brief CRTP functor representing a static interface for a digester.
@@ -35,58 +43,69 @@ class Digester {
    * @brief Function to be called in the usage of a digester.
    * Every digester needs to unpack the integral over shells in integral over basis functions. This is why this id done
    * by the TwoBodiesIntegralsDigester. What this function does:
-   * - It takes a mapped quartet integral shell as arguments. Depending on the derivative type, it looks up how many
-   * different integral types there are.
+   * - It takes the integral buffers of a shell quartet as arguments. Their number is fixed by the derivative order.
    * - It loops over the different integral derivative types (derivative of the first shell wrt its nuclear geometric
    * derivative,...) and unpacks the derivative types into the integral over basis functions.
    * - It forwards the integral over basis functions
    *
    * NB: The integrals are scaled by the degeneracy factor. Normally this implies eight-fold symmetry. In order to
    * bypass this default behaviour (i.e. AO2MO), hide the calculateDegeneracy() symbol in the derived class.
-   * @param buffer Eigen::MatrixXd containing the shell-quartet integrals. Each row is a different type of integral,
-   * i.e. row1 -> first derivative of the first shell with respect to a nuclear geometric coordinate, row2 -> first
-   * derivative of the second shell with respect to a nuclear geometric coordinate,...
+   * @tparam derivOrder The derivative order, 0 or 1.
+   * @param buffers The shell-quartet integrals, one buffer per integral type, i.e. buffer 1 -> first derivative of the
+   * first shell with respect to a nuclear geometric coordinate, buffer 2 -> first derivative of the second shell with
+   * respect to a nuclear geometric coordinate,...
    */
-  void operator()(const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>& buffer, int shell1, int shell2, int shell3, int shell4) {
-    double degeneracy = derived().computeDegeneracyImpl(shell1, shell2, shell3, shell4);
-
-    auto performLoop = [&](const int center = 0, const Utils::Integrals::DerivKey& key = Utils::Integrals::DerivKey::value) {
-      // Retrieve the correct result by combining center and deriv key
-      auto index = center * numRelevantDerivKeys_ + static_cast<int>(key);
-      const Eigen::VectorXd& vectorBuffer = buffer.row(index);
-
-      size_t bufferIndex = 0;
-
-      for (size_t functionInShell1 = 0; functionInShell1 < scineBasis1_[shell1].size(); ++functionInShell1) {
-        const size_t basisFunction1 = functionInShell1 + indexFirstBFInShell1_[shell1];
-        for (size_t functionInShell2 = 0; functionInShell2 < scineBasis1_[shell2].size(); ++functionInShell2) {
-          const size_t basisFunction2 = functionInShell2 + indexFirstBFInShell1_[shell2];
-          for (size_t functionInShell3 = 0; functionInShell3 < scineBasis2_[shell3].size(); ++functionInShell3) {
-            const size_t basisFunction3 = functionInShell3 + indexFirstBFInShell2_[shell3];
-            for (size_t functionInShell4 = 0; functionInShell4 < scineBasis2_[shell4].size(); ++functionInShell4) {
-              const size_t basisFunction4 = functionInShell4 + indexFirstBFInShell2_[shell4];
-
-              auto const integral = vectorBuffer(bufferIndex);
-              ++bufferIndex;
+  template<int derivOrder>
+  void digest(const std::array<const double*, numberOfTwoBodyResults(derivOrder)>& buffers, int shell1, int shell2,
+              int shell3, int shell4) {
+    static_assert(derivOrder == 0 || derivOrder == 1, "Only values and first derivatives are available.");
+    const double degeneracy = derived().computeDegeneracyImpl(shell1, shell2, shell3, shell4);
+    const auto size1 = scineBasis1_[shell1].size();
+    const auto size2 = scineBasis1_[shell2].size();
+    const auto size3 = scineBasis2_[shell3].size();
+    const auto size4 = scineBasis2_[shell4].size();
+    const auto firstBasisFunction1 = indexFirstBFInShell1_[shell1];
+    const auto firstBasisFunction2 = indexFirstBFInShell1_[shell2];
+    const auto firstBasisFunction3 = indexFirstBFInShell2_[shell3];
+    const auto firstBasisFunction4 = indexFirstBFInShell2_[shell4];
+
+    // The buffer index is center * numRelevantDerivKeys_ + derivKey, i.e. the position in the result.
+    for (int index = 0; index < numberOfTwoBodyResults(derivOrder); ++index) {
+      const double* integrals = buffers[index];
+      for (size_t functionInShell1 = 0; functionInShell1 < size1; ++functionInShell1) {
+        const size_t basisFunction1 = functionInShell1 + firstBasisFunction1;
+        for (size_t functionInShell2 = 0; functionInShell2 < size2; ++functionInShell2) {
+          const size_t basisFunction2 = functionInShell2 + firstBasisFunction2;
+          for (size_t functionInShell3 = 0; functionInShell3 < size3; ++functionInShell3) {
+            const size_t basisFunction3 = functionInShell3 + firstBasisFunction3;
+            for (size_t functionInShell4 = 0; functionInShell4 < size4; ++functionInShell4) {
+              auto const integral = *integrals++;
               if (integral != 0.0) {
-                derived().digestImpl(integral, basisFunction1, basisFunction2, basisFunction3, basisFunction4, index, degeneracy);
+                derived().digestImpl(integral, basisFunction1, basisFunction2, basisFunction3,
+                                     functionInShell4 + firstBasisFunction4, index, degeneracy);
               }
             }
           }
         }
       }
-    };
+    }
+  }
+
+  /**
+   * @brief Runtime variant of digest(), taking the shell-quartet integrals as rows of a matrix.
+   * @param buffer Eigen::MatrixXd containing the shell-quartet integrals. Each row is a different type of integral.
+   */
+  void operator()(const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>& buffer, int shell1, int shell2, int shell3, int shell4) {
     if (specifier_.derivOrder == 0) {
-      performLoop();
+      digest<0>({buffer.row(0).data()}, shell1, shell2, shell3, shell4);
     }
     // If derivative, calculate derivative
     else if (specifier_.derivOrder == 1) {
-      for (int center = 0; center < numberOfCenters_; ++center) {
-        for (auto const& derivKey :
-             {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y, Utils::Integrals::DerivKey::z}) {
-          performLoop(center, derivKey);
-        }
+      std::array<const double*, numberOfTwoBodyResults(1)> buffers{};
+      for (int index = 0; index < numberOfTwoBodyResults(1); ++index) {
+        buffers[index] = buffer.row(index).data();
       }
+      digest<1>(buffers, shell1, shell2, shell3, shell4);
     }
     assert(specifier_.derivOrder < 2);
   }
@@ -122,6 +141,13 @@ class Digester {
   const auto& getResult() const {
     return derived().getResultImpl();
   }
+  /**
+   * @brief Moves the result out of the digester instead of copying it, e.g. a stored two-body tensor. The digester
+   * holds no valid result afterwards.
+   */
+  auto takeResult() {
+    return derived().takeResultImpl();
+  }
 
   /**
    * @brief initializer for the digester. Needed for instance to initialize local matrices for parallelization.
@@ -9,8 +9,16 @@
 #define INTEGRALEVALUATOR_EVALUATOR_H
 
 #include <LibintIntegrals/BasisSetHandler.h>
+#include <LibintIntegrals/TwoBodyIntegrals/Digester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/LibintBasis.h>
+#include <LibintIntegrals/TwoBodyIntegrals/QuartetScheduler.h>
 #include <LibintIntegrals/TwoBodyIntegrals/VoidPrescreener.h>
+#include <omp.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <memory>
+#include <stdexcept>
 
 namespace Scine {
 namespace Integrals {
@@ -28,142 +36,198 @@ class Evaluator {
   const auto& getResult() const {
     return digester_.getResult();
   }
+  /**
+   * @brief Moves the result out of the digester, see Digester::takeResult().
+   */
+  auto takeResult() {
+    return digester_.takeResult();
+  }
+
+  /**
+   * @brief Sets how the shell quartets are distributed among the threads, by default SchedulingPolicy::costBalanced.
+   */
+  void setSchedulingPolicy(SchedulingPolicy policy) {
+    schedulingPolicy_ = policy;
+  }
+
+  /**
+   * @brief Sets the number of threads requested for the evaluation, by default 0, i.e. Libint::getNumberOfThreads().
+   * @throws std::invalid_argument if the number is negative.
+   */
+  void setNumberOfThreads(int numberThreads) {
+    if (numberThreads < 0) {
+      throw std::invalid_argument("The number of threads must not be negative.");
+    }
+    numberThreads_ = numberThreads;
+  }
+
+  /**
+   * @brief Uses libint conversions of both bases shared with other evaluations instead of converting the bases at
+   * every call to evaluateTwoBodyIntegrals().
+   * @throws std::invalid_argument if they are not the conversions of the current shell pairs of the bases.
+   */
+  void setLibintBases(std::shared_ptr<const LibintBasis> libintBasis1,
+                      std::shared_ptr<const LibintBasis> libintBasis2) {
+    if (!libintBasis1 || !libintBasis2 || !libintBasis1->isConversionOf(scineBasis1_) ||
+        !libintBasis2->isConversionOf(scineBasis2_)) {
+      throw std::invalid_argument("The libint bases do not belong to the shell pairs of the evaluator's bases.");
+    }
+    libintBasis1_ = std::move(libintBasis1);
+    libintBasis2_ = std::move(libintBasis2);
+  }
 
+  /**
+   * @brief The per-thread busy times of the last call to evaluateTwoBodyIntegrals().
+   */
+  const SchedulingStatistics& getSchedulingStatistics() const {
+    return statistics_;
+  }
+
+  /**
+   * @brief Evaluates all significant shell quartets and hands them to the digester.
+   * The derivative order of the specifier is dispatched once; the quartet traversal is instantiated for it.
+   */
   template<libint2::Operator op>
   void evaluateTwoBodyIntegrals() {
+    if (specifier_.derivOrder == 0) {
+      traverseQuartets<op, 0>();
+    }
+    else if (specifier_.derivOrder == 1) {
+      traverseQuartets<op, 1>();
+    }
+    else {
+      throw std::runtime_error("Only values and first derivatives of two-body integrals are available.");
+    }
+  }
+
+ private:
+  template<libint2::Operator op, int derivOrder>
+  void traverseQuartets() {
     std::shared_ptr<Utils::Integrals::ShellPairs> shellPairs1 = scineBasis1_.getShellPairs();
     std::shared_ptr<Utils::Integrals::ShellPairs> shellPairs2 = scineBasis2_.getShellPairs();
 
     Libint::getInstance();
-    digester_.initialize(Libint::getMaxNumberThreads());
+    const int requestedThreads = (numberThreads_ > 0) ? numberThreads_ : Libint::getNumberOfThreads();
+    std::unique_ptr<QuartetScheduler> scheduler;
 
-    // 4 centers times 3 coordinates
-    auto const numberOfResults = (specifier_.derivOrder > 0) ? 4 * 3 : 1;
+    constexpr int numberOfResults = numberOfTwoBodyResults(derivOrder);
+    const bool isSymmetric = scineBasis1_ == scineBasis2_;
 
-#pragma omp parallel
+    // The libint shells and shell pairs are converted once and shared read-only by all threads.
+    auto libintBasis1 = libintBasis1_ ? libintBasis1_ : std::make_shared<const LibintBasis>(scineBasis1_);
+    auto libintBasis2 = libintBasis2_;
+    if (!libintBasis2) {
+      libintBasis2 =
+          (&scineBasis1_ == &scineBasis2_) ? libintBasis1 : std::make_shared<const LibintBasis>(scineBasis2_);
+    }
+
+#pragma omp parallel num_threads(requestedThreads)
     {
-      auto localEngine = Libint::getEngine(scineBasis1_, scineBasis2_, op, specifier_.derivOrder);
-      auto const& buffer = localEngine.results();
-
-      // make libint basis:
-      std::vector<libint2::Shell> libintShellVector1;
-      libintShellVector1.reserve(scineBasis1_.size());
-      for (auto const& shell : scineBasis1_) {
-        libintShellVector1.push_back(BasisSetHandler::scineToLibint(shell));
-      }
-      std::vector<std::vector<libint2::ShellPair>> libintPreComputShellPairVector1;
-      libintPreComputShellPairVector1.reserve(shellPairs1->size());
-      std::vector<libint2::Shell> libintShellPairVector1;
-      libintShellPairVector1.reserve(shellPairs1->size());
-      for (auto s = 0; s < shellPairs1->size(); ++s) {
-        libintShellPairVector1.push_back(BasisSetHandler::scineToLibint(shellPairs1->at(s).getShell()));
-        std::vector<libint2::ShellPair> tmp;
-        tmp.reserve(shellPairs1->size());
-        for (const Utils::Integrals::ShellPairData& shellPair : shellPairs1->at(s)) {
-          tmp.push_back(BasisSetHandler::scineToLibint(*shellPair.precomputedShellPair));
-        }
-        libintPreComputShellPairVector1.push_back(tmp);
-      }
-      std::vector<libint2::Shell> libintShellVector2;
-      libintShellVector2.reserve(scineBasis2_.size());
-      for (auto const& shell : scineBasis2_) {
-        libintShellVector2.push_back(BasisSetHandler::scineToLibint(shell));
-      }
-      std::vector<std::vector<libint2::ShellPair>> libintPreComputShellPairVector2;
-      libintPreComputShellPairVector2.reserve(shellPairs2->size());
-      std::vector<libint2::Shell> libintShellPairVector2;
-      libintShellPairVector2.reserve(shellPairs2->size());
-      for (auto s = 0; s < shellPairs2->size(); ++s) {
-        libintShellPairVector2.push_back(BasisSetHandler::scineToLibint(shellPairs2->at(s).getShell()));
-        std::vector<libint2::ShellPair> tmp;
-        tmp.reserve(shellPairs2->size());
-        for (const Utils::Integrals::ShellPairData& shellPair : shellPairs2->at(s)) {
-          tmp.push_back(BasisSetHandler::scineToLibint(*shellPair.precomputedShellPair));
-        }
-        libintPreComputShellPairVector2.push_back(tmp);
+      // The per-thread data is sized from the team actually granted, which may be smaller than requested, e.g. for
+      // nested parallel regions. The implicit barrier of the single construct publishes it to all threads.
+#pragma omp single
+      {
+        const int teamSize = omp_get_num_threads();
+        digester_.initialize(teamSize);
+        scheduler = std::make_unique<QuartetScheduler>(scineBasis1_, scineBasis2_, schedulingPolicy_, teamSize);
       }
 
-#pragma omp for schedule(dynamic)
-      for (auto s1 = 0UL; s1 < scineBasis1_.size(); ++s1) {
-        const auto shell1Size = scineBasis1_[s1].size();
-        auto const& pairsOfShell1 = shellPairs1->at(s1);
-
-        for (auto sp12 = 0; sp12 < pairsOfShell1.size(); ++sp12) {
-          auto const& shellPair12 = pairsOfShell1[sp12];
-          const auto shell2Size = scineBasis1_.at(shellPair12.secondShellIndex).size();
-          auto s3_max = (scineBasis1_ == scineBasis2_) ? s1 : scineBasis2_.size() - 1;
-          // Account for two-fold symmetry.
-          for (auto s3 = 0UL; s3 <= s3_max; ++s3) {
-            const auto shell3Size = scineBasis2_[s3].size();
-            auto const& pairsOfShell3 = shellPairs2->at(s3);
-
-            int sp34_max;
-            if (scineBasis1_ != scineBasis2_) {
-              sp34_max = pairsOfShell3.size() - 1;
+      auto localEngine = Libint::leaseEngine(scineBasis1_, scineBasis2_, op, derivOrder);
+      std::array<const double*, numberOfResults> results{};
+      auto const& buffer = localEngine->results();
+
+      const auto& libintShellVector1 = libintBasis1->shells;
+      const auto& libintPreComputShellPairVector1 = libintBasis1->shellPairs;
+      const auto& libintShellVector2 = libintBasis2->shells;
+      const auto& libintPreComputShellPairVector2 = libintBasis2->shellPairs;
+
+      // All ket pairs combined with the bra pair sp12 of shell s1.
+      // The shell pairs of both bases only contain s2 <= s1, so every shell quartet visited is canonical within bra and
+      // ket; the digesters restore the permutations through the degeneracy of the quartet. For identical bases, the
+      // bra-ket permutation is removed in addition.
+      auto evaluateBraPair = [&](std::size_t s1, std::size_t sp12) {
+        auto const& shellPair12 = shellPairs1->at(s1)[sp12];
+        auto s3_max = isSymmetric ? s1 : scineBasis2_.size() - 1;
+        // Account for two-fold symmetry.
+        for (auto s3 = 0UL; s3 <= s3_max; ++s3) {
+          auto const& pairsOfShell3 = shellPairs2->at(s3);
+
+          int sp34_max;
+          if (!isSymmetric) {
+            sp34_max = pairsOfShell3.size() - 1;
+          }
+          else {
+            // TODO -> account for 4-fold symmetric of integrals. This assumes that at least to some degree there is
+            // an 8-fold symmetry
+            //         i.e. even though the COM integrals are 4-fold symmetric, still only the 8-fold symmetric
+            //         integrals are required.
+            // The reason for this is that the shell pairs are screened. Hence, some can be discarded which
+            // must be taken into account.
+            if (int(s3) < pairsOfShell3.size()) {
+              sp34_max = (s1 == s3) ? sp12 : s3;
             }
             else {
-              // TODO -> account for 4-fold symmetric of integrals. This assumes that at least to some degree there is
-              // an 8-fold symmetry
-              //         i.e. even though the COM integrals are 4-fold symmetric, still only the 8-fold symmetric
-              //         integrals are required.
-              // The reason for this is that the shell pairs are screened. Hence, some can be discarded which
-              // must be taken into account.
-              if (int(s3) < pairsOfShell3.size()) {
-                sp34_max = (s1 == s3) ? sp12 : s3;
-              }
-              else {
-                sp34_max = (s1 == s3) ? sp12 : pairsOfShell3.size() - 1;
-              }
+              sp34_max = (s1 == s3) ? sp12 : pairsOfShell3.size() - 1;
+            }
+          }
+          for (auto sp34 = 0; sp34 <= sp34_max; ++sp34) {
+            auto const& shellPair34 = pairsOfShell3[sp34];
+            bool isSignificant = prescreener_(s1, shellPair12.secondShellIndex, s3, shellPair34.secondShellIndex,
+                                              shellPair12.cauchySchwarzFactor * shellPair34.cauchySchwarzFactor);
+
+            if (!isSignificant) {
+              continue;
             }
-            for (auto sp34 = 0; sp34 <= sp34_max; ++sp34) {
-              auto const& shellPair34 = pairsOfShell3[sp34];
-              const auto shell4Size = scineBasis2_[shellPair34.secondShellIndex].size();
-              bool isSignificant = prescreener_(s1, shellPair12.secondShellIndex, s3, shellPair34.secondShellIndex,
-                                                shellPair12.cauchySchwarzFactor * shellPair34.cauchySchwarzFactor);
-
-              if (!isSignificant) {
-                continue;
-              }
-              auto& shell1 = libintShellVector1[shellPair12.secondShellIndex];
-              const auto* ptrlibintShellPair12 = &libintPreComputShellPairVector1[s1][sp12];
-              const auto* ptrlibintShellPair34 = &libintPreComputShellPairVector2[s3][sp34];
-              auto& shell3 = libintShellVector2[shellPair34.secondShellIndex];
-              if (this->specifier_.derivOrder == 0) {
-                localEngine.template compute2<op, libint2::BraKet::xx_xx, static_cast<std::size_t>(0)>(
-                    libintShellPairVector1.at(s1), shell1, libintShellPairVector2.at(s3), shell3, ptrlibintShellPair12,
-                    ptrlibintShellPair34);
-              }
-              else if (this->specifier_.derivOrder == 1) {
-                localEngine.template compute2<op, libint2::BraKet::xx_xx, static_cast<std::size_t>(1)>(
-                    libintShellPairVector1.at(s1), shell1, libintShellPairVector2.at(s3), shell3, ptrlibintShellPair12,
-                    ptrlibintShellPair34);
-              }
-              /* Everything is screened out */
-              if (buffer[0] == nullptr) {
-                continue;
-              }
-
-              Eigen::Matrix<double, -1, -1, Eigen::RowMajor> bufferMatrix(numberOfResults, shell1Size * shell2Size *
-                                                                                               shell3Size * shell4Size);
-              for (int res = 0; res < numberOfResults; ++res) {
-                bufferMatrix.row(res) =
-                    Eigen::Map<const Eigen::RowVectorXd>(buffer[res], shell1Size * shell2Size * shell3Size * shell4Size);
-              }
-              digester_(bufferMatrix, s1, shellPair12.secondShellIndex, s3, shellPair34.secondShellIndex);
+            auto& shell1 = libintShellVector1[shellPair12.secondShellIndex];
+            const auto* ptrlibintShellPair12 = &libintPreComputShellPairVector1[s1][sp12];
+            const auto* ptrlibintShellPair34 = &libintPreComputShellPairVector2[s3][sp34];
+            auto& shell3 = libintShellVector2[shellPair34.secondShellIndex];
+            localEngine->template compute2<op, libint2::BraKet::xx_xx, static_cast<std::size_t>(derivOrder)>(
+                libintShellVector1[s1], shell1, libintShellVector2[s3], shell3, ptrlibintShellPair12,
+                ptrlibintShellPair34);
+            /* Everything is screened out */
+            if (buffer[0] == nullptr) {
+              continue;
             }
+
+            // The engine's buffers are handed to the digester directly, no copy is made.
+            std::copy_n(buffer.begin(), numberOfResults, results.begin());
+            digester_.template digest<derivOrder>(results, s1, shellPair12.secondShellIndex, s3,
+                                                  shellPair34.secondShellIndex);
           }
         }
+      };
+
+      const auto thread = omp_get_thread_num();
+      const auto& braPairs = scheduler->braPairs();
+      QuartetScheduler::Task task{};
+      std::size_t numberOfTasks = 0;
+      std::chrono::duration<double> busyTime(0.0);
+      while (scheduler->nextTask(thread, task)) {
+        const auto start = std::chrono::steady_clock::now();
+        for (auto p = task.firstBraPair; p < task.lastBraPair; ++p) {
+          evaluateBraPair(braPairs[p].first, braPairs[p].second);
+        }
+        busyTime += std::chrono::steady_clock::now() - start;
+        ++numberOfTasks;
       }
+      scheduler->recordBusyTime(thread, busyTime.count(), numberOfTasks);
     }
+    statistics_ = scheduler->getStatistics();
     digester_.finalize();
   }
 
- private:
   const Utils::Integrals::BasisSet& scineBasis1_;
   const Utils::Integrals::BasisSet& scineBasis2_;
   const Utils::Integrals::IntegralSpecifier& specifier_;
   DigesterType digester_;
   PrescreenerType prescreener_;
+  SchedulingPolicy schedulingPolicy_ = SchedulingPolicy::costBalanced;
+  int numberThreads_ = 0;
+  SchedulingStatistics statistics_;
+  /* Shared libint conversions of the bases, converted per evaluation if null */
+  std::shared_ptr<const LibintBasis> libintBasis1_;
+  std::shared_ptr<const LibintBasis> libintBasis2_;
 };
 
 template<typename DigesterType, typename PrescreenerType>
@@ -0,0 +1,55 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#include <LibintIntegrals/OneBodyIntegrals.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/CenterOfMassCorrection.h>
+
+using namespace Scine;
+using namespace Integrals;
+using namespace TwoBody;
+
+namespace {
+// The first three matrices are the x, y and z derivatives with respect to the bra center.
+auto momentumMatrices(const Utils::Integrals::BasisSet& basis) -> std::array<Eigen::MatrixXd, 3> {
+  Utils::Integrals::IntegralSpecifier momentumSpecifier;
+  momentumSpecifier.op = Utils::Integrals::Operator::Overlap;
+  momentumSpecifier.derivOrder = 1;
+
+  auto oneBodyInts = OneBodyIntegrals(basis, basis, momentumSpecifier);
+  oneBodyInts.compute();
+  const auto integrals = oneBodyInts.getResult();
+  return {integrals.matrix(0), integrals.matrix(1), integrals.matrix(2)};
+}
+} // namespace
+
+CenterOfMassCorrection::CenterOfMassCorrection(const Utils::Integrals::BasisSet& basis1,
+                                               const Utils::Integrals::BasisSet& basis2,
+                                               const Utils::Integrals::IntegralSpecifier& specifier) {
+  if (!specifier.totalMass.has_value()) {
+    throw std::runtime_error("No total Mass given in integral specifier.");
+  }
+  inverseTotalMass_ = 1.0 / specifier.totalMass.get();
+  momentum1_ = momentumMatrices(basis1);
+  momentum2_ = (basis1 == basis2) ? momentum1_ : momentumMatrices(basis2);
+}
+
+void CenterOfMassCorrection::addToCoulomb1(Eigen::MatrixXd& coulomb1, const Eigen::MatrixXd& density2) const {
+  for (int d = 0; d < 3; ++d) {
+    coulomb1 += inverseTotalMass_ * momentum2_[d].cwiseProduct(density2).sum() * momentum1_[d];
+  }
+}
+
+void CenterOfMassCorrection::addToCoulomb2(Eigen::MatrixXd& coulomb2, const Eigen::MatrixXd& density1) const {
+  for (int d = 0; d < 3; ++d) {
+    coulomb2 += inverseTotalMass_ * momentum1_[d].cwiseProduct(density1).sum() * momentum2_[d];
+  }
+}
+
+void CenterOfMassCorrection::addToExchange(Eigen::MatrixXd& exchange, const Eigen::MatrixXd& density) const {
+  for (int d = 0; d < 3; ++d) {
+    exchange.noalias() += inverseTotalMass_ * momentum1_[d] * density * momentum1_[d].transpose();
+  }
+}
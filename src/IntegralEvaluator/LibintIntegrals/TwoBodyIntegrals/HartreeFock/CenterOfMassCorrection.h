@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef INTEGRALEVALUATOR_CENTEROFMASSCORRECTION_H
+#define INTEGRALEVALUATOR_CENTEROFMASSCORRECTION_H
+
+#include <Utils/DataStructures/BasisSet.h>
+#include <Utils/DataStructures/IntegralSpecifier.h>
+#include <Eigen/Core>
+#include <array>
+
+namespace Scine {
+namespace Integrals {
+namespace TwoBody {
+
+/**
+ * @class CenterOfMassCorrection @file CenterOfMassCorrection.h
+ * @brief The separable center-of-mass term of the Operator::CoulombCOM integrals, contracted with densities.
+ *
+ * The CoulombCOM integrals are (see COMSaverDigester)
+ * \f$ q_1 q_2 (ij|kl) + \frac{1}{M} \sum_{d} P^d_{ij} Q^d_{kl} \f$,
+ * where \f$ P^d \f$ and \f$ Q^d \f$ are the overlap derivatives with respect to the bra center of the first and second
+ * basis and M is the total mass. Their contraction with a density therefore reduces to products of these
+ * antisymmetric matrices, which is how the direct digesters apply the term after the Coulomb part.
+ */
+class CenterOfMassCorrection {
+ public:
+  /**
+   * @brief Evaluates the overlap derivatives of both bases.
+   * @throws std::runtime_error if the specifier contains no total mass.
+   */
+  CenterOfMassCorrection(const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
+                         const Utils::Integrals::IntegralSpecifier& specifier);
+
+  /**
+   * @brief Adds \f$ \frac{1}{M} \sum_d P^d \langle Q^d, D_2 \rangle \f$, the term of the Coulomb matrix of the first
+   * basis. It vanishes for symmetric densities.
+   */
+  void addToCoulomb1(Eigen::MatrixXd& coulomb1, const Eigen::MatrixXd& density2) const;
+  /**
+   * @brief Adds \f$ \frac{1}{M} \sum_d Q^d \langle P^d, D_1 \rangle \f$, the term of the Coulomb matrix of the
+   * second basis.
+   */
+  void addToCoulomb2(Eigen::MatrixXd& coulomb2, const Eigen::MatrixXd& density1) const;
+  /**
+   * @brief Adds \f$ \frac{1}{M} \sum_d P^d D (P^d)^T \f$, the term of the exchange matrix. Identical bases only.
+   */
+  void addToExchange(Eigen::MatrixXd& exchange, const Eigen::MatrixXd& density) const;
+
+ private:
+  std::array<Eigen::MatrixXd, 3> momentum1_;
+  std::array<Eigen::MatrixXd, 3> momentum2_;
+  double inverseTotalMass_;
+};
+
+} // namespace TwoBody
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_CENTEROFMASSCORRECTION_H
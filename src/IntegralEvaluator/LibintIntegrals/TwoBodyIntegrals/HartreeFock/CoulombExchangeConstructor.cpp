@@ -11,24 +11,29 @@ namespace Scine {
 namespace Integrals {
 namespace TwoBody {
 
-CoulombExchangeConstructor::CoulombExchangeConstructor(const Utils::DensityMatrix& densityMatrix)
-  : densityMatrix_(densityMatrix), dim_(densityMatrix_.restrictedMatrix().rows()) {
-  if (densityMatrix_.restricted()) {
-    exchange_.restrictedMatrix().resizeLike(densityMatrix_.restrictedMatrix());
+CoulombExchangeConstructor::CoulombExchangeConstructor(const Utils::DensityMatrix& densityMatrix) {
+  reset(densityMatrix);
+}
+
+void CoulombExchangeConstructor::reset(const Utils::DensityMatrix& densityMatrix) {
+  densityMatrix_ = &densityMatrix;
+  dim_ = densityMatrix_->restrictedMatrix().rows();
+  if (densityMatrix_->restricted()) {
+    exchange_.restrictedMatrix().resizeLike(densityMatrix_->restrictedMatrix());
     exchange_.restrictedMatrix().setZero();
-    coulomb_.restrictedMatrix().resizeLike(densityMatrix_.restrictedMatrix());
+    coulomb_.restrictedMatrix().resizeLike(densityMatrix_->restrictedMatrix());
     coulomb_.restrictedMatrix().setZero();
   }
   else {
-    exchange_.alphaMatrix().resizeLike(densityMatrix_.alphaMatrix());
+    exchange_.alphaMatrix().resizeLike(densityMatrix_->alphaMatrix());
     exchange_.alphaMatrix().setZero();
-    coulomb_.alphaMatrix().resizeLike(densityMatrix_.alphaMatrix());
+    coulomb_.alphaMatrix().resizeLike(densityMatrix_->alphaMatrix());
     coulomb_.alphaMatrix().setZero();
     // This relies on the density matrix being built properly.
-    if (densityMatrix_.numberElectronsInBetaMatrix() > 0) {
-      exchange_.betaMatrix().resizeLike(densityMatrix_.betaMatrix());
+    if (densityMatrix_->numberElectronsInBetaMatrix() > 0) {
+      exchange_.betaMatrix().resizeLike(densityMatrix_->betaMatrix());
       exchange_.betaMatrix().setZero();
-      coulomb_.betaMatrix().resizeLike(densityMatrix_.betaMatrix());
+      coulomb_.betaMatrix().resizeLike(densityMatrix_->betaMatrix());
       coulomb_.betaMatrix().setZero();
     }
   }
@@ -43,10 +48,10 @@ void CoulombExchangeConstructor::evaluateBasisFunctionQuartet(double integralVal
   auto b3dim = basisFunction3 * dim_;
   // auto b4dim=basisFunction4*dim_;
 
-  if (densityMatrix_.restricted()) {
+  if (densityMatrix_->restricted()) {
     auto* J = coulomb_.restrictedMatrix().data();
     auto* K = exchange_.restrictedMatrix().data();
-    const auto* dm = densityMatrix_.restrictedMatrix().data();
+    const auto* dm = densityMatrix_->restrictedMatrix().data();
 
     J[b1dim + basisFunction2] += dm[b3dim + basisFunction4] * integralValue_05;
     J[b3dim + basisFunction4] += dm[b1dim + basisFunction2] * integralValue_05;
@@ -58,7 +63,7 @@ void CoulombExchangeConstructor::evaluateBasisFunctionQuartet(double integralVal
   else {
     auto* J_alpha = coulomb_.alphaMatrix().data();
     auto* K_alpha = exchange_.alphaMatrix().data();
-    const auto* dm_alpha = densityMatrix_.alphaMatrix().data();
+    const auto* dm_alpha = densityMatrix_->alphaMatrix().data();
 
     J_alpha[b1dim + basisFunction2] += dm_alpha[b3dim + basisFunction4] * integralValue_05;
     J_alpha[b3dim + basisFunction4] += dm_alpha[b1dim + basisFunction2] * integralValue_05;
@@ -67,10 +72,10 @@ void CoulombExchangeConstructor::evaluateBasisFunctionQuartet(double integralVal
     K_alpha[b1dim + basisFunction4] += dm_alpha[b2dim + basisFunction3] * integralValue_025;
     K_alpha[b2dim + basisFunction3] += dm_alpha[b1dim + basisFunction4] * integralValue_025;
 
-    if (densityMatrix_.numberElectronsInBetaMatrix() > 0) {
+    if (densityMatrix_->numberElectronsInBetaMatrix() > 0) {
       auto* J_beta = coulomb_.betaMatrix().data();
       auto* K_beta = exchange_.betaMatrix().data();
-      const auto* dm_beta = densityMatrix_.betaMatrix().data();
+      const auto* dm_beta = densityMatrix_->betaMatrix().data();
 
       J_beta[b1dim + basisFunction2] += dm_beta[b3dim + basisFunction4] * integralValue_05;
       J_beta[b3dim + basisFunction4] += dm_beta[b1dim + basisFunction2] * integralValue_05;
@@ -83,13 +88,13 @@ void CoulombExchangeConstructor::evaluateBasisFunctionQuartet(double integralVal
 }
 
 void CoulombExchangeConstructor::finalizeEvaluation() {
-  if (!densityMatrix_.restricted()) {
+  if (!densityMatrix_->restricted()) {
     auto& J_alpha = coulomb_.alphaMatrix();
     auto& K_alpha = exchange_.alphaMatrix();
     J_alpha = 0.5 * (J_alpha + J_alpha.transpose()).eval();
     K_alpha = 0.5 * (K_alpha + K_alpha.transpose()).eval();
 
-    if (densityMatrix_.numberElectronsInBetaMatrix() > 0) {
+    if (densityMatrix_->numberElectronsInBetaMatrix() > 0) {
       auto& J_beta = coulomb_.betaMatrix();
       auto& K_beta = exchange_.betaMatrix();
       J_beta = 0.5 * (J_beta + J_beta.transpose()).eval();
@@ -28,6 +28,12 @@ class CoulombExchangeConstructor {
  public:
   explicit CoulombExchangeConstructor(const Utils::DensityMatrix& densityMatrix);
 
+  /**
+   * @brief Prepares a new evaluation with another density. The matrices are zeroed and only reallocated if the
+   * dimensions change, such that the constructor can be reused across SCF iterations.
+   */
+  void reset(const Utils::DensityMatrix& densityMatrix);
+
   /**
    * @brief Evaluates 6 matrix elements from a basis function quartet.
    */
@@ -51,7 +57,7 @@ class CoulombExchangeConstructor {
  private:
   Utils::SpinAdaptedMatrix coulomb_;
   Utils::SpinAdaptedMatrix exchange_;
-  const Utils::DensityMatrix& densityMatrix_;
+  const Utils::DensityMatrix* densityMatrix_;
   unsigned long dim_;
 };
 
@@ -25,11 +25,23 @@ void CoulombExchangeDigester::digestImpl(double integralValue, int i, int j, int
 
   const auto threadNr = omp_get_thread_num();
 
-  constructor_[threadNr].evaluateBasisFunctionQuartet(integralValue * this->scaling_ * degeneracy, i, j, k, l);
+  (*constructors_)[threadNr].evaluateBasisFunctionQuartet(integralValue * this->scaling_ * degeneracy, i, j, k, l);
 }
 
 const std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& CoulombExchangeDigester::getResultImpl() const {
-  return coulomb_exchange_;
+  return result();
+}
+
+std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix> CoulombExchangeDigester::takeResultImpl() {
+  return std::move(result());
+}
+
+std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& CoulombExchangeDigester::result() {
+  return (externalResult_ != nullptr) ? *externalResult_ : coulomb_exchange_;
+}
+
+const std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& CoulombExchangeDigester::result() const {
+  return (externalResult_ != nullptr) ? *externalResult_ : coulomb_exchange_;
 }
 
 double CoulombExchangeDigester::computeDegeneracyImpl(int shell1, int shell2, int shell3, int shell4) {
@@ -40,27 +52,52 @@ double CoulombExchangeDigester::computeDegeneracyImpl(int shell1, int shell2, in
 }
 
 void CoulombExchangeDigester::initializeImpl(int numberThreads) {
-  constructor_ = std::vector<CoulombExchangeConstructor>(numberThreads, CoulombExchangeConstructor(densityMatrix_));
+  constructors_ = (externalConstructors_ != nullptr) ? externalConstructors_ : &constructor_;
+  // Constructors kept from a previous evaluation are zeroed instead of being reallocated.
+  if (constructors_->size() == static_cast<std::size_t>(numberThreads)) {
+    for (auto& elem : *constructors_) {
+      elem.reset(densityMatrix_);
+    }
+  }
+  else {
+    *constructors_ = std::vector<CoulombExchangeConstructor>(numberThreads, CoulombExchangeConstructor(densityMatrix_));
+  }
 }
 
 void CoulombExchangeDigester::finalizeImpl() {
-  for (auto& elem : constructor_) {
+  auto& coulombExchange = result();
+  for (auto& elem : *constructors_) {
     elem.finalizeEvaluation();
   }
 
   if (densityMatrix_.restricted()) {
-    for (auto& elem : constructor_) {
-      coulomb_exchange_.first.restrictedMatrix() += elem.getCoulombMatrix().restrictedMatrix();
-      coulomb_exchange_.second.restrictedMatrix() += elem.getExchangeMatrix().restrictedMatrix();
+    for (auto& elem : *constructors_) {
+      coulombExchange.first.restrictedMatrix() += elem.getCoulombMatrix().restrictedMatrix();
+      coulombExchange.second.restrictedMatrix() += elem.getExchangeMatrix().restrictedMatrix();
     }
   }
   else {
-    for (auto& elem : constructor_) {
-      coulomb_exchange_.first.alphaMatrix() += elem.getCoulombMatrix().alphaMatrix();
-      coulomb_exchange_.second.alphaMatrix() += elem.getExchangeMatrix().alphaMatrix();
+    for (auto& elem : *constructors_) {
+      coulombExchange.first.alphaMatrix() += elem.getCoulombMatrix().alphaMatrix();
+      coulombExchange.second.alphaMatrix() += elem.getExchangeMatrix().alphaMatrix();
       if (densityMatrix_.numberElectronsInBetaMatrix() > 0) {
-        coulomb_exchange_.first.betaMatrix() += elem.getCoulombMatrix().betaMatrix();
-        coulomb_exchange_.second.betaMatrix() += elem.getExchangeMatrix().betaMatrix();
+        coulombExchange.first.betaMatrix() += elem.getCoulombMatrix().betaMatrix();
+        coulombExchange.second.betaMatrix() += elem.getExchangeMatrix().betaMatrix();
+      }
+    }
+  }
+
+  if (centerOfMass_) {
+    if (densityMatrix_.restricted()) {
+      centerOfMass_->addToCoulomb1(coulombExchange.first.restrictedMatrix(), densityMatrix_.restrictedMatrix());
+      centerOfMass_->addToExchange(coulombExchange.second.restrictedMatrix(), densityMatrix_.restrictedMatrix());
+    }
+    else {
+      centerOfMass_->addToCoulomb1(coulombExchange.first.alphaMatrix(), densityMatrix_.alphaMatrix());
+      centerOfMass_->addToExchange(coulombExchange.second.alphaMatrix(), densityMatrix_.alphaMatrix());
+      if (densityMatrix_.numberElectronsInBetaMatrix() > 0) {
+        centerOfMass_->addToCoulomb1(coulombExchange.first.betaMatrix(), densityMatrix_.betaMatrix());
+        centerOfMass_->addToExchange(coulombExchange.second.betaMatrix(), densityMatrix_.betaMatrix());
       }
     }
   }
@@ -70,7 +107,29 @@ CoulombExchangeDigester::CoulombExchangeDigester(const Utils::Integrals::BasisSe
                                                  const Utils::Integrals::BasisSet& scineBasis2,
                                                  const Utils::Integrals::IntegralSpecifier& specifier,
                                                  const Utils::DensityMatrix& densityMatrix)
-  : Digester<CoulombExchangeDigester>(scineBasis1, scineBasis2, specifier), densityMatrix_(densityMatrix) {
+  : CoulombExchangeDigester(scineBasis1, scineBasis2, specifier, densityMatrix, nullptr, nullptr, nullptr) {
+}
+
+CoulombExchangeDigester::CoulombExchangeDigester(
+    const Utils::Integrals::BasisSet& scineBasis1, const Utils::Integrals::BasisSet& scineBasis2,
+    const Utils::Integrals::IntegralSpecifier& specifier, const Utils::DensityMatrix& densityMatrix,
+    std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& coulombExchange,
+    std::vector<CoulombExchangeConstructor>& constructors, std::shared_ptr<const CenterOfMassCorrection> centerOfMass)
+  : CoulombExchangeDigester(scineBasis1, scineBasis2, specifier, densityMatrix, &coulombExchange, &constructors,
+                            std::move(centerOfMass)) {
+}
+
+CoulombExchangeDigester::CoulombExchangeDigester(
+    const Utils::Integrals::BasisSet& scineBasis1, const Utils::Integrals::BasisSet& scineBasis2,
+    const Utils::Integrals::IntegralSpecifier& specifier, const Utils::DensityMatrix& densityMatrix,
+    std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>* externalResult,
+    std::vector<CoulombExchangeConstructor>* externalConstructors,
+    std::shared_ptr<const CenterOfMassCorrection> centerOfMass)
+  : Digester<CoulombExchangeDigester>(scineBasis1, scineBasis2, specifier),
+    densityMatrix_(densityMatrix),
+    externalResult_(externalResult),
+    externalConstructors_(externalConstructors),
+    centerOfMass_(std::move(centerOfMass)) {
   if (specifier.typeVector.size() == 2) {
     this->scaling_ = specifier.typeVector[0].charge * specifier.typeVector[1].charge;
   }
@@ -78,25 +137,41 @@ CoulombExchangeDigester::CoulombExchangeDigester(const Utils::Integrals::BasisSe
   if (this->specifier_.derivOrder != 0) {
     throw std::runtime_error("Derivative of the Fock matrix not available, yet!");
   }
+  // The Coulomb part is digested quartet by quartet, the center-of-mass term is separable and added at the end.
+  if (specifier.op == Utils::Integrals::Operator::CoulombCOM) {
+    if (scineBasis1 != scineBasis2) {
+      throw std::runtime_error("The direct CoulombCOM Fock build of one particle type requires identical bases.");
+    }
+    if (!centerOfMass_) {
+      centerOfMass_ = std::make_shared<const CenterOfMassCorrection>(scineBasis1, scineBasis2, specifier);
+    }
+  }
+  else {
+    centerOfMass_.reset();
+  }
+
+  zeroResult();
+}
 
-  // TODO see if this works properly:
+void CoulombExchangeDigester::zeroResult() {
+  auto& coulombExchange = result();
   if (densityMatrix_.restricted()) {
-    coulomb_exchange_.first.restrictedMatrix().resizeLike(densityMatrix_.restrictedMatrix());
-    coulomb_exchange_.first.restrictedMatrix().setZero();
-    coulomb_exchange_.second.restrictedMatrix().resizeLike(densityMatrix_.restrictedMatrix());
-    coulomb_exchange_.second.restrictedMatrix().setZero();
+    coulombExchange.first.restrictedMatrix().resizeLike(densityMatrix_.restrictedMatrix());
+    coulombExchange.first.restrictedMatrix().setZero();
+    coulombExchange.second.restrictedMatrix().resizeLike(densityMatrix_.restrictedMatrix());
+    coulombExchange.second.restrictedMatrix().setZero();
   }
   else {
-    coulomb_exchange_.first.alphaMatrix().resizeLike(densityMatrix_.alphaMatrix());
-    coulomb_exchange_.first.alphaMatrix().setZero();
-    coulomb_exchange_.second.alphaMatrix().resizeLike(densityMatrix_.alphaMatrix());
-    coulomb_exchange_.second.alphaMatrix().setZero();
+    coulombExchange.first.alphaMatrix().resizeLike(densityMatrix_.alphaMatrix());
+    coulombExchange.first.alphaMatrix().setZero();
+    coulombExchange.second.alphaMatrix().resizeLike(densityMatrix_.alphaMatrix());
+    coulombExchange.second.alphaMatrix().setZero();
     // TODO see if this works:
     if (densityMatrix_.numberElectronsInBetaMatrix() > 0) {
-      coulomb_exchange_.first.betaMatrix().resizeLike(densityMatrix_.betaMatrix());
-      coulomb_exchange_.first.betaMatrix().setZero();
-      coulomb_exchange_.second.betaMatrix().resizeLike(densityMatrix_.betaMatrix());
-      coulomb_exchange_.second.betaMatrix().setZero();
+      coulombExchange.first.betaMatrix().resizeLike(densityMatrix_.betaMatrix());
+      coulombExchange.first.betaMatrix().setZero();
+      coulombExchange.second.betaMatrix().resizeLike(densityMatrix_.betaMatrix());
+      coulombExchange.second.betaMatrix().setZero();
     }
   }
 }
@@ -9,11 +9,13 @@
 
 #include <LibintIntegrals/LibintIntegrals.h>
 #include <LibintIntegrals/TwoBodyIntegrals/Digester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/CenterOfMassCorrection.h>
 #include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/CoulombExchangeConstructor.h>
 #include <LibintIntegrals/TwoBodyIntegrals/SymmetryHelper.h>
 #include <Utils/DataStructures/DensityMatrix.h>
 #include <Utils/DataStructures/SpinAdaptedMatrix.h>
 #include <Eigen/Dense>
+#include <memory>
 
 namespace Scine {
 namespace Integrals {
@@ -23,6 +25,16 @@ class CoulombExchangeDigester : public Digester<CoulombExchangeDigester> {
  public:
   CoulombExchangeDigester(const Utils::Integrals::BasisSet& scineBasis1, const Utils::Integrals::BasisSet& scineBasis2,
                           const Utils::Integrals::IntegralSpecifier& specifier, const Utils::DensityMatrix& D);
+  /**
+   * @brief Accumulates into caller-owned J and K matrices and reuses caller-owned per-thread constructors. Both are
+   * zeroed and only reallocated if their dimensions change; they must outlive the digester. For Operator::CoulombCOM,
+   * a center-of-mass term kept by the caller can be passed, otherwise it is evaluated. See DirectFockBuilder.
+   */
+  CoulombExchangeDigester(const Utils::Integrals::BasisSet& scineBasis1, const Utils::Integrals::BasisSet& scineBasis2,
+                          const Utils::Integrals::IntegralSpecifier& specifier, const Utils::DensityMatrix& D,
+                          std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& coulombExchange,
+                          std::vector<CoulombExchangeConstructor>& constructors,
+                          std::shared_ptr<const CenterOfMassCorrection> centerOfMass = nullptr);
 
   void digestImpl(double integralValue, int basisFunction1, int basisFunction2, int basisFunction3, int basisFunction4,
                   int index, double degeneracy);
@@ -30,14 +42,31 @@ class CoulombExchangeDigester : public Digester<CoulombExchangeDigester> {
   double computeDegeneracyImpl(int shell1, int shell2, int shell3, int shell4);
 
   const std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& getResultImpl() const;
+  std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix> takeResultImpl();
   void initializeImpl(int numberThreads);
   void finalizeImpl();
 
  private:
+  CoulombExchangeDigester(const Utils::Integrals::BasisSet& scineBasis1, const Utils::Integrals::BasisSet& scineBasis2,
+                          const Utils::Integrals::IntegralSpecifier& specifier, const Utils::DensityMatrix& D,
+                          std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>* externalResult,
+                          std::vector<CoulombExchangeConstructor>* externalConstructors,
+                          std::shared_ptr<const CenterOfMassCorrection> centerOfMass);
+  std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& result();
+  const std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& result() const;
+  void zeroResult();
+
   std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix> coulomb_exchange_;
   const Utils::DensityMatrix& densityMatrix_;
   /* One constructor per thread */
   std::vector<CoulombExchangeConstructor> constructor_;
+  /* Caller-owned result and constructors, null if the digester owns them */
+  std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>* externalResult_;
+  std::vector<CoulombExchangeConstructor>* externalConstructors_;
+  /* The constructors in use, set in initializeImpl() */
+  std::vector<CoulombExchangeConstructor>* constructors_ = nullptr;
+  /* The separable term of Operator::CoulombCOM, null for Operator::Coulomb */
+  std::shared_ptr<const CenterOfMassCorrection> centerOfMass_;
 };
 
 } // namespace TwoBody
@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#include <LibintIntegrals/TwoBodyIntegrals/CauchySchwarzDensityPrescreener.h>
+#include <LibintIntegrals/TwoBodyIntegrals/Evaluator.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/CoulombExchangeDigester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/DirectFockBuilder.h>
+#include <LibintIntegrals/TwoBodyIntegrals/LibintBasis.h>
+#include <Utils/DataStructures/DensityMatrix.h>
+#include <stdexcept>
+
+using namespace Scine;
+using namespace Integrals;
+using namespace TwoBody;
+
+DirectFockBuilder::DirectFockBuilder(const Utils::Integrals::BasisSet& basis,
+                                     Utils::Integrals::IntegralSpecifier specifier, double prescreeningThreshold,
+                                     std::shared_ptr<const LibintBasis> libintBasis)
+  : basis_(basis),
+    specifier_(std::move(specifier)),
+    prescreeningThreshold_(prescreeningThreshold),
+    libintBasis_(std::move(libintBasis)) {
+  if (!basis_.areShellPairsEvaluated()) {
+    throw std::runtime_error("Evaluate shell pairs before performing the two-body integral evaluation!");
+  }
+  if (libintBasis_ && !libintBasis_->isConversionOf(basis_)) {
+    throw std::invalid_argument("The libint basis does not belong to the shell pairs of the basis.");
+  }
+  updateBasisData();
+}
+
+void DirectFockBuilder::updateBasisData() {
+  if (!libintBasis_ || !libintBasis_->isConversionOf(basis_)) {
+    libintBasis_ = std::make_shared<const LibintBasis>(basis_);
+    centerOfMass_.reset();
+  }
+  if (specifier_.op == Utils::Integrals::Operator::CoulombCOM && !centerOfMass_) {
+    centerOfMass_ = std::make_shared<const CenterOfMassCorrection>(basis_, basis_, specifier_);
+  }
+}
+
+void DirectFockBuilder::compute(const Utils::DensityMatrix& density,
+                                std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& coulombExchange) {
+  updateBasisData();
+  auto prescreener = CauchySchwarzDensityPrescreener(basis_, density, prescreeningThreshold_);
+  auto digester =
+      CoulombExchangeDigester(basis_, basis_, specifier_, density, coulombExchange, constructors_, centerOfMass_);
+  auto evaluator = Evaluator<CoulombExchangeDigester, CauchySchwarzDensityPrescreener>(
+      basis_, basis_, specifier_, std::move(digester), std::move(prescreener));
+  evaluator.setNumberOfThreads(numberThreads_);
+  evaluator.setLibintBases(libintBasis_, libintBasis_);
+  evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+}
+
+void DirectFockBuilder::setNumberOfThreads(int numberThreads) {
+  if (numberThreads < 0) {
+    throw std::invalid_argument("The number of threads must not be negative.");
+  }
+  numberThreads_ = numberThreads;
+}
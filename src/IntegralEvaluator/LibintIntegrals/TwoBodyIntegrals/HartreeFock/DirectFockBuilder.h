@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef INTEGRALEVALUATOR_DIRECTFOCKBUILDER_H
+#define INTEGRALEVALUATOR_DIRECTFOCKBUILDER_H
+
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/CoulombExchangeConstructor.h>
+#include <Utils/DataStructures/BasisSet.h>
+#include <Utils/DataStructures/IntegralSpecifier.h>
+#include <Utils/DataStructures/SpinAdaptedMatrix.h>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Scine {
+namespace Utils {
+class DensityMatrix;
+} // namespace Utils
+namespace Integrals {
+namespace TwoBody {
+
+class CenterOfMassCorrection;
+class LibintBasis;
+
+/**
+ * @class DirectFockBuilder @file DirectFockBuilder.h
+ * This class evaluates the Coulomb and exchange matrices of one particle type for a sequence of densities, e.g. in
+ * the iterations of an SCF.
+ *
+ * The J and K matrices are written into caller-owned storage and the per-thread CoulombExchangeConstructor scratch is
+ * kept between calls. Both are only zeroed as long as the dimensions stay the same, such that steady-state
+ * iterations do not allocate any matrices of basis-set size, apart from the density shell-block maxima of the
+ * Cauchy-Schwarz screening. The libint shells and shell pairs (see LibintBasis) and, for Operator::CoulombCOM, the
+ * center-of-mass term are kept as well. They are rebuilt by compute() if the shell pairs of the basis were
+ * regenerated in the meantime. The result is identical to LibintIntegrals::evaluateTwoBodyDirectBo with identical
+ * bases.
+ *
+ * The builder refers to the basis, which must outlive it.
+ */
+class DirectFockBuilder {
+ public:
+  /**
+   * @brief Constructor.
+   * @param basis The basis, the shell pairs must have been generated. It must outlive the builder.
+   * @param specifier Operator::Coulomb or Operator::CoulombCOM.
+   * @param prescreeningThreshold Threshold of the Cauchy-Schwarz density screening.
+   * @param libintBasis The libint conversion of the basis if it is shared with other evaluations, converted if null.
+   * @throws std::runtime_error if the shell pairs have not been generated.
+   * @throws std::invalid_argument if libintBasis is not the conversion of the shell pairs of the basis.
+   */
+  DirectFockBuilder(const Utils::Integrals::BasisSet& basis, Utils::Integrals::IntegralSpecifier specifier,
+                    double prescreeningThreshold = 1e-12, std::shared_ptr<const LibintBasis> libintBasis = nullptr);
+
+  /**
+   * @brief Evaluates J and K of the given density into coulombExchange, overwriting its content.
+   * @param density The density matrix.
+   * @param coulombExchange (J, K), reused as output buffer.
+   */
+  void compute(const Utils::DensityMatrix& density,
+               std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>& coulombExchange);
+
+  /**
+   * @brief Sets the number of threads requested for compute(), by default 0, i.e. Libint::getNumberOfThreads().
+   * @throws std::invalid_argument if the number is negative.
+   */
+  void setNumberOfThreads(int numberThreads);
+
+ private:
+  /* Converts the basis to libint and evaluates the center-of-mass term, if the shell pairs changed since */
+  void updateBasisData();
+
+  /* Not owned, see the class documentation */
+  const Utils::Integrals::BasisSet& basis_;
+  Utils::Integrals::IntegralSpecifier specifier_;
+  double prescreeningThreshold_;
+  int numberThreads_ = 0;
+  /* One constructor per thread, kept between calls */
+  std::vector<CoulombExchangeConstructor> constructors_;
+  std::shared_ptr<const LibintBasis> libintBasis_;
+  /* Null for Operator::Coulomb */
+  std::shared_ptr<const CenterOfMassCorrection> centerOfMass_;
+};
+
+} // namespace TwoBody
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_DIRECTFOCKBUILDER_H
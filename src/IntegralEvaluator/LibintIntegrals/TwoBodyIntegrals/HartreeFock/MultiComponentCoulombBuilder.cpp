@@ -0,0 +1,229 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#include <LibintIntegrals/BasisSetHandler.h>
+#include <LibintIntegrals/Libint.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/MultiComponentCoulombBuilder.h>
+#include <LibintIntegrals/TwoBodyIntegrals/QuartetScheduler.h>
+#include <LibintIntegrals/TwoBodyIntegrals/TwoTypeCauchySchwarzPrescreener.h>
+#include <Utils/DataStructures/DensityMatrix.h>
+#include <algorithm>
+
+using namespace Scine;
+using namespace Integrals;
+using namespace TwoBody;
+
+namespace {
+// Everything of a component that is shared by the threads.
+struct ComponentData {
+  std::shared_ptr<Utils::Integrals::ShellPairs> shellPairs;
+  std::vector<libint2::Shell> libintShells;
+  std::vector<std::vector<libint2::ShellPair>> libintShellPairs;
+  std::vector<std::size_t> shell2bf;
+  Eigen::MatrixXd densityShellBlockMaxima;
+  double totalPairWeight = 0.0;
+};
+
+// A bra shell pair (s1, sp12) of component a, combined with the ket shell pairs of all components b > a.
+struct BraUnit {
+  std::size_t a;
+  std::size_t s1;
+  std::size_t sp12;
+  double cost;
+};
+} // namespace
+
+auto MultiComponentCoulomb::total(std::size_t a) const -> Eigen::MatrixXd {
+  Eigen::MatrixXd sum;
+  for (std::size_t b = 0; b < coulomb.at(a).size(); ++b) {
+    if (b == a) {
+      continue;
+    }
+    if (sum.size() == 0) {
+      sum = coulomb[a][b];
+    }
+    else {
+      sum += coulomb[a][b];
+    }
+  }
+  return sum;
+}
+
+MultiComponentCoulombBuilder::MultiComponentCoulombBuilder(std::vector<ParticleComponent> components,
+                                                           double prescreeningThreshold)
+  : components_(std::move(components)), prescreeningThreshold_(prescreeningThreshold) {
+  for (auto const& component : components_) {
+    if (!component.basis.areShellPairsEvaluated()) {
+      throw std::runtime_error("Evaluate shell pairs before building the multi-component Coulomb matrices!");
+    }
+    const auto nbf = static_cast<Eigen::Index>(component.basis.nbf());
+    if (component.density.restrictedMatrix().rows() != nbf || component.density.restrictedMatrix().cols() != nbf) {
+      throw std::runtime_error("Density matrix does not match the basis set.");
+    }
+  }
+}
+
+auto MultiComponentCoulombBuilder::compute() -> void {
+  const auto numberOfComponents = components_.size();
+  Libint::getInstance();
+
+  std::vector<ComponentData> data(numberOfComponents);
+  std::size_t maxNumberPrimitives = 0;
+  int maxAngularMomentum = 0;
+  bool hasCauchySchwarzFactors = true;
+  for (std::size_t a = 0; a < numberOfComponents; ++a) {
+    const auto& basis = components_[a].basis;
+    auto& componentData = data[a];
+    componentData.shellPairs = basis.getShellPairs();
+    componentData.shell2bf = basis.shell2bf();
+    componentData.libintShells.reserve(basis.size());
+    for (auto const& shell : basis) {
+      componentData.libintShells.push_back(BasisSetHandler::scineToLibint(shell));
+    }
+    componentData.libintShellPairs.resize(componentData.shellPairs->size());
+    for (std::size_t s1 = 0; s1 < componentData.shellPairs->size(); ++s1) {
+      for (auto const& shellPair : componentData.shellPairs->at(s1)) {
+        componentData.libintShellPairs[s1].push_back(BasisSetHandler::scineToLibint(*shellPair.precomputedShellPair));
+        componentData.totalPairWeight += QuartetScheduler::pairWeight(basis, s1, shellPair);
+      }
+    }
+    componentData.densityShellBlockMaxima =
+        TwoTypeCauchySchwarzPrescreener::shellBlockMaxima(basis, components_[a].density.restrictedMatrix());
+    maxNumberPrimitives = std::max(maxNumberPrimitives, basis.max_nprim());
+    maxAngularMomentum = std::max(maxAngularMomentum, static_cast<int>(basis.max_l()));
+    hasCauchySchwarzFactors = hasCauchySchwarzFactors && componentData.shellPairs->hasCauchySchwarzFactor();
+  }
+
+  // The most expensive units are handed out first.
+  std::vector<BraUnit> units;
+  double laterPairWeight = 0.0;
+  for (std::size_t a = numberOfComponents; a-- > 0;) {
+    if (laterPairWeight > 0.0) {
+      const auto& shellPairs = *data[a].shellPairs;
+      for (std::size_t s1 = 0; s1 < shellPairs.size(); ++s1) {
+        for (std::size_t sp12 = 0; sp12 < shellPairs[s1].size(); ++sp12) {
+          const double braWeight = QuartetScheduler::pairWeight(components_[a].basis, s1, shellPairs[s1][sp12]);
+          units.push_back({a, s1, sp12, braWeight * laterPairWeight});
+        }
+      }
+    }
+    laterPairWeight += data[a].totalPairWeight;
+  }
+  std::stable_sort(units.begin(), units.end(),
+                   [](const BraUnit& lhs, const BraUnit& rhs) { return lhs.cost > rhs.cost; });
+
+  result_.coulomb.assign(numberOfComponents, std::vector<Eigen::MatrixXd>(numberOfComponents));
+  for (std::size_t a = 0; a < numberOfComponents; ++a) {
+    const auto nbf = components_[a].basis.nbf();
+    for (std::size_t b = 0; b < numberOfComponents; ++b) {
+      if (b != a) {
+        result_.coulomb[a][b] = Eigen::MatrixXd::Zero(nbf, nbf);
+      }
+    }
+  }
+
+#pragma omp parallel num_threads(Libint::getNumberOfThreads())
+  {
+    auto engine = Libint::leaseEngine(libint2::Operator::coulomb, maxNumberPrimitives, maxAngularMomentum, 0);
+    const auto& buffer = engine->results();
+    auto local = result_.coulomb;
+
+#pragma omp for schedule(dynamic)
+    for (std::size_t u = 0; u < units.size(); ++u) {
+      const auto& unit = units[u];
+      const auto a = unit.a;
+      const auto& bra = data[a];
+      const auto& braPair = bra.shellPairs->at(unit.s1)[unit.sp12];
+      const auto s1 = unit.s1;
+      const auto s2 = braPair.secondShellIndex;
+      const auto n1 = bra.libintShells[s1].size();
+      const auto n2 = bra.libintShells[s2].size();
+      const auto bf1 = bra.shell2bf[s1];
+      const auto bf2 = bra.shell2bf[s2];
+      const auto& densityA = components_[a].density.restrictedMatrix();
+      const double braDensityMaximum = bra.densityShellBlockMaxima(s1, s2);
+
+      for (std::size_t b = a + 1; b < numberOfComponents; ++b) {
+        const auto& ket = data[b];
+        const auto& densityB = components_[b].density.restrictedMatrix();
+        auto& coulombAB = local[a][b];
+        auto& coulombBA = local[b][a];
+        // Only s2 <= s1 and s4 <= s3 are visited, the missing permutations are restored by the degeneracy and the
+        // final symmetrization.
+        const double braPrefactor = components_[a].charge * components_[b].charge * ((s1 == s2) ? 1.0 : 2.0);
+
+        for (std::size_t s3 = 0; s3 < ket.shellPairs->size(); ++s3) {
+          const auto& pairsOfShell3 = ket.shellPairs->at(s3);
+          for (std::size_t sp34 = 0; sp34 < pairsOfShell3.size(); ++sp34) {
+            const auto& ketPair = pairsOfShell3[sp34];
+            const auto s4 = ketPair.secondShellIndex;
+            if (hasCauchySchwarzFactors) {
+              const double densityMaximum = std::max(braDensityMaximum, ket.densityShellBlockMaxima(s3, s4));
+              if (braPair.cauchySchwarzFactor * ketPair.cauchySchwarzFactor * densityMaximum < prescreeningThreshold_) {
+                continue;
+              }
+            }
+            engine->compute2<libint2::Operator::coulomb, libint2::BraKet::xx_xx, 0>(
+                bra.libintShells[s1], bra.libintShells[s2], ket.libintShells[s3], ket.libintShells[s4],
+                &bra.libintShellPairs[s1][unit.sp12], &ket.libintShellPairs[s3][sp34]);
+            if (buffer[0] == nullptr) {
+              continue;
+            }
+
+            const double scaling = braPrefactor * ((s3 == s4) ? 1.0 : 2.0);
+            const auto n3 = ket.libintShells[s3].size();
+            const auto n4 = ket.libintShells[s4].size();
+            const auto bf3 = ket.shell2bf[s3];
+            const auto bf4 = ket.shell2bf[s4];
+            const double* integrals = buffer[0];
+            for (std::size_t i = bf1; i < bf1 + n1; ++i) {
+              for (std::size_t j = bf2; j < bf2 + n2; ++j) {
+                const double densityIJ = densityA(i, j);
+                double coulombIJ = 0.0;
+                for (std::size_t k = bf3; k < bf3 + n3; ++k) {
+                  for (std::size_t l = bf4; l < bf4 + n4; ++l) {
+                    const double integral = scaling * *integrals++;
+                    coulombIJ += densityB(k, l) * integral;
+                    coulombBA(k, l) += densityIJ * integral;
+                  }
+                }
+                coulombAB(i, j) += coulombIJ;
+              }
+            }
+          }
+        }
+      }
+    }
+
+#pragma omp critical
+    {
+      for (std::size_t a = 0; a < numberOfComponents; ++a) {
+        for (std::size_t b = 0; b < numberOfComponents; ++b) {
+          if (b != a) {
+            result_.coulomb[a][b] += local[a][b];
+          }
+        }
+      }
+    }
+  }
+
+  for (std::size_t a = 0; a < numberOfComponents; ++a) {
+    for (std::size_t b = 0; b < numberOfComponents; ++b) {
+      if (b != a) {
+        auto& coulomb = result_.coulomb[a][b];
+        coulomb = 0.5 * (coulomb + coulomb.transpose()).eval();
+      }
+    }
+  }
+}
+
+auto MultiComponentCoulombBuilder::getResult() const -> const MultiComponentCoulomb& {
+  return result_;
+}
+
+auto MultiComponentCoulombBuilder::takeResult() -> MultiComponentCoulomb {
+  return std::move(result_);
+}
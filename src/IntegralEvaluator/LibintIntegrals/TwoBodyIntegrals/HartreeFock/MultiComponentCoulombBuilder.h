@@ -0,0 +1,97 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef INTEGRALEVALUATOR_MULTICOMPONENTCOULOMBBUILDER_H
+#define INTEGRALEVALUATOR_MULTICOMPONENTCOULOMBBUILDER_H
+
+#include <Utils/DataStructures/BasisSet.h>
+#include <Eigen/Core>
+#include <vector>
+
+namespace Scine {
+namespace Utils {
+class DensityMatrix;
+} // namespace Utils
+namespace Integrals {
+namespace TwoBody {
+
+/**
+ * @brief A quantum particle type of a nuclear-electronic calculation.
+ */
+struct ParticleComponent {
+  //! The basis of the particle type, the shell pairs must have been generated.
+  const Utils::Integrals::BasisSet& basis;
+  //! The (restricted, i.e. total) density matrix of the particle type.
+  const Utils::DensityMatrix& density;
+  //! The charge of a single particle, e.g. -1 for electrons.
+  double charge;
+};
+
+/**
+ * @brief The Coulomb matrices between all pairs of particle types.
+ */
+struct MultiComponentCoulomb {
+  /**
+   * coulomb[a][b] is the Coulomb matrix of component a generated by the density of component b, scaled with the
+   * product of both charges. The matrices coulomb[a][a] are empty.
+   */
+  std::vector<std::vector<Eigen::MatrixXd>> coulomb;
+  /**
+   * @brief The Coulomb matrix of component a generated by all other components.
+   */
+  auto total(std::size_t a) const -> Eigen::MatrixXd;
+};
+
+/**
+ * @class MultiComponentCoulombBuilder @file MultiComponentCoulombBuilder.h
+ * This class computes the Coulomb interaction between every pair of particle types of a nuclear-electronic
+ * calculation in a single parallel pass.
+ *
+ * Component a acts as bra for all components b > a. A unit of work is a bra shell pair of a together with the ket
+ * shell pairs of all later components, such that the bra pair and its density block are shared by all of them.
+ * The units are sorted by their estimated cost and distributed dynamically among the threads. The libint shells,
+ * shell pairs and density shell-block maxima of every component are set up once.
+ *
+ * A quartet is skipped if its Cauchy-Schwarz bound times the largest density element of its bra and ket shell
+ * blocks is below the threshold, see TwoTypeCauchySchwarzPrescreener. Unlike
+ * LibintIntegrals::evaluateTwoBodyDirectPreBo, components may share the same basis or particle symbol.
+ */
+class MultiComponentCoulombBuilder {
+ public:
+  /**
+   * @brief Constructor.
+   * @param components The particle types, best with the one with the largest basis (the electrons) first.
+   * @param prescreeningThreshold Threshold of the Cauchy-Schwarz screening.
+   */
+  explicit MultiComponentCoulombBuilder(std::vector<ParticleComponent> components,
+                                        double prescreeningThreshold = 1e-12);
+
+  /**
+   * @brief Do the actual computation
+   */
+  auto compute() -> void;
+
+  /**
+   * @brief After `compute` has been called, the result can be retrieved with this method.
+   */
+  auto getResult() const -> const MultiComponentCoulomb&;
+  /**
+   * @brief Moves the result out of the builder instead of copying it. The builder holds no valid result afterwards,
+   * until the next call to `compute`.
+   */
+  auto takeResult() -> MultiComponentCoulomb;
+
+ private:
+  std::vector<ParticleComponent> components_;
+  double prescreeningThreshold_;
+  MultiComponentCoulomb result_;
+};
+
+} // namespace TwoBody
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_MULTICOMPONENTCOULOMBBUILDER_H
@@ -5,7 +5,6 @@
  *            See LICENSE.txt for details.
  */
 #include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/TwoTypeCoulombConstructor.h>
-#include <LibintIntegrals/TwoBodyIntegrals/SymmetryHelper.h>
 #include <Utils/DataStructures/DensityMatrix.h>
 
 namespace Scine {
@@ -34,14 +33,11 @@ void TwoTypeCoulombConstructor::evaluateBasisFunctionQuartet(double integralValu
   const auto* dm2 = densityMatrix_type2_.restrictedMatrix().data();
   auto* J1 = coulomb_type1_.data();
   auto* J2 = coulomb_type2_.data();
-  // Generates all non-equivalent permutations
-  auto index = IndexType<4>({basisFunction1, basisFunction2, basisFunction3, basisFunction4});
-  auto symmetricIndices = getSymmetricIndices<IntegralSymmetry::fourfold>(std::move(index));
-  // Coulomb term
-  for (const auto& idx : symmetricIndices) {
-    J1[idx[0] * dim1_ + idx[1]] += dm2[idx[2] * dim2_ + idx[3]] * integralValue;
-    J2[idx[2] * dim2_ + idx[3]] += dm1[idx[0] * dim1_ + idx[1]] * integralValue;
-  }
+  // The permutations within bra and ket are restored by finalizeEvaluation().
+  const auto index12 = basisFunction1 * dim1_ + basisFunction2;
+  const auto index34 = basisFunction3 * dim2_ + basisFunction4;
+  J1[index12] += dm2[index34] * integralValue;
+  J2[index34] += dm1[index12] * integralValue;
 }
 
 void TwoTypeCoulombConstructor::finalizeEvaluation() {
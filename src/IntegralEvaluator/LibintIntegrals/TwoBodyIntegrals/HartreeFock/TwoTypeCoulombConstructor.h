@@ -30,7 +30,9 @@ class TwoTypeCoulombConstructor {
                                      const Utils::DensityMatrix& densityMatrix_type2);
 
   /**
-   * @brief Evaluates 6 matrix elements from a basis function quartet.
+   * @brief Adds the contributions of a basis function quartet to both Coulomb matrices.
+   * The integral value must already be scaled by the degeneracy of the quartet, i.e. by the number of permutations
+   * within bra and ket it stands for.
    */
   void evaluateBasisFunctionQuartet(double integralValue, int basisFunction1, int basisFunction2, int basisFunction3,
                                     int basisFunction4);
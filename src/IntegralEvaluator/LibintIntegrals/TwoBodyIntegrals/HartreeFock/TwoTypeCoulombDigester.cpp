@@ -16,15 +16,11 @@ namespace Integrals {
 namespace TwoBody {
 
 void TwoTypeCoulombDigester::digestImpl(double integralValue, int i, int j, int k, int l, int index, double degeneracy) {
-  UNUSED(degeneracy);
   UNUSED(index);
 
-  integralValue *= this->scaling_;
-
-  IndexType<4> indexSet = {i, j, k, l};
-  if (!std::equal(indexSet.begin(), indexSet.end(), getMappedIndex<IntegralSymmetry::fourfold>(indexSet).begin())) {
-    return;
-  }
+  // The evaluator only hands over shell quartets with s1 >= s2 and s3 >= s4. All their basis-function quartets are
+  // used, the missing permutations are accounted for by the degeneracy and the final symmetrization.
+  integralValue *= this->scaling_ * degeneracy;
 
   const auto threadNr = omp_get_thread_num();
 
@@ -35,12 +31,14 @@ const std::pair<Eigen::MatrixXd, Eigen::MatrixXd>& TwoTypeCoulombDigester::getRe
   return coulomb_type1_type2_;
 }
 
+std::pair<Eigen::MatrixXd, Eigen::MatrixXd> TwoTypeCoulombDigester::takeResultImpl() {
+  return std::move(coulomb_type1_type2_);
+}
+
 double TwoTypeCoulombDigester::computeDegeneracyImpl(int shell1, int shell2, int shell3, int shell4) {
-  UNUSED(shell1);
-  UNUSED(shell2);
-  UNUSED(shell3);
-  UNUSED(shell4);
-  return 1;
+  auto shell12_deg = (shell1 == shell2) ? 1 : 2;
+  auto shell34_deg = (shell3 == shell4) ? 1 : 2;
+  return shell12_deg * shell34_deg;
 }
 
 void TwoTypeCoulombDigester::initializeImpl(int numberThreads) {
@@ -59,6 +57,11 @@ void TwoTypeCoulombDigester::finalizeImpl() {
   for (auto& elem : constructor_) {
     coulomb_type1_type2_.second += elem.getCoulombMatrixType2();
   }
+
+  if (centerOfMass_) {
+    centerOfMass_->addToCoulomb1(coulomb_type1_type2_.first, densityMatrix_type2_.restrictedMatrix());
+    centerOfMass_->addToCoulomb2(coulomb_type1_type2_.second, densityMatrix_type1_.restrictedMatrix());
+  }
 }
 
 TwoTypeCoulombDigester::TwoTypeCoulombDigester(const Utils::Integrals::BasisSet& scineBasis1,
@@ -77,6 +80,10 @@ TwoTypeCoulombDigester::TwoTypeCoulombDigester(const Utils::Integrals::BasisSet&
   if (this->specifier_.derivOrder != 0) {
     throw std::runtime_error("Derivative of the Fock matrix not available, yet!");
   }
+  // The Coulomb part is digested quartet by quartet, the center-of-mass term is separable and added at the end.
+  if (specifier.op == Utils::Integrals::Operator::CoulombCOM) {
+    centerOfMass_ = std::make_unique<CenterOfMassCorrection>(scineBasis1, scineBasis2, specifier);
+  }
 
   coulomb_type1_type2_.first.resizeLike(densityMatrix_type1_.restrictedMatrix());
   coulomb_type1_type2_.first.setZero();
@@ -9,11 +9,13 @@
 
 #include <LibintIntegrals/LibintIntegrals.h>
 #include <LibintIntegrals/TwoBodyIntegrals/Digester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/CenterOfMassCorrection.h>
 #include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/TwoTypeCoulombConstructor.h>
 #include <LibintIntegrals/TwoBodyIntegrals/SymmetryHelper.h>
 #include <Utils/DataStructures/DensityMatrix.h>
 #include <Utils/DataStructures/SpinAdaptedMatrix.h>
 #include <Eigen/Dense>
+#include <memory>
 
 namespace Scine {
 namespace Integrals {
@@ -31,6 +33,7 @@ class TwoTypeCoulombDigester : public Digester<TwoTypeCoulombDigester> {
   double computeDegeneracyImpl(int shell1, int shell2, int shell3, int shell4);
 
   const std::pair<Eigen::MatrixXd, Eigen::MatrixXd>& getResultImpl() const;
+  std::pair<Eigen::MatrixXd, Eigen::MatrixXd> takeResultImpl();
   void initializeImpl(int numberThreads);
   void finalizeImpl();
 
@@ -40,6 +43,8 @@ class TwoTypeCoulombDigester : public Digester<TwoTypeCoulombDigester> {
   const Utils::DensityMatrix& densityMatrix_type2_;
   /* One constructor per thread */
   std::vector<TwoTypeCoulombConstructor> constructor_;
+  /* The separable term of Operator::CoulombCOM, null for Operator::Coulomb */
+  std::unique_ptr<CenterOfMassCorrection> centerOfMass_;
 };
 
 } // namespace TwoBody
@@ -0,0 +1,35 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/BasisSetHandler.h>
+#include <LibintIntegrals/TwoBodyIntegrals/LibintBasis.h>
+#include <stdexcept>
+
+using namespace Scine;
+using namespace Integrals;
+using namespace TwoBody;
+
+LibintBasis::LibintBasis(const Utils::Integrals::BasisSet& basis) : scineShellPairs_(basis.getShellPairs()) {
+  if (!basis.areShellPairsEvaluated() || !scineShellPairs_) {
+    throw std::runtime_error("Evaluate shell pairs before performing the two-body integral evaluation!");
+  }
+  shells.reserve(basis.size());
+  for (auto const& shell : basis) {
+    shells.push_back(BasisSetHandler::scineToLibint(shell));
+  }
+  shellPairs.resize(scineShellPairs_->size());
+  for (std::size_t s = 0; s < scineShellPairs_->size(); ++s) {
+    shellPairs[s].reserve(scineShellPairs_->at(s).size());
+    for (const Utils::Integrals::ShellPairData& shellPair : scineShellPairs_->at(s)) {
+      shellPairs[s].push_back(BasisSetHandler::scineToLibint(*shellPair.precomputedShellPair));
+    }
+  }
+}
+
+auto LibintBasis::isConversionOf(const Utils::Integrals::BasisSet& basis) const -> bool {
+  return basis.getShellPairs() == scineShellPairs_ && basis.size() == shells.size();
+}
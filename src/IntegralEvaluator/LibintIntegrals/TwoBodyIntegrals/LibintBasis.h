@@ -0,0 +1,53 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_LIBINTBASIS_H
+#define INTEGRALEVALUATOR_LIBINTBASIS_H
+
+#include <Utils/DataStructures/BasisSet.h>
+#include <libint2.hpp>
+#include <memory>
+#include <vector>
+
+namespace Scine {
+namespace Integrals {
+namespace TwoBody {
+
+/**
+ * @class LibintBasis @file LibintBasis.h
+ * @brief The shells and precomputed shell pairs of a basis converted to libint, see BasisSetHandler::scineToLibint.
+ *
+ * The conversion is read-only afterwards and can be shared by all threads of an evaluation and, with
+ * Evaluator::setLibintBases(), by consecutive evaluations over the same shell pairs.
+ */
+class LibintBasis {
+ public:
+  /**
+   * @brief Converts the shells and shell pairs of the basis.
+   * @throws std::runtime_error if the shell pairs have not been generated.
+   */
+  explicit LibintBasis(const Utils::Integrals::BasisSet& basis);
+
+  /**
+   * @brief Whether this is the conversion of the current shell pairs of the basis.
+   */
+  auto isConversionOf(const Utils::Integrals::BasisSet& basis) const -> bool;
+
+  //! The shells, in the order of the basis.
+  std::vector<libint2::Shell> shells;
+  //! The precomputed shell pairs, in the order of the shell pairs of the basis.
+  std::vector<std::vector<libint2::ShellPair>> shellPairs;
+
+ private:
+  std::shared_ptr<Utils::Integrals::ShellPairs> scineShellPairs_;
+};
+
+} // namespace TwoBody
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_LIBINTBASIS_H
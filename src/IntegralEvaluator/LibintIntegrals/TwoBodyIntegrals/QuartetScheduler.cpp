@@ -0,0 +1,144 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/TwoBodyIntegrals/QuartetScheduler.h>
+#include <algorithm>
+#include <numeric>
+
+using namespace Scine;
+using namespace Integrals;
+using namespace TwoBody;
+
+auto QuartetScheduler::pairWeight(const Utils::Integrals::BasisSet& basis, std::size_t s1,
+                                  const Utils::Integrals::ShellPairData& pair) -> double {
+  const auto numberOfPrimitivePairs = std::max<std::size_t>(pair.precomputedShellPair->primpairs.size(), 1);
+  return static_cast<double>(numberOfPrimitivePairs * basis[s1].size() * basis[pair.secondShellIndex].size());
+}
+
+auto SchedulingStatistics::imbalance() const -> double {
+  if (busyTime.empty()) {
+    return 1.0;
+  }
+  const double mean = std::accumulate(busyTime.begin(), busyTime.end(), 0.0) / busyTime.size();
+  if (mean <= 0.0) {
+    return 1.0;
+  }
+  return *std::max_element(busyTime.begin(), busyTime.end()) / mean;
+}
+
+QuartetScheduler::QuartetScheduler(const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
+                                   SchedulingPolicy policy, int numberOfThreads, int tasksPerThread)
+  : queues_(std::max(numberOfThreads, 1)) {
+  statistics_.busyTime.assign(queues_.size(), 0.0);
+  statistics_.numberOfTasks.assign(queues_.size(), 0);
+  estimateCosts(basis1, basis2);
+  if (policy == SchedulingPolicy::shellWise) {
+    buildShellWiseTasks();
+  }
+  else {
+    buildCostBalancedTasks(std::max(tasksPerThread, 1));
+  }
+}
+
+void QuartetScheduler::estimateCosts(const Utils::Integrals::BasisSet& basis1,
+                                     const Utils::Integrals::BasisSet& basis2) {
+  const auto& shellPairs1 = *basis1.getShellPairs();
+  const auto& shellPairs2 = *basis2.getShellPairs();
+  const bool isSymmetric = basis1 == basis2;
+
+  // Weights of the ket pairs; for identical bases also the summed weight of the ket pairs (s3, sp34) with
+  // sp34 <= s3, which are combined with every bra pair of a shell s1 > s3.
+  std::vector<std::vector<double>> ketWeights(shellPairs2.size());
+  std::vector<double> rowWeightPrefix(shellPairs2.size() + 1, 0.0);
+  double totalKetWeight = 0.0;
+  for (std::size_t s3 = 0; s3 < shellPairs2.size(); ++s3) {
+    double rowWeight = 0.0;
+    for (std::size_t sp34 = 0; sp34 < shellPairs2[s3].size(); ++sp34) {
+      ketWeights[s3].push_back(pairWeight(basis2, s3, shellPairs2[s3][sp34]));
+      totalKetWeight += ketWeights[s3].back();
+      if (sp34 <= s3) {
+        rowWeight += ketWeights[s3].back();
+      }
+    }
+    rowWeightPrefix[s3 + 1] = rowWeightPrefix[s3] + rowWeight;
+  }
+
+  for (std::size_t s1 = 0; s1 < shellPairs1.size(); ++s1) {
+    double diagonalWeight = 0.0;
+    for (std::size_t sp12 = 0; sp12 < shellPairs1[s1].size(); ++sp12) {
+      const double braWeight = pairWeight(basis1, s1, shellPairs1[s1][sp12]);
+      double ketWeight = totalKetWeight;
+      if (isSymmetric) {
+        diagonalWeight += ketWeights[s1][sp12];
+        ketWeight = rowWeightPrefix[s1] + diagonalWeight;
+      }
+      braPairs_.emplace_back(s1, sp12);
+      costs_.push_back(braWeight * ketWeight);
+    }
+  }
+}
+
+void QuartetScheduler::buildShellWiseTasks() {
+  // A single queue, all threads take from it in order.
+  auto& tasks = queues_.front().tasks;
+  std::size_t first = 0;
+  for (std::size_t p = 1; p <= braPairs_.size(); ++p) {
+    if (p == braPairs_.size() || braPairs_[p].first != braPairs_[first].first) {
+      tasks.push_back({first, p});
+      first = p;
+    }
+  }
+}
+
+void QuartetScheduler::buildCostBalancedTasks(int tasksPerThread) {
+  const double totalCost = std::accumulate(costs_.begin(), costs_.end(), 0.0);
+  const double targetCost = totalCost / static_cast<double>(queues_.size() * tasksPerThread);
+
+  // Consecutive bra pairs share s1 and therefore their shells, keep them together.
+  std::vector<std::pair<double, Task>> tasks;
+  std::size_t first = 0;
+  double cost = 0.0;
+  for (std::size_t p = 0; p < braPairs_.size(); ++p) {
+    cost += costs_[p];
+    if (cost >= targetCost || p + 1 == braPairs_.size()) {
+      tasks.push_back({cost, {first, p + 1}});
+      first = p + 1;
+      cost = 0.0;
+    }
+  }
+
+  // Longest processing time first: the most expensive task goes to the least loaded queue.
+  std::stable_sort(tasks.begin(), tasks.end(),
+                   [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+  std::vector<double> load(queues_.size(), 0.0);
+  for (auto const& task : tasks) {
+    const auto queue = std::distance(load.begin(), std::min_element(load.begin(), load.end()));
+    load[queue] += task.first;
+    queues_[queue].tasks.push_back(task.second);
+  }
+}
+
+auto QuartetScheduler::nextTask(int thread, Task& task) -> bool {
+  const auto numberOfQueues = queues_.size();
+  for (std::size_t i = 0; i < numberOfQueues; ++i) {
+    auto& queue = queues_[(thread + i) % numberOfQueues];
+    if (queue.next.load(std::memory_order_relaxed) >= queue.tasks.size()) {
+      continue;
+    }
+    const auto index = queue.next.fetch_add(1, std::memory_order_relaxed);
+    if (index < queue.tasks.size()) {
+      task = queue.tasks[index];
+      return true;
+    }
+  }
+  return false;
+}
+
+auto QuartetScheduler::recordBusyTime(int thread, double seconds, std::size_t numberOfTasks) -> void {
+  statistics_.busyTime.at(thread) = seconds;
+  statistics_.numberOfTasks.at(thread) = numberOfTasks;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_QUARTETSCHEDULER_H
+#define INTEGRALEVALUATOR_QUARTETSCHEDULER_H
+
+#include <Utils/DataStructures/BasisSet.h>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Scine {
+namespace Integrals {
+namespace TwoBody {
+
+/**
+ * @brief How the shell quartets are distributed among the threads.
+ */
+enum class SchedulingPolicy {
+  //! One task per bra shell s1, handed out in order (equivalent to an OpenMP dynamic schedule over s1).
+  shellWise,
+  //! Tasks of roughly equal estimated cost, balanced among per-thread queues with work stealing.
+  costBalanced
+};
+
+/**
+ * @brief Per-thread timings of an integral evaluation.
+ */
+struct SchedulingStatistics {
+  //! Time in seconds every thread spent in its tasks.
+  std::vector<double> busyTime;
+  //! Number of tasks every thread executed.
+  std::vector<std::size_t> numberOfTasks;
+  /**
+   * @brief Ratio of the largest to the mean busy time, 1 for a perfectly balanced evaluation.
+   */
+  auto imbalance() const -> double;
+};
+
+/**
+ * @class QuartetScheduler @file QuartetScheduler.h
+ * @brief Splits the shell-quartet space of a two-body evaluation into tasks and hands them out to the threads.
+ *
+ * The unit of work is a bra shell pair (s1, sp12) together with all ket shell pairs it is combined with. Its cost is
+ * estimated as the product of the bra pair weight and the summed weights of the ket pairs, where the weight of a
+ * shell pair is its number of primitive pairs times its number of basis-function pairs. This accounts for the
+ * triangular loops, the angular momenta and the contraction depths.
+ *
+ * With SchedulingPolicy::costBalanced, consecutive units are merged into tasks of about equal cost, the tasks are
+ * sorted by decreasing cost and assigned greedily to per-thread queues. A thread that emptied its own queue steals
+ * the remaining tasks of the others.
+ */
+class QuartetScheduler {
+ public:
+  //! The bra pairs [firstBraPair, lastBraPair) of braPairs().
+  struct Task {
+    std::size_t firstBraPair;
+    std::size_t lastBraPair;
+  };
+
+  /**
+   * @brief Constructor.
+   * @param basis1 The bra basis, the shell pairs must have been generated.
+   * @param basis2 The ket basis, the shell pairs must have been generated.
+   * @param policy How the tasks are built and distributed.
+   * @param numberOfThreads The maximal number of threads taking part in the evaluation.
+   * @param tasksPerThread The number of tasks per thread aimed at by the cost-balanced policy.
+   */
+  QuartetScheduler(const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2,
+                   SchedulingPolicy policy, int numberOfThreads, int tasksPerThread = 8);
+
+  /**
+   * @brief All bra pairs as (s1, index of the pair in the shell-pair list of s1).
+   */
+  auto braPairs() const -> const std::vector<std::pair<std::size_t, std::size_t>>& {
+    return braPairs_;
+  }
+
+  /**
+   * @brief Fetches the next task of `thread`, stealing from the other threads if its own queue is empty.
+   * Thread-safe.
+   * @return false if no task is left.
+   */
+  auto nextTask(int thread, Task& task) -> bool;
+
+  /**
+   * @brief Records the time `thread` spent in its tasks. Must be called by every thread once it ran out of tasks.
+   */
+  auto recordBusyTime(int thread, double seconds, std::size_t numberOfTasks) -> void;
+
+  auto getStatistics() const -> const SchedulingStatistics& {
+    return statistics_;
+  }
+
+  /**
+   * @brief The estimated cost of every bra pair, in the order of braPairs().
+   */
+  auto getEstimatedCosts() const -> const std::vector<double>& {
+    return costs_;
+  }
+
+  /**
+   * @brief The weight of the shell pair `pair` of shell s1: its number of primitive pairs times its number of
+   * basis-function pairs.
+   */
+  static auto pairWeight(const Utils::Integrals::BasisSet& basis, std::size_t s1,
+                         const Utils::Integrals::ShellPairData& pair) -> double;
+
+ private:
+  struct alignas(64) Queue {
+    std::vector<Task> tasks;
+    std::atomic<std::size_t> next{0};
+  };
+
+  void estimateCosts(const Utils::Integrals::BasisSet& basis1, const Utils::Integrals::BasisSet& basis2);
+  void buildShellWiseTasks();
+  void buildCostBalancedTasks(int tasksPerThread);
+
+  std::vector<std::pair<std::size_t, std::size_t>> braPairs_;
+  std::vector<double> costs_;
+  std::vector<Queue> queues_;
+  SchedulingStatistics statistics_;
+};
+
+} // namespace TwoBody
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_QUARTETSCHEDULER_H
@@ -4,6 +4,7 @@
  *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
  *            See LICENSE.txt for details.
  */
+#include <LibintIntegrals/Libint.h>
 #include <LibintIntegrals/TwoBodyIntegrals/SaverDigester.h>
 #include <LibintIntegrals/TwoBodyIntegrals/SymmetryHelper.h>
 
@@ -16,54 +17,29 @@ namespace Scine {
 namespace Integrals {
 namespace TwoBody {
 
-template<>
-void SaverDigester<IntegralSymmetry::eightfold>::digestImpl(double integralValue, int i, int j, int k, int l, int index,
-                                                            double degeneracy) {
+template<IntegralSymmetry symmetry>
+void SaverDigester<symmetry>::digestImpl(double integralValue, int i, int j, int k, int l, int index,
+                                         double degeneracy) {
   UNUSED(degeneracy);
 
   auto& ptr_data = resultPtr_[index];
 
   integralValue *= this->scaling_;
 
-  auto ij = i * dim1_ + j;
-  auto ji = j * dim1_ + i;
-  auto kl = k * dim2_ + l;
-  auto lk = l * dim2_ + k;
-
-  // 4-fold symmetry
-  // ij,kl = ij,lk = ji,kl = ji,lk
-  ptr_data[ij + dim1sq_ * (kl)] = integralValue;
-  ptr_data[ij + dim1sq_ * (lk)] = integralValue;
-  ptr_data[ji + dim1sq_ * (kl)] = integralValue;
-  ptr_data[ji + dim1sq_ * (lk)] = integralValue;
-  // 8-fold symmetry:
-  // kl,ij  = lk,ji = lk,ij  = kl,ji
-  ptr_data[kl + dim1sq_ * (ij)] = integralValue;
-  ptr_data[kl + dim1sq_ * (ji)] = integralValue;
-  ptr_data[lk + dim1sq_ * (ij)] = integralValue;
-  ptr_data[lk + dim1sq_ * (ji)] = integralValue;
+  // Only the symmetry-unique element is written here, the others are filled by finalizeImpl().
+  const auto mapped = getMappedIndex<symmetry>({i, j, k, l});
+  ptr_data[mapped[0] * this->dim1_ + mapped[1] + this->dim1sq_ * (mapped[2] * this->dim2_ + mapped[3])] = integralValue;
 }
 
-template<>
-void SaverDigester<IntegralSymmetry::fourfold>::digestImpl(double integralValue, int i, int j, int k, int l, int index,
-                                                           double degeneracy) {
-  UNUSED(degeneracy);
-
-  auto& ptr_data = resultPtr_[index];
-
-  integralValue *= this->scaling_;
-
-  // 4-fold symmetry
-  // ij,kl = ij,lk = ji,kl = ji,lk
-  ptr_data[i * dim1_ + j + dim1sq_ * (k * dim2_ + l)] = integralValue;
-  ptr_data[i * dim1_ + j + dim1sq_ * (l * dim2_ + k)] = integralValue;
-  ptr_data[j * dim1_ + i + dim1sq_ * (k * dim2_ + l)] = integralValue;
-  ptr_data[j * dim1_ + i + dim1sq_ * (l * dim2_ + k)] = integralValue;
+template<IntegralSymmetry symmetry>
+const IntegralTensor& SaverDigester<symmetry>::getResultImpl() const {
+  return result_;
 }
 
 template<IntegralSymmetry symmetry>
-const IntegralEvaluatorMap& SaverDigester<symmetry>::getResultImpl() const {
-  return result_;
+IntegralTensor SaverDigester<symmetry>::takeResultImpl() {
+  resultPtr_.clear();
+  return std::move(result_);
 }
 
 template<IntegralSymmetry symmetry>
@@ -77,18 +53,43 @@ double SaverDigester<symmetry>::computeDegeneracyImpl(int shell1, int shell2, in
 
 template<IntegralSymmetry symmetry>
 void SaverDigester<symmetry>::initializeImpl(int numberThreads) {
-  // Parallelizing the SaverDigester will not be beneficial.
+  // The threads write to the shared tensor, no thread-local data is needed.
   UNUSED(numberThreads);
 }
 
 template<IntegralSymmetry symmetry>
 void SaverDigester<symmetry>::finalizeImpl() {
+  const auto dim1 = static_cast<int>(this->dim1_);
+  const auto dim2 = static_cast<int>(this->dim2_);
+  const auto dim1sq = this->dim1sq_;
+  const auto dim2sq = this->dim2sq_;
+  // The columns of all matrices are distributed statically in memory order, like the first touch of the tensor, such
+  // that every thread mostly writes its own pages. Symmetry-unique elements are only read, hence there is no race.
+  const auto numberOfColumns = resultPtr_.size() * dim2sq;
+#pragma omp parallel for schedule(static) num_threads(Libint::getNumberOfThreads())
+  for (std::size_t matrixColumn = 0; matrixColumn < numberOfColumns; ++matrixColumn) {
+    double* data = resultPtr_[matrixColumn / dim2sq];
+    const auto kl = static_cast<int>(matrixColumn % dim2sq);
+    const int k = kl / dim2;
+    const int l = kl % dim2;
+    double* column = data + dim1sq * kl;
+    for (int i = 0; i < dim1; ++i) {
+      for (int j = 0; j < dim1; ++j) {
+        const IndexType<4> index = {i, j, k, l};
+        const auto mapped = getMappedIndex<symmetry>(index);
+        if (mapped != index) {
+          column[i * dim1 + j] = data[mapped[0] * dim1 + mapped[1] + dim1sq * (mapped[2] * dim2 + mapped[3])];
+        }
+      }
+    }
+  }
 }
 
 template<IntegralSymmetry symmetry>
 SaverDigester<symmetry>::SaverDigester(const Utils::Integrals::BasisSet& scineBasis1,
                                        const Utils::Integrals::BasisSet& scineBasis2,
-                                       const Utils::Integrals::IntegralSpecifier& specifier)
+                                       const Utils::Integrals::IntegralSpecifier& specifier,
+                                       TensorPlacement placement)
   : Digester<SaverDigester<symmetry>>(scineBasis1, scineBasis2, specifier) {
   static_assert(symmetry == IntegralSymmetry::eightfold || symmetry == IntegralSymmetry::fourfold,
                 "Symmetry must be either 4- or 8-fold.");
@@ -96,20 +97,15 @@ SaverDigester<symmetry>::SaverDigester(const Utils::Integrals::BasisSet& scineBa
   if (specifier.typeVector.size() == 2) {
     this->scaling_ = specifier.typeVector[0].charge * specifier.typeVector[1].charge;
   }
-  for (int center = 0; center < this->numberOfCenters_; ++center) {
-    if (this->specifier_.derivOrder == 0) {
-      result_[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, center}] =
-          Eigen::MatrixXd::Zero(this->dim1_ * this->dim1_, this->dim2_ * this->dim2_);
-      resultPtr_.push_back(result_[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, center}].data());
-    }
-    else {
-      for (auto const& derivKey :
-           {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y, Utils::Integrals::DerivKey::z}) {
-        result_[{Utils::Integrals::Component::none, derivKey, center}] =
-            Eigen::MatrixXd::Zero(this->dim1_ * this->dim1_, this->dim2_ * this->dim2_);
-        resultPtr_.push_back(result_[{Utils::Integrals::Component::none, derivKey, center}].data());
-      }
-    }
+  std::vector<Utils::Integrals::DerivKey> derivKeys = {Utils::Integrals::DerivKey::value};
+  if (this->specifier_.derivOrder != 0) {
+    derivKeys = {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y, Utils::Integrals::DerivKey::z};
+  }
+  result_ = IntegralTensor({Utils::Integrals::Component::none}, this->numberOfCenters_, derivKeys,
+                                 this->dim1_ * this->dim1_, this->dim2_ * this->dim2_, placement);
+  // The digester index is center * numberOfDerivKeys + derivKey, i.e. the position in the result tensor.
+  for (std::size_t index = 0; index < result_.size(); ++index) {
+    resultPtr_.push_back(result_.data(index));
   }
 }
 
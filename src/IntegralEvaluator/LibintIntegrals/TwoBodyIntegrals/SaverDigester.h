@@ -17,23 +17,33 @@ namespace Scine {
 namespace Integrals {
 namespace TwoBody {
 
+/**
+ * @class SaverDigester @file SaverDigester.h
+ * @brief Stores the two-body integrals as a dim1^2 x dim2^2 tensor.
+ *
+ * The tensor is placed in memory by all threads (see TensorPlacement). While the integrals are evaluated, only the
+ * symmetry-unique element of every quartet is written. The symmetric copies are filled in finalize(), where every
+ * thread writes the columns whose pages it touched first, i.e. node-local memory.
+ */
 template<IntegralSymmetry symmetry>
 class SaverDigester : public Digester<SaverDigester<symmetry>> {
  public:
   SaverDigester(const Utils::Integrals::BasisSet& scineBasis1, const Utils::Integrals::BasisSet& scineBasis2,
-                const Utils::Integrals::IntegralSpecifier& specifier);
+                const Utils::Integrals::IntegralSpecifier& specifier,
+                TensorPlacement placement = TensorPlacement::parallelFirstTouch);
 
   void digestImpl(double integralValue, int basisFunction1, int basisFunction2, int basisFunction3, int basisFunction4,
                   int index, double degeneracy);
 
   double computeDegeneracyImpl(int shell1, int shell2, int shell3, int shell4);
 
-  const IntegralEvaluatorMap& getResultImpl() const;
+  const IntegralTensor& getResultImpl() const;
+  IntegralTensor takeResultImpl();
   void initializeImpl(int numberThreads);
   void finalizeImpl();
 
  private:
-  IntegralEvaluatorMap result_;
+  IntegralTensor result_;
   std::vector<double*> resultPtr_;
 };
 
@@ -8,7 +8,9 @@
 #define INTEGRALEVALUATOR_SYMMETRYHELPER_H
 
 #include <array>
-#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
 
 #define UNUSED(expr) \
   do {               \
@@ -24,6 +26,61 @@ using IndexType = std::array<int, rank>;
 
 enum class IntegralSymmetry { onefold, twofold, fourfold, eightfold };
 
+/**
+ * @brief The largest number of index quartets related by the given symmetry.
+ */
+constexpr std::size_t maximalDegeneracy(IntegralSymmetry symmetry) {
+  switch (symmetry) {
+    case IntegralSymmetry::onefold:
+      return 1;
+    case IntegralSymmetry::twofold:
+      return 2;
+    case IntegralSymmetry::fourfold:
+      return 4;
+    default:
+      return 8;
+  }
+}
+
+/**
+ * @class SymmetricIndices @file SymmetryHelper.h
+ * @brief Fixed-capacity container of the index quartets related by symmetry.
+ * It lives on the stack, such that expanding an index quartet never allocates.
+ * @tparam capacity The largest number of index quartets, see maximalDegeneracy().
+ */
+template<std::size_t capacity>
+class SymmetricIndices {
+ public:
+  SymmetricIndices() = default;
+  SymmetricIndices(std::initializer_list<IndexType<4>> indices) {
+    for (const auto& index : indices) {
+      push_back(index);
+    }
+  }
+
+  void push_back(const IndexType<4>& index) {
+    assert(size_ < capacity);
+    indices_[size_++] = index;
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+  const IndexType<4>& operator[](std::size_t i) const {
+    return indices_[i];
+  }
+  const IndexType<4>* begin() const {
+    return indices_.data();
+  }
+  const IndexType<4>* end() const {
+    return indices_.data() + size_;
+  }
+
+ private:
+  std::array<IndexType<4>, capacity> indices_;
+  std::size_t size_ = 0;
+};
+
 /**
  * @brief Function to get the degeneracy of a index quartet with some symmetry.
  * @tparam symmetry The symmetry. Can be onefold (no symmetry), twofold, fourfold or eightfold.
@@ -49,15 +106,15 @@ IndexType<4> getMappedIndex(IndexType<4> index);
  * @brief Returns a pack of indices related by symmetry to the input one.
  * @tparam symmetry The Eri symmetry.
  * @param index The symmetrized index.
- * @return A vector containing the indices related by symmetry to the input one.
+ * @return A fixed-capacity container with the indices related by symmetry to the input one.
  */
 template<IntegralSymmetry symmetry>
-inline std::vector<IndexType<4>> getSymmetricIndices(IndexType<4> index);
+inline SymmetricIndices<maximalDegeneracy(symmetry)> getSymmetricIndices(IndexType<4> index);
 
 /**
  * @brief one-to-one mapping of the symmetrized index to itself.
  * @param index the symmetrized index.
- * @return A vector containing the same index.
+ * @return A container holding the same index.
  * Since there is no symmetry in onefold symmetrized ERIs,
  * the return value is the same as the input one.
  * Example:
@@ -65,14 +122,14 @@ inline std::vector<IndexType<4>> getSymmetricIndices(IndexType<4> index);
  * Indices:           3210
  */
 template<>
-inline std::vector<IndexType<4>> getSymmetricIndices<IntegralSymmetry::onefold>(IndexType<4> index) {
+inline SymmetricIndices<1> getSymmetricIndices<IntegralSymmetry::onefold>(IndexType<4> index) {
   return {index};
 }
 
 /**
  * @brief one-to-many mapping of the symmetrized index to the actual ones.
  * @param index the symmetrized index.
- * @return A vector containing all the indices that are symmetric to the input one.
+ * @return A container holding all the indices that are symmetric to the input one.
  * Example:
  * Symmetrized index: 3210
  * Indices:           3210 1032
@@ -80,7 +137,7 @@ inline std::vector<IndexType<4>> getSymmetricIndices<IntegralSymmetry::onefold>(
  * Indices:           2100 0021
  */
 template<>
-inline std::vector<IndexType<4>> getSymmetricIndices<IntegralSymmetry::twofold>(IndexType<4> index) {
+inline SymmetricIndices<2> getSymmetricIndices<IntegralSymmetry::twofold>(IndexType<4> index) {
   if (index[0] != index[2] || index[1] != index[3]) {
     return {index, {index[2], index[3], index[0], index[1]}};
   }
@@ -90,7 +147,7 @@ inline std::vector<IndexType<4>> getSymmetricIndices<IntegralSymmetry::twofold>(
 /**
  * @brief one-to-many mapping of the symmetrized index to the actual ones.
  * @param index the symmetrized index.
- * @return A vector containing all the indices that are symmetric to the input one.
+ * @return A container holding all the indices that are symmetric to the input one.
  * Example:
  * Symmetrized  index: 3210
  * Indices:            3210 3201 2310 2301
@@ -98,9 +155,8 @@ inline std::vector<IndexType<4>> getSymmetricIndices<IntegralSymmetry::twofold>(
  * Indices:            2100 1200
  */
 template<>
-inline std::vector<IndexType<4>> getSymmetricIndices<IntegralSymmetry::fourfold>(IndexType<4> index) {
-  std::vector<IndexType<4>> result;
-  result.reserve(4);
+inline SymmetricIndices<4> getSymmetricIndices<IntegralSymmetry::fourfold>(IndexType<4> index) {
+  SymmetricIndices<4> result;
   result.push_back(index);
   if (index[0] != index[1]) {
     result.push_back({index[1], index[0], index[2], index[3]});
@@ -116,7 +172,7 @@ inline std::vector<IndexType<4>> getSymmetricIndices<IntegralSymmetry::fourfold>
 /**
  * @brief one-to-many mapping of the symmetrized index to the actual ones.
  * @param index the symmetrized index.
- * @return A vector containing all the indices that are symmetric to the input one.
+ * @return A container holding all the indices that are symmetric to the input one.
  * Example:
  * Symmetrized index: 3210
  * Indices:           3210 3201 2310 2301 1032 0132 1023 0123
@@ -130,38 +186,37 @@ inline std::vector<IndexType<4>> getSymmetricIndices<IntegralSymmetry::fourfold>
  * Indices:           0000
  */
 template<>
-inline std::vector<IndexType<4>> getSymmetricIndices<IntegralSymmetry::eightfold>(IndexType<4> index) {
-  std::vector<IndexType<4>> result;
-  result.reserve(8);
+inline SymmetricIndices<8> getSymmetricIndices<IntegralSymmetry::eightfold>(IndexType<4> index) {
+  SymmetricIndices<8> result;
   result.push_back(index);
 
   if (!(index[0] == index[1] && index[0] == index[2] && index[0] == index[3])) {
     if (index[0] == index[1] && index[2] == index[3]) { // 1100
-      result.emplace_back(IndexType<4>{index[2], index[2], index[0], index[0]});
+      result.push_back(IndexType<4>{index[2], index[2], index[0], index[0]});
     }
     else if (index[0] == index[1] && index[2] != index[3]) { // 1110
-      result.emplace_back(IndexType<4>{index[0], index[0], index[3], index[2]});
-      result.emplace_back(IndexType<4>{index[2], index[3], index[0], index[0]});
-      result.emplace_back(IndexType<4>{index[3], index[2], index[0], index[0]});
+      result.push_back(IndexType<4>{index[0], index[0], index[3], index[2]});
+      result.push_back(IndexType<4>{index[2], index[3], index[0], index[0]});
+      result.push_back(IndexType<4>{index[3], index[2], index[0], index[0]});
     }
     else if (index[2] == index[3] && index[0] != index[1]) { // 2100
-      result.emplace_back(IndexType<4>{index[1], index[0], index[2], index[2]});
-      result.emplace_back(IndexType<4>{index[2], index[2], index[0], index[1]});
-      result.emplace_back(IndexType<4>{index[2], index[2], index[1], index[0]});
+      result.push_back(IndexType<4>{index[1], index[0], index[2], index[2]});
+      result.push_back(IndexType<4>{index[2], index[2], index[0], index[1]});
+      result.push_back(IndexType<4>{index[2], index[2], index[1], index[0]});
     }
     else if (index[0] == index[2] && index[1] == index[3] && index[0] != index[1]) { // 3232
-      result.emplace_back(IndexType<4>{index[1], index[0], index[2], index[3]});
-      result.emplace_back(IndexType<4>{index[0], index[1], index[3], index[2]});
-      result.emplace_back(IndexType<4>{index[1], index[0], index[3], index[2]});
+      result.push_back(IndexType<4>{index[1], index[0], index[2], index[3]});
+      result.push_back(IndexType<4>{index[0], index[1], index[3], index[2]});
+      result.push_back(IndexType<4>{index[1], index[0], index[3], index[2]});
     }
     else if (index[0] != index[1] && index[2] != index[3] && index[0] != index[3]) { // 3210
-      result.emplace_back(IndexType<4>{index[1], index[0], index[2], index[3]});
-      result.emplace_back(IndexType<4>{index[0], index[1], index[3], index[2]});
-      result.emplace_back(IndexType<4>{index[1], index[0], index[3], index[2]});
-      result.emplace_back(IndexType<4>{index[2], index[3], index[0], index[1]});
-      result.emplace_back(IndexType<4>{index[2], index[3], index[1], index[0]});
-      result.emplace_back(IndexType<4>{index[3], index[2], index[0], index[1]});
-      result.emplace_back(IndexType<4>{index[3], index[2], index[1], index[0]});
+      result.push_back(IndexType<4>{index[1], index[0], index[2], index[3]});
+      result.push_back(IndexType<4>{index[0], index[1], index[3], index[2]});
+      result.push_back(IndexType<4>{index[1], index[0], index[3], index[2]});
+      result.push_back(IndexType<4>{index[2], index[3], index[0], index[1]});
+      result.push_back(IndexType<4>{index[2], index[3], index[1], index[0]});
+      result.push_back(IndexType<4>{index[3], index[2], index[0], index[1]});
+      result.push_back(IndexType<4>{index[3], index[2], index[1], index[0]});
     }
   }
   return result;
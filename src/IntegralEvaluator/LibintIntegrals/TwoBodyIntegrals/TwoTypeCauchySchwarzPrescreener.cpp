@@ -0,0 +1,53 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/TwoBodyIntegrals/TwoTypeCauchySchwarzPrescreener.h>
+#include <Utils/DataStructures/BasisSet.h>
+#include <Utils/DataStructures/DensityMatrix.h>
+
+using namespace Scine;
+using namespace Integrals;
+using namespace TwoBody;
+
+auto TwoTypeCauchySchwarzPrescreener::shellBlockMaxima(const Utils::Integrals::BasisSet& basis,
+                                                       const Eigen::MatrixXd& density) -> Eigen::MatrixXd {
+  auto const& s2bf = basis.shell2bf();
+  Eigen::MatrixXd maxima(basis.size(), basis.size());
+  for (auto shell1 = 0UL; shell1 < basis.size(); ++shell1) {
+    for (auto shell2 = 0UL; shell2 <= shell1; ++shell2) {
+      maxima(shell1, shell2) =
+          density.block(s2bf[shell1], s2bf[shell2], basis[shell1].size(), basis[shell2].size()).cwiseAbs().maxCoeff();
+    }
+  }
+  return maxima.selfadjointView<Eigen::Lower>();
+}
+
+TwoTypeCauchySchwarzPrescreener::TwoTypeCauchySchwarzPrescreener(const Utils::Integrals::BasisSet& basisSet1,
+                                                                 const Utils::Integrals::BasisSet& basisSet2,
+                                                                 const Utils::DensityMatrix& densityMatrix1,
+                                                                 const Utils::DensityMatrix& densityMatrix2,
+                                                                 double prescreenThreshold)
+  : TwoBodiesIntegralsPrescreener<TwoTypeCauchySchwarzPrescreener>(basisSet1, prescreenThreshold),
+    hasCauchySchwarzFactors_(basisSet1.getShellPairs()->hasCauchySchwarzFactor() &&
+                             basisSet2.getShellPairs()->hasCauchySchwarzFactor()),
+    densityMatrix1ShellBlockMaxima_(shellBlockMaxima(basisSet1, densityMatrix1.restrictedMatrix())),
+    densityMatrix2ShellBlockMaxima_(shellBlockMaxima(basisSet2, densityMatrix2.restrictedMatrix())) {
+  densityMaximum_ = std::max(densityMatrix1ShellBlockMaxima_.maxCoeff(), densityMatrix2ShellBlockMaxima_.maxCoeff());
+}
+
+bool TwoTypeCauchySchwarzPrescreener::isSignificantImpl(int shell1, int shell2, int shell3, int shell4,
+                                                        double cauchySchwarzFactor) const {
+  if (!hasCauchySchwarzFactors_) {
+    return true;
+  }
+  if (std::abs(densityMaximum_ * cauchySchwarzFactor) < prescreeningThreshold_) {
+    return false;
+  }
+  const double maxDensityShellBlock =
+      std::max(densityMatrix1ShellBlockMaxima_(shell1, shell2), densityMatrix2ShellBlockMaxima_(shell3, shell4));
+  return (std::abs(maxDensityShellBlock * cauchySchwarzFactor) > prescreeningThreshold_);
+}
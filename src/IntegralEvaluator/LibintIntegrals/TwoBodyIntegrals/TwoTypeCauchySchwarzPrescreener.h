@@ -0,0 +1,54 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef INTEGRALEVALUATOR_TWOTYPECAUCHYSCHWARZPRESCREENER_H
+#define INTEGRALEVALUATOR_TWOTYPECAUCHYSCHWARZPRESCREENER_H
+
+#include <LibintIntegrals/TwoBodyIntegrals/Prescreener.h>
+#include <Eigen/Core>
+
+namespace Scine {
+namespace Integrals {
+namespace TwoBody {
+
+/**
+ * @class TwoTypeCauchySchwarzPrescreener @file TwoTypeCauchySchwarzPrescreener.h
+ * @brief Cauchy-Schwarz prescreener for the Coulomb interaction of two particle types, see TwoTypeCoulombDigester.
+ *
+ * The quartet (12|34) contributes (12|34) D2(34) to the Coulomb matrix of the first type and (12|34) D1(12) to the
+ * one of the second type. It is therefore skipped if
+ * \f$ \sqrt{(12|12)} \sqrt{(34|34)} \max(|D1_{12}|, |D2_{34}|) \f$ is below the threshold, where the density
+ * maxima are taken over the shell blocks. The Schwarz factors of both bases' shell pairs must have been calculated,
+ * otherwise no quartet is skipped.
+ */
+class TwoTypeCauchySchwarzPrescreener : public TwoBodiesIntegralsPrescreener<TwoTypeCauchySchwarzPrescreener> {
+ public:
+  TwoTypeCauchySchwarzPrescreener(const Utils::Integrals::BasisSet& basisSet1,
+                                  const Utils::Integrals::BasisSet& basisSet2,
+                                  const Utils::DensityMatrix& densityMatrix1,
+                                  const Utils::DensityMatrix& densityMatrix2, double prescreenThreshold = 1e-12);
+
+  bool isSignificantImpl(int shell1, int shell2, int shell3, int shell4, double cauchySchwarzFactor) const;
+
+  /**
+   * @brief The largest absolute element of every shell block of a symmetric density matrix.
+   */
+  static auto shellBlockMaxima(const Utils::Integrals::BasisSet& basis, const Eigen::MatrixXd& density)
+      -> Eigen::MatrixXd;
+
+ private:
+  bool hasCauchySchwarzFactors_;
+  Eigen::MatrixXd densityMatrix1ShellBlockMaxima_;
+  Eigen::MatrixXd densityMatrix2ShellBlockMaxima_;
+  double densityMaximum_{};
+};
+
+} // namespace TwoBody
+} // namespace Integrals
+} // namespace Scine
+
+#endif // INTEGRALEVALUATOR_TWOTYPECAUCHYSCHWARZPRESCREENER_H
@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+
+#include <LibintIntegrals/Libint.h>
+#include <LibintIntegrals/LibintIntegrals.h>
+#include <LibintIntegrals/TwoBodyIntegrals/Evaluator.h>
+#include <LibintIntegrals/TwoBodyIntegrals/SaverDigester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/SymmetryHelper.h>
+#include <Utils/IO/ChemicalFileFormats/XyzStreamHandler.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+/*
+ * Timings of the integral kernels. They are not part of the test suite since their results depend on the machine;
+ * build with optimizations and run the integralBenchmarks executable directly.
+ */
+
+using namespace Scine;
+using namespace Integrals;
+
+namespace {
+
+/**
+ * @brief Returns the shortest of several runs of a function in nanoseconds.
+ */
+template<class Function>
+auto minimumTime(int numberOfRuns, Function&& function) -> double {
+  double minimum = std::numeric_limits<double>::max();
+  for (int run = 0; run < numberOfRuns; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    minimum = std::min(minimum, elapsed.count());
+  }
+  return minimum;
+}
+
+/**
+ * @brief Per-quartet cost of the eightfold symmetric index expansion, with the heap-allocated vector that
+ *        getSymmetricIndices returned before and with the fixed-capacity container it returns now.
+ */
+void symmetricIndexExpansion() {
+  using TwoBody::IndexType;
+  using TwoBody::IntegralSymmetry;
+  const int n = 48;
+  std::vector<IndexType<4>> quartets;
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      for (int k = 0; k <= i; ++k) {
+        for (int l = 0; l <= k; ++l) {
+          IndexType<4> index = {i, j, k, l};
+          if (TwoBody::getMappedIndex<IntegralSymmetry::eightfold>(index) == index) {
+            quartets.push_back(index);
+          }
+        }
+      }
+    }
+  }
+
+  long checksumVector = 0;
+  const double timeVector = minimumTime(5, [&]() {
+    for (const auto& index : quartets) {
+      const auto expanded = TwoBody::getSymmetricIndices<IntegralSymmetry::eightfold>(index);
+      for (const auto& symmetricIndex : std::vector<IndexType<4>>(expanded.begin(), expanded.end())) {
+        checksumVector += symmetricIndex[0];
+      }
+    }
+  });
+  long checksumStack = 0;
+  const double timeStack = minimumTime(5, [&]() {
+    for (const auto& index : quartets) {
+      for (const auto& symmetricIndex : TwoBody::getSymmetricIndices<IntegralSymmetry::eightfold>(index)) {
+        checksumStack += symmetricIndex[0];
+      }
+    }
+  });
+
+  const double numberOfQuartets = quartets.size();
+  std::cout << "Symmetric index expansion of " << quartets.size() << " quartets: " << timeVector / numberOfQuartets
+            << " ns per quartet with a vector, " << timeStack / numberOfQuartets
+            << " ns with a fixed-capacity container (checksums " << checksumVector << ", " << checksumStack << ")"
+            << std::endl;
+}
+
+/**
+ * @brief Time to compute and store the full Coulomb tensor with the pages of the tensor placed by the calling thread
+ *        or by all threads. The difference only shows on machines with several NUMA nodes.
+ */
+void tensorPlacement() {
+  std::stringstream ethane("8\n\n"
+                           "C  0.0000  0.0000  0.7650\n"
+                           "C  0.0000  0.0000 -0.7650\n"
+                           "H  1.0140  0.0000  1.1630\n"
+                           "H -0.5070  0.8782  1.1630\n"
+                           "H -0.5070 -0.8782  1.1630\n"
+                           "H -1.0140  0.0000 -1.1630\n"
+                           "H  0.5070  0.8782 -1.1630\n"
+                           "H  0.5070 -0.8782 -1.1630\n");
+  auto atoms = Utils::XyzStreamHandler::read(ethane);
+  LibintIntegrals eval;
+  auto basis = eval.initializeBasisSet("def2-svp", atoms);
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+
+  using Saver = TwoBody::SaverDigester<TwoBody::IntegralSymmetry::eightfold>;
+  auto timeTensor = [&](TensorPlacement placement) {
+    return minimumTime(3, [&]() {
+      auto evaluator = TwoBody::Evaluator<Saver>(basis, basis, specifier, Saver(basis, basis, specifier, placement),
+                                                 TwoBody::VoidPrescreener());
+      evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+    });
+  };
+  const double serial = timeTensor(TensorPlacement::serial);
+  const double firstTouch = timeTensor(TensorPlacement::parallelFirstTouch);
+  const double hugePages = timeTensor(TensorPlacement::parallelFirstTouchHugePages);
+  std::cout << "Coulomb tensor of " << basis.nbf() << " basis functions on " << Libint::getNumberOfThreads()
+            << " threads: " << serial * 1e-9 << " s with serial, " << firstTouch * 1e-9
+            << " s with parallel first-touch, " << hugePages * 1e-9 << " s with parallel first-touch and huge pages"
+            << std::endl;
+}
+
+} // namespace
+
+int main() {
+  symmetricIndexExpansion();
+  tensorPlacement();
+  return 0;
+}
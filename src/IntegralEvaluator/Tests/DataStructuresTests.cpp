@@ -6,9 +6,15 @@
  */
 
 #include <LibintIntegrals/BasisSetHandler.h>
+#include <LibintIntegrals/BasisSetLibrary.h>
+#include <LibintIntegrals/BasisSetSerializer.h>
+#include <LibintIntegrals/IntegralTensor.h>
 #include <LibintIntegrals/LibintIntegrals.h>
+#include <LibintIntegrals/PointChargeOctree.h>
 #include <Utils/Constants.h>
+#include <Utils/DataStructures/MolecularOrbitals.h>
 #include <Utils/IO/ChemicalFileFormats/XyzStreamHandler.h>
+#include <Utils/Scf/LcaoUtils/DensityMatrixBuilder.h>
 #include <Utils/Settings.h>
 #include <gmock/gmock.h>
 
@@ -23,6 +29,10 @@ class BasisSetHandlerTest : public Test {};
 
 class ShellPairTest : public Test {};
 
+class IntegralTensorTest : public Test {};
+
+class PointChargeOctreeTest : public Test {};
+
 TEST_F(BasisSetTest, shell2atom) {
   std::stringstream Ethanol("9\n\n"
                             "C    -4.0410150   -1.2118929   -0.0394793 \n"
@@ -137,6 +147,241 @@ TEST_F(ShellPairTest, CanAddAShellPair) {
   ASSERT_EQ(shellPairs[0].size(), 1);
 }
 
+TEST_F(ShellPairTest, GeneratedShellPairsMatchAddedPairs) {
+  std::stringstream h2o("3\n\n"
+                        "O  0.0 0.0 0.0\n"
+                        "H  0.9 0.1 0.0\n"
+                        "H -0.3 0.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(h2o);
+
+  LibintIntegrals eval;
+  auto scineBasis = eval.initializeBasisSet("def2-svp", scineAtoms);
+  auto shellPairs = scineBasis.getShellPairs();
+  ASSERT_EQ(shellPairs->size(), scineBasis.size());
+
+  for (std::size_t s1 = 0; s1 < scineBasis.size(); ++s1) {
+    const auto& pairs = shellPairs->at(s1);
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+      if (i > 0) {
+        ASSERT_LT(pairs[i - 1].secondShellIndex, pairs[i].secondShellIndex);
+      }
+      const auto s2 = pairs[i].secondShellIndex;
+      ASSERT_LE(s2, s1);
+      Utils::Integrals::ShellPair reference(scineBasis[s1]);
+      BasisSetHandler::addPair(reference, s2, scineBasis[s2]);
+      EXPECT_DOUBLE_EQ(pairs[i].cauchySchwarzFactor, reference[0].cauchySchwarzFactor);
+      EXPECT_EQ(pairs[i].precomputedShellPair->primpairs.size(), reference[0].precomputedShellPair->primpairs.size());
+    }
+  }
+}
+
+TEST_F(ShellPairTest, SpatialIndexKeepsAllOverlappingPairs) {
+  std::stringstream waters("9\n\n"
+                           "O   0.0 0.0 0.0\n"
+                           "H   0.9 0.1 0.0\n"
+                           "H  -0.3 0.8 0.0\n"
+                           "O  12.0 0.0 0.0\n"
+                           "H  12.9 0.1 0.0\n"
+                           "H  11.7 0.8 0.0\n"
+                           "O  24.0 3.0 0.0\n"
+                           "H  24.9 3.1 0.0\n"
+                           "H  23.7 3.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(waters);
+
+  LibintIntegrals eval;
+  auto scineBasis = eval.initializeBasisSet("def2-svp", scineAtoms, false);
+  const double threshold = 1e-12;
+  auto candidates = BasisSetHandler::shellPairCandidates(scineBasis, threshold);
+  ASSERT_EQ(candidates.size(), scineBasis.size());
+
+  auto engine = Libint::getEngine(scineBasis, libint2::Operator::overlap);
+  const auto& buffer = engine.results();
+  std::size_t numberOfCandidates = 0;
+  for (std::size_t s1 = 0; s1 < scineBasis.size(); ++s1) {
+    numberOfCandidates += candidates[s1].size();
+    for (std::size_t s2 = 0; s2 <= s1; ++s2) {
+      engine.compute(BasisSetHandler::scineToLibint(scineBasis[s1]), BasisSetHandler::scineToLibint(scineBasis[s2]));
+      const double norm =
+          Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>(buffer[0], scineBasis[s1].size(), scineBasis[s2].size())
+              .norm();
+      if (norm > threshold) {
+        EXPECT_TRUE(std::binary_search(candidates[s1].begin(), candidates[s1].end(), s2));
+      }
+    }
+  }
+  // The molecules are far apart, pairs between them are rejected without computing any overlap.
+  EXPECT_LT(numberOfCandidates, scineBasis.size() * (scineBasis.size() + 1) / 2);
+}
+
+TEST_F(ShellPairTest, SpatialIndexSearchesBeyondNeighbourCells) {
+  const double threshold = 1e-12;
+  // Compares the candidates with the O(N^2) list of all pairs whose overlap exceeds the threshold.
+  auto checkCandidates = [&](const Utils::Integrals::BasisSet& basis) -> std::size_t {
+    auto candidates = BasisSetHandler::shellPairCandidates(basis, threshold);
+    EXPECT_EQ(candidates.size(), basis.size());
+    auto engine = Libint::getEngine(basis, libint2::Operator::overlap);
+    const auto& buffer = engine.results();
+    std::size_t numberOfSignificantPairs = 0;
+    for (std::size_t s1 = 0; s1 < basis.size(); ++s1) {
+      for (std::size_t s2 = 0; s2 <= s1; ++s2) {
+        engine.compute(BasisSetHandler::scineToLibint(basis[s1]), BasisSetHandler::scineToLibint(basis[s2]));
+        const double norm = Eigen::Map<const Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>(
+                                buffer[0], basis[s1].size(), basis[s2].size())
+                                .norm();
+        if (norm > threshold) {
+          ++numberOfSignificantPairs;
+          EXPECT_TRUE(std::binary_search(candidates[s1].begin(), candidates[s1].end(), s2))
+              << "Overlapping shells " << s1 << " and " << s2 << " are no candidates.";
+        }
+      }
+    }
+    return numberOfSignificantPairs;
+  };
+
+  // Equally diffuse s shells along a line. The cell size is the extent of a single shell, but shells up to twice that
+  // distance apart are paired, i.e. many overlapping pairs are two cells apart.
+  Utils::Integrals::BasisSet diffuseShells;
+  for (int i = 0; i < 24; ++i) {
+    diffuseShells.emplace_back(std::vector<double>{0.05}, std::vector<double>{1.0},
+                               Utils::Displacement(3.5 * i, 0.0, 0.0), 0, false);
+  }
+  const auto numberOfDiffusePairs = checkCandidates(diffuseShells);
+  // Every shell overlaps with many more shells than its direct neighbours.
+  EXPECT_GT(numberOfDiffusePairs, 4 * diffuseShells.size());
+
+  // A spread-out chain of water molecules, the most diffuse shells determine the cell size.
+  std::stringstream xyz;
+  const int numberOfMolecules = 8;
+  xyz << 3 * numberOfMolecules << "\n\n";
+  for (int i = 0; i < numberOfMolecules; ++i) {
+    const double x = 3.1 * i;
+    xyz << "O " << x << " 0.0 0.0\nH " << x + 0.9 << " 0.1 0.0\nH " << x - 0.3 << " 0.8 0.0\n";
+  }
+  auto scineAtoms = Utils::XyzStreamHandler::read(xyz);
+  LibintIntegrals eval;
+  auto chain = eval.initializeBasisSet("def2-svp", scineAtoms, false);
+  checkCandidates(chain);
+}
+
+TEST_F(ShellPairTest, MovedBasisSetMatchesRegeneratedBasisSet) {
+  std::stringstream h2o("3\n\n"
+                        "O  0.0 0.0 0.0\n"
+                        "H  0.9 0.1 0.0\n"
+                        "H -0.3 0.8 0.0");
+  auto oldAtoms = Utils::XyzStreamHandler::read(h2o);
+  auto newAtoms = oldAtoms;
+  newAtoms.setPosition(1, oldAtoms.getPosition(1) + Utils::Position(0.02, -0.01, 0.03));
+
+  LibintIntegrals eval;
+  auto oldBasis = eval.initializeBasisSet("def2-svp", oldAtoms);
+  auto reference = eval.initializeBasisSet("def2-svp", newAtoms);
+
+  for (double tolerance : {1.0, 0.0}) {
+    auto newBasis = BasisSetHandler::moveBasisSet(oldBasis, oldAtoms, newAtoms, tolerance);
+    ASSERT_EQ(newBasis.size(), reference.size());
+    ASSERT_TRUE(newBasis.areShellPairsEvaluated());
+    for (std::size_t s1 = 0; s1 < reference.size(); ++s1) {
+      ASSERT_TRUE(newBasis[s1].getShift().isApprox(reference[s1].getShift()));
+      const auto& pairs = newBasis.getShellPairs()->at(s1);
+      const auto& referencePairs = reference.getShellPairs()->at(s1);
+      ASSERT_EQ(pairs.size(), referencePairs.size());
+      for (std::size_t i = 0; i < pairs.size(); ++i) {
+        EXPECT_EQ(pairs[i].secondShellIndex, referencePairs[i].secondShellIndex);
+        EXPECT_THAT(pairs[i].cauchySchwarzFactor, DoubleNear(referencePairs[i].cauchySchwarzFactor, 1e-12));
+      }
+    }
+  }
+}
+
+TEST_F(ShellPairTest, MovedBasisSetKeepsPairTopology) {
+  std::stringstream waters("6\n\n"
+                           "O  0.0 0.0 0.0\n"
+                           "H  0.9 0.1 0.0\n"
+                           "H -0.3 0.8 0.0\n"
+                           "O  7.0 0.0 0.0\n"
+                           "H  7.9 0.1 0.0\n"
+                           "H  6.7 0.8 0.0");
+  auto oldAtoms = Utils::XyzStreamHandler::read(waters);
+  LibintIntegrals eval;
+  auto oldBasis = eval.initializeBasisSet("def2-svp", oldAtoms);
+  const auto& oldPairs = *oldBasis.getShellPairs();
+
+  // A rigid translation keeps every pair and every Schwarz factor, only the primitive data move along.
+  const Utils::Displacement translation(0.05, 0.02, -0.03);
+  auto newAtoms = oldAtoms;
+  for (int atom = 0; atom < oldAtoms.size(); ++atom) {
+    newAtoms.setPosition(atom, oldAtoms.getPosition(atom) + translation);
+  }
+  auto newBasis = LibintIntegrals::moveBasisSet(oldBasis, oldAtoms, newAtoms, 0.1);
+  const auto& newPairs = *newBasis.getShellPairs();
+  ASSERT_EQ(newPairs.size(), oldPairs.size());
+  for (std::size_t s1 = 0; s1 < oldPairs.size(); ++s1) {
+    ASSERT_EQ(newPairs[s1].size(), oldPairs[s1].size());
+    for (std::size_t i = 0; i < oldPairs[s1].size(); ++i) {
+      EXPECT_EQ(newPairs[s1][i].secondShellIndex, oldPairs[s1][i].secondShellIndex);
+      EXPECT_EQ(newPairs[s1][i].cauchySchwarzFactor, oldPairs[s1][i].cauchySchwarzFactor);
+      const auto& newPrimPairs = newPairs[s1][i].precomputedShellPair->primpairs;
+      const auto& oldPrimPairs = oldPairs[s1][i].precomputedShellPair->primpairs;
+      ASSERT_EQ(newPrimPairs.size(), oldPrimPairs.size());
+      for (std::size_t k = 0; k < newPrimPairs.size(); ++k) {
+        for (int d = 0; d < 3; ++d) {
+          EXPECT_THAT(newPrimPairs[k].P[d], DoubleNear(oldPrimPairs[k].P[d] + translation[d], 1e-12));
+        }
+      }
+    }
+  }
+
+  // Regenerated shell pairs keep the flags of the existing ones.
+  auto unscreenedBasis = eval.initializeBasisSet("def2-svp", oldAtoms, false);
+  LibintIntegrals::generateShellPairs(unscreenedBasis, false, 1e-12, false);
+  auto regenerated = LibintIntegrals::moveBasisSet(unscreenedBasis, oldAtoms, newAtoms, 0.0);
+  ASSERT_FALSE(regenerated.getShellPairs()->hasCauchySchwarzFactor());
+  for (std::size_t s1 = 0; s1 < regenerated.size(); ++s1) {
+    EXPECT_EQ(regenerated.getShellPairs()->at(s1).size(), s1 + 1);
+  }
+}
+
+TEST_F(ShellPairTest, ChainedMovesFollowTheOverlapThreshold) {
+  // A hydrogen atom walks away from a water molecule in steps below the displacement tolerance, such that pairs
+  // between them drop below the overlap threshold on the way.
+  std::stringstream xyz("4\n\n"
+                        "O  0.0 0.0 0.0\n"
+                        "H  0.9 0.1 0.0\n"
+                        "H -0.3 0.8 0.0\n"
+                        "H  8.7 0.0 0.0");
+  auto atoms = Utils::XyzStreamHandler::read(xyz);
+  LibintIntegrals eval;
+  auto initialBasis = eval.initializeBasisSet("def2-svp", atoms);
+
+  auto numberOfPairs = [](const Utils::Integrals::BasisSet& basis) {
+    std::size_t number = 0;
+    for (std::size_t s1 = 0; s1 < basis.size(); ++s1) {
+      number += basis.getShellPairs()->at(s1).size();
+    }
+    return number;
+  };
+
+  auto basis = initialBasis;
+  for (int step = 0; step < 45; ++step) {
+    auto movedAtoms = atoms;
+    movedAtoms.setPosition(3, atoms.getPosition(3) + Utils::Position(0.09, 0.0, 0.0));
+    basis = LibintIntegrals::moveBasisSet(basis, atoms, movedAtoms, 0.1);
+    atoms = movedAtoms;
+  }
+
+  const auto reference = eval.initializeBasisSet("def2-svp", atoms);
+  ASSERT_NE(numberOfPairs(reference), numberOfPairs(initialBasis));
+  for (std::size_t s1 = 0; s1 < reference.size(); ++s1) {
+    const auto& pairs = basis.getShellPairs()->at(s1);
+    const auto& referencePairs = reference.getShellPairs()->at(s1);
+    ASSERT_EQ(pairs.size(), referencePairs.size());
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+      EXPECT_EQ(pairs[i].secondShellIndex, referencePairs[i].secondShellIndex);
+      EXPECT_THAT(pairs[i].cauchySchwarzFactor, DoubleNear(referencePairs[i].cauchySchwarzFactor, 1e-12));
+    }
+  }
+}
+
 TEST_F(BasisSetHandlerTest, AtomsScineToLibint) {
   Utils::ElementTypeCollection etc{Utils::ElementType::H, Utils::ElementType::H, Utils::ElementType::O};
   Utils::PositionCollection pc = Eigen::MatrixX3d::Random(3, 3);
@@ -193,3 +438,245 @@ TEST_F(BasisSetHandlerTest, TestBasisSet) {
     }
   }
 }
+
+TEST_F(IntegralTensorTest, LayoutIsContiguousAndIndexed) {
+  std::vector<Utils::Integrals::Component> components = {Utils::Integrals::Component::x, Utils::Integrals::Component::y,
+                                                         Utils::Integrals::Component::z};
+  std::vector<Utils::Integrals::DerivKey> derivKeys = {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y,
+                                                       Utils::Integrals::DerivKey::z};
+  IntegralTensor tensor(components, 2, derivKeys, 5, 3);
+
+  ASSERT_EQ(tensor.size(), 18);
+  ASSERT_EQ(tensor.rows(), 5);
+  ASSERT_EQ(tensor.cols(), 3);
+
+  auto keys = tensor.keys();
+  ASSERT_EQ(keys.size(), tensor.size());
+  for (std::size_t c = 0; c < components.size(); ++c) {
+    for (std::size_t center = 0; center < 2; ++center) {
+      for (std::size_t d = 0; d < derivKeys.size(); ++d) {
+        const auto index = tensor.index(c, center, d);
+        ASSERT_EQ(tensor.index(components[c], center, derivKeys[d]), index);
+        ASSERT_EQ(tensor.index(keys[index]), index);
+        ASSERT_TRUE(tensor.matrix(index).isZero());
+        tensor.matrix(index).setConstant(static_cast<double>(index));
+      }
+    }
+  }
+
+  // Matrices do not overlap and the map-style accessors are views of the same memory.
+  for (std::size_t index = 0; index < tensor.size(); ++index) {
+    ASSERT_TRUE(tensor.at(keys[index]).isConstant(static_cast<double>(index)));
+    ASSERT_EQ(tensor[keys[index]].data(), tensor.data(index));
+  }
+  ASSERT_EQ(tensor.count({Utils::Integrals::Component::x, Utils::Integrals::DerivKey::x, 2}), 0);
+  ASSERT_THROW(tensor.at({Utils::Integrals::Component::x, Utils::Integrals::DerivKey::x, 2}), std::out_of_range);
+
+  // The map holds independent copies.
+  auto map = tensor.toMap();
+  ASSERT_EQ(map.size(), tensor.size());
+  tensor.setZero();
+  for (std::size_t index = 0; index < tensor.size(); ++index) {
+    ASSERT_TRUE(tensor.matrix(index).isZero());
+    ASSERT_TRUE(map.at(keys[index]).isConstant(static_cast<double>(index)));
+  }
+}
+
+TEST_F(IntegralTensorTest, MovedTensorMatchesCopiedMap) {
+  // Matrices spanning several of the chunks after which the copied pages are released.
+  IntegralTensor tensor({Utils::Integrals::Component::x, Utils::Integrals::Component::y}, 2,
+                        {Utils::Integrals::DerivKey::value}, 500, 301);
+  for (std::size_t index = 0; index < tensor.size(); ++index) {
+    tensor.matrix(index).setRandom();
+  }
+  const auto copied = tensor.toMap();
+  const auto moved = std::move(tensor).toMap();
+
+  ASSERT_TRUE(tensor.empty());
+  ASSERT_EQ(moved.size(), copied.size());
+  for (auto const& keyMatrix : copied) {
+    ASSERT_EQ(moved.at(keyMatrix.first), keyMatrix.second);
+  }
+}
+
+TEST_F(PointChargeOctreeTest, ExpansionMatchesExactPotential) {
+  std::vector<PointCharge> charges;
+  for (int i = 0; i < 1000; ++i) {
+    const Eigen::Vector3d position(20.0 + 0.1 * ((i * 37) % 10), -5.0 + 0.1 * ((i / 10) % 10), 0.1 * (i / 100));
+    charges.push_back({(i % 3 == 0) ? 0.8 : -0.4, position});
+  }
+  PointChargeOctree octree(charges, 8);
+  ASSERT_EQ(octree.size(), charges.size());
+
+  const Eigen::Vector3d center(0.5, -0.3, 0.2);
+  const double extent = 1.0;
+  PointChargeOctree::PotentialExpansion reference;
+  double potential = 0.0;
+  Eigen::Vector3d field = Eigen::Vector3d::Zero();
+  for (auto const& charge : charges) {
+    const Eigen::Vector3d R = center - charge.position;
+    potential += charge.charge / R.norm();
+    field -= charge.charge * R / std::pow(R.norm(), 3);
+  }
+
+  std::vector<std::pair<double, std::array<double, 3>>> nearCharges;
+  PointChargeOctree::PotentialExpansion expansion;
+  octree.collect(center, extent, 0.3, expansion, nearCharges);
+  EXPECT_TRUE(nearCharges.empty());
+  EXPECT_THAT(expansion.potential, DoubleNear(potential, 2e-5));
+  for (int a = 0; a < 3; ++a) {
+    EXPECT_THAT(expansion.gradient[a], DoubleNear(field[a], 5e-6));
+  }
+
+  // Without opening angle, all charges are near.
+  PointChargeOctree::PotentialExpansion empty;
+  octree.collect(center, extent, 0.0, empty, nearCharges);
+  EXPECT_EQ(nearCharges.size(), charges.size());
+  EXPECT_EQ(empty.potential, 0.0);
+}
+
+TEST_F(BasisSetHandlerTest, CachedBasisSetMatchesLibint) {
+  std::stringstream h2o("3\n\n"
+                        "O  0.0 0.0 0.0\n"
+                        "H  0.9 0.1 0.0\n"
+                        "H -0.3 0.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(h2o);
+  auto libintAtoms = BasisSetHandler::scineToLibint(scineAtoms);
+
+  LibintIntegrals::clearBasisSetCache();
+  LibintIntegrals::preloadBasisSets({"def2-svp"}, {Utils::ElementType::H});
+  ASSERT_TRUE(BasisSetLibrary::getInstance().contains("def2-SVP", 1));
+  ASSERT_FALSE(BasisSetLibrary::getInstance().contains("def2-svp", 8));
+
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  // Twice: once parsing the oxygen basis, once entirely from the cache.
+  for (int i = 0; i < 2; ++i) {
+    auto scineBasis = eval.initializeBasisSet("def2-svp", scineAtoms, false);
+    ASSERT_TRUE(BasisSetLibrary::getInstance().contains("def2-svp", 8));
+
+    auto libintBasis = libint2::BasisSet("def2-svp", libintAtoms, true);
+    libintBasis.set_pure(true);
+    ASSERT_EQ(scineBasis.size(), libintBasis.size());
+    ASSERT_EQ(scineBasis.nbf(), libintBasis.nbf());
+    for (std::size_t s = 0; s < libintBasis.size(); ++s) {
+      ASSERT_EQ(libintBasis[s].contr.at(0).l, scineBasis[s].l());
+      for (std::size_t k = 0; k < libintBasis[s].alpha.size(); ++k) {
+        ASSERT_DOUBLE_EQ(libintBasis[s].alpha.at(k), scineBasis[s].getVecAlpha().at(k));
+        ASSERT_DOUBLE_EQ(libintBasis[s].contr.at(0).coeff.at(k), scineBasis[s].getVecCoeffs().at(k));
+      }
+      for (std::size_t k = 0; k < 3; ++k) {
+        ASSERT_DOUBLE_EQ(libintBasis[s].O.at(k), scineBasis[s].getShift()(k));
+      }
+    }
+  }
+
+  // Shells handed out stay valid when the cache is cleared.
+  const auto oxygenShells = BasisSetLibrary::getInstance().getShells("def2-svp", 8);
+  LibintIntegrals::clearBasisSetCache();
+  ASSERT_FALSE(BasisSetLibrary::getInstance().contains("def2-svp", 8));
+  ASSERT_EQ(oxygenShells->size(), BasisSetLibrary::getInstance().getShells("def2-svp", 8)->size());
+
+  // Basis sets assembled while other threads clear the cache.
+  const auto referenceBasis = eval.initializeBasisSet("def2-svp", scineAtoms, false);
+  std::vector<std::size_t> numberOfFunctions(16);
+#pragma omp parallel for schedule(static, 1) num_threads(4)
+  for (int i = 0; i < static_cast<int>(numberOfFunctions.size()); ++i) {
+    if (i % 4 == 0) {
+      LibintIntegrals::clearBasisSetCache();
+    }
+    LibintIntegrals localEval;
+    localEval.settings().modifyBool("use_pure_spherical", true);
+    numberOfFunctions[i] = localEval.initializeBasisSet("def2-svp", scineAtoms, false).nbf();
+  }
+  for (auto nbf : numberOfFunctions) {
+    ASSERT_EQ(nbf, referenceBasis.nbf());
+  }
+}
+
+TEST_F(BasisSetHandlerTest, SerializedBasisSetMatchesOriginal) {
+  std::stringstream h2o("3\n\n"
+                        "O  0.0 0.0 0.0\n"
+                        "H  0.9 0.1 0.0\n"
+                        "H -0.3 0.8 0.0");
+  auto atoms = Utils::XyzStreamHandler::read(h2o);
+  LibintIntegrals eval;
+  auto basis = eval.initializeBasisSet("def2-svp", atoms);
+
+  std::stringstream buffer;
+  BasisSetSerializer::write(basis, atoms, buffer);
+  const auto data = buffer.str();
+  auto restored = BasisSetSerializer::fromBuffer(data.data(), data.size());
+  auto restoredAtoms = BasisSetSerializer::atomsFromBuffer(data.data(), data.size());
+
+  ASSERT_EQ(restoredAtoms.size(), atoms.size());
+  for (int i = 0; i < atoms.size(); ++i) {
+    ASSERT_EQ(restoredAtoms.getElement(i), atoms.getElement(i));
+    ASSERT_TRUE(restoredAtoms.getPosition(i).isApprox(atoms.getPosition(i)));
+  }
+  ASSERT_EQ(restored.isPureSpherical(), basis.isPureSpherical());
+  ASSERT_EQ(restored.size(), basis.size());
+  ASSERT_EQ(restored.nbf(), basis.nbf());
+  for (std::size_t s = 0; s < basis.size(); ++s) {
+    ASSERT_EQ(restored[s].l(), basis[s].l());
+    ASSERT_EQ(restored[s].isPureSolid(), basis[s].isPureSolid());
+    ASSERT_EQ(restored[s].getVecAlpha(), basis[s].getVecAlpha());
+    ASSERT_EQ(restored[s].getVecCoeffs(), basis[s].getVecCoeffs());
+    ASSERT_TRUE(restored[s].getShift().isApprox(basis[s].getShift()));
+  }
+
+  ASSERT_TRUE(restored.areShellPairsEvaluated());
+  const auto& pairs = *basis.getShellPairs();
+  const auto& restoredPairs = *restored.getShellPairs();
+  ASSERT_EQ(restoredPairs.hasCauchySchwarzFactor(), pairs.hasCauchySchwarzFactor());
+  ASSERT_EQ(restoredPairs.size(), pairs.size());
+  for (std::size_t s1 = 0; s1 < pairs.size(); ++s1) {
+    ASSERT_EQ(restoredPairs[s1].size(), pairs[s1].size());
+    for (std::size_t p = 0; p < pairs[s1].size(); ++p) {
+      const auto& pair = pairs[s1][p];
+      const auto& restoredPair = restoredPairs[s1][p];
+      ASSERT_EQ(restoredPair.secondShellIndex, pair.secondShellIndex);
+      ASSERT_DOUBLE_EQ(restoredPair.cauchySchwarzFactor, pair.cauchySchwarzFactor);
+      const auto& primPairs = pair.precomputedShellPair->primpairs;
+      const auto& restoredPrimPairs = restoredPair.precomputedShellPair->primpairs;
+      ASSERT_EQ(restoredPrimPairs.size(), primPairs.size());
+      for (std::size_t k = 0; k < primPairs.size(); ++k) {
+        ASSERT_EQ(restoredPrimPairs[k].p1, primPairs[k].p1);
+        ASSERT_EQ(restoredPrimPairs[k].p2, primPairs[k].p2);
+        ASSERT_DOUBLE_EQ(restoredPrimPairs[k].K, primPairs[k].K);
+        ASSERT_DOUBLE_EQ(restoredPrimPairs[k].one_over_gamma, primPairs[k].one_over_gamma);
+        ASSERT_DOUBLE_EQ(restoredPrimPairs[k].scr, primPairs[k].scr);
+        for (int d = 0; d < 3; ++d) {
+          ASSERT_DOUBLE_EQ(restoredPrimPairs[k].P[d], primPairs[k].P[d]);
+          ASSERT_DOUBLE_EQ(restoredPair.precomputedShellPair->AB[d], pair.precomputedShellPair->AB[d]);
+        }
+      }
+    }
+  }
+
+  // The restored basis yields the same integrals.
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Overlap;
+  auto overlap = LibintIntegrals::evaluateTensor(specifier, basis, basis);
+  auto restoredOverlap = LibintIntegrals::evaluateTensor(specifier, restored, restored);
+  ASSERT_TRUE(restoredOverlap.matrix(0).isApprox(overlap.matrix(0)));
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+  auto coulomb = LibintIntegrals::evaluateTensor(specifier, basis, basis);
+  auto restoredCoulomb = LibintIntegrals::evaluateTensor(specifier, restored, restored);
+  ASSERT_TRUE(restoredCoulomb.matrix(0).isApprox(coulomb.matrix(0), 1e-12));
+
+  // The restored Cauchy-Schwarz factors screen the same quartets of a direct Fock build.
+  Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(basis.nbf(), basis.nbf());
+  auto mos = Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs);
+  auto densityMatrix = Utils::LcaoUtils::DensityMatrixBuilder(mos).generateRestrictedForNumberElectrons(10);
+  auto jk = LibintIntegrals::evaluateTwoBodyDirectBo(specifier, basis, basis, densityMatrix, 1e-8);
+  auto restoredJk = LibintIntegrals::evaluateTwoBodyDirectBo(specifier, restored, restored, densityMatrix, 1e-8);
+  ASSERT_TRUE(restoredJk.first.restrictedMatrix().isApprox(jk.first.restrictedMatrix(), 1e-12));
+  ASSERT_TRUE(restoredJk.second.restrictedMatrix().isApprox(jk.second.restrictedMatrix(), 1e-12));
+
+  // Data of another format version are rejected.
+  auto corrupted = data;
+  corrupted[12] = static_cast<char>(corrupted[12] + 1);
+  ASSERT_THROW(BasisSetSerializer::fromBuffer(corrupted.data(), corrupted.size()), std::runtime_error);
+  ASSERT_THROW(BasisSetSerializer::fromBuffer(data.data(), data.size() / 2), std::runtime_error);
+}
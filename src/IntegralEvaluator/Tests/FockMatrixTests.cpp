@@ -4,12 +4,17 @@
  *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.\n
  *            See LICENSE.txt for details.
  */
+#include <LibintIntegrals/IntegralSession.h>
 #include <LibintIntegrals/Libint.h>
 #include <LibintIntegrals/LibintIntegrals.h>
+#include <LibintIntegrals/ShellReordering.h>
 #include <LibintIntegrals/TwoBodyIntegrals/CauchySchwarzDensityPrescreener.h>
 #include <LibintIntegrals/TwoBodyIntegrals/Evaluator.h>
 #include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/CoulombExchangeDigester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/DirectFockBuilder.h>
+#include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/MultiComponentCoulombBuilder.h>
 #include <LibintIntegrals/TwoBodyIntegrals/HartreeFock/TwoTypeCoulombDigester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/TwoTypeCauchySchwarzPrescreener.h>
 #include <Utils/Constants.h>
 #include <Utils/DataStructures/MolecularOrbitals.h>
 #include <Utils/IO/ChemicalFileFormats/XyzStreamHandler.h>
@@ -17,6 +22,8 @@
 #include <Utils/Settings.h>
 #include <gmock/gmock.h>
 #include <Eigen/Eigenvalues>
+#include <algorithm>
+#include <numeric>
 
 using namespace Scine;
 using namespace Integrals;
@@ -487,6 +494,649 @@ TEST_F(FockMatrixTest, TestJK_nuclearElectronic) {
   }
 }
 
+TEST_F(FockMatrixTest, CostBalancedSchedulingMatchesShellWise) {
+  std::stringstream xyzInput("3\n\n"
+                             "O  0.0 0.0 0.0\n"
+                             "H  0.9 0.1 0.0\n"
+                             "H -0.3 0.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(xyzInput);
+
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  auto basis = eval.initializeBasisSet("def2-svp", scineAtoms);
+  const auto nbf = static_cast<int>(basis.nbf());
+
+  Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(nbf, nbf);
+  Utils::MolecularOrbitals mos = Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs);
+  Utils::LcaoUtils::DensityMatrixBuilder builder(mos);
+  auto densityMatrix = builder.generateRestrictedForNumberElectrons(10);
+
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+
+  // Every bra pair is handed out exactly once, also when one thread steals everything.
+  TwoBody::QuartetScheduler scheduler(basis, basis, TwoBody::SchedulingPolicy::costBalanced, 4);
+  std::vector<int> visited(scheduler.braPairs().size(), 0);
+  TwoBody::QuartetScheduler::Task task{};
+  while (scheduler.nextTask(0, task)) {
+    for (auto p = task.firstBraPair; p < task.lastBraPair; ++p) {
+      ++visited[p];
+    }
+  }
+  for (auto const& v : visited) {
+    ASSERT_EQ(v, 1);
+  }
+
+  std::vector<std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>> results;
+  for (auto policy : {TwoBody::SchedulingPolicy::shellWise, TwoBody::SchedulingPolicy::costBalanced}) {
+    auto digester = TwoBody::CoulombExchangeDigester(basis, basis, specifier, densityMatrix);
+    auto evaluator = TwoBody::Evaluator<TwoBody::CoulombExchangeDigester>(basis, basis, specifier, std::move(digester),
+                                                                          TwoBody::VoidPrescreener());
+    evaluator.setSchedulingPolicy(policy);
+    evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+    results.push_back(evaluator.getResult());
+
+    const auto& statistics = evaluator.getSchedulingStatistics();
+    // The team granted may be smaller than requested, e.g. if the runtime limits it.
+    ASSERT_GE(statistics.busyTime.size(), 1u);
+    ASSERT_LE(statistics.busyTime.size(), static_cast<std::size_t>(Libint::getMaxNumberThreads()));
+    ASSERT_GT(std::accumulate(statistics.numberOfTasks.begin(), statistics.numberOfTasks.end(), std::size_t{0}), 0);
+    ASSERT_GE(statistics.imbalance(), 1.0);
+  }
+
+  ASSERT_TRUE(results[1].first.restrictedMatrix().isApprox(results[0].first.restrictedMatrix(), 1e-12));
+  ASSERT_TRUE(results[1].second.restrictedMatrix().isApprox(results[0].second.restrictedMatrix(), 1e-12));
+}
+
+TEST_F(FockMatrixTest, CostBalancedSchedulingBalancesMixedAngularMomenta) {
+  // Formamide in def2-TZVP: s to f shells with contraction depths from 1 to 6.
+  std::stringstream xyzInput("6\n\n"
+                             "C   0.000  0.418  0.000\n"
+                             "O   1.209  0.554  0.000\n"
+                             "N  -0.712 -0.744  0.000\n"
+                             "H  -0.597  1.354  0.000\n"
+                             "H  -1.718 -0.716  0.000\n"
+                             "H  -0.230 -1.634  0.000");
+  auto scineAtoms = Utils::XyzStreamHandler::read(xyzInput);
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  auto basis = eval.initializeBasisSet("def2-tzvp", scineAtoms);
+
+  /*
+   * Replays the distribution of the tasks with their estimated costs as durations: the thread that becomes idle
+   * first fetches the next task. This is deterministic, unlike the measured busy times.
+   * Returns the ratio of the largest to the mean load.
+   */
+  const int numberOfThreads = 8;
+  auto simulatedImbalance = [&](TwoBody::SchedulingPolicy policy) {
+    TwoBody::QuartetScheduler scheduler(basis, basis, policy, numberOfThreads);
+    const auto& costs = scheduler.getEstimatedCosts();
+    std::vector<double> load(numberOfThreads, 0.0);
+    TwoBody::QuartetScheduler::Task task{};
+    while (true) {
+      const auto thread = static_cast<int>(std::distance(load.begin(), std::min_element(load.begin(), load.end())));
+      if (!scheduler.nextTask(thread, task)) {
+        break;
+      }
+      load[thread] += std::accumulate(costs.begin() + task.firstBraPair, costs.begin() + task.lastBraPair, 0.0);
+    }
+    const double mean = std::accumulate(load.begin(), load.end(), 0.0) / numberOfThreads;
+    return *std::max_element(load.begin(), load.end()) / mean;
+  };
+
+  // The shell-wise tasks grow with s1, so the last and most expensive ones leave the other threads idle.
+  const double shellWise = simulatedImbalance(TwoBody::SchedulingPolicy::shellWise);
+  const double costBalanced = simulatedImbalance(TwoBody::SchedulingPolicy::costBalanced);
+  EXPECT_LT(costBalanced, shellWise);
+  EXPECT_LT(costBalanced, 1.25);
+}
+
+TEST_F(FockMatrixTest, ReorderedShellsGiveSameJK) {
+  std::stringstream xyzInput("3\n\n"
+                             "O  0.0 0.0 0.0\n"
+                             "H  0.9 0.1 0.0\n"
+                             "H -0.3 0.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(xyzInput);
+
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  auto basis = eval.initializeBasisSet("def2-svp", scineAtoms);
+  const auto nbf = static_cast<int>(basis.nbf());
+
+  ShellReordering reordering(basis);
+  const auto& reordered = reordering.getBasis();
+  ASSERT_EQ(reordered.size(), basis.size());
+  ASSERT_TRUE(reordered.areShellPairsEvaluated());
+  for (std::size_t s = 1; s < reordered.size(); ++s) {
+    ASSERT_LE(reordered[s - 1].l(), reordered[s].l());
+  }
+  auto functionOrder = reordering.functionOrder();
+  std::sort(functionOrder.begin(), functionOrder.end());
+  for (int i = 0; i < nbf; ++i) {
+    ASSERT_EQ(functionOrder[i], i);
+  }
+  const Eigen::MatrixXd M = Eigen::MatrixXd::Random(nbf, nbf);
+  ASSERT_TRUE(reordering.toOriginal(reordering.toReordered(M)).isApprox(M));
+
+  // The shell pairs are permuted along with the shells, with the same screening and Schwarz factors.
+  const auto& shellPairs = *basis.getShellPairs();
+  const auto& reorderedPairs = *reordered.getShellPairs();
+  ASSERT_EQ(reorderedPairs.hasCauchySchwarzFactor(), shellPairs.hasCauchySchwarzFactor());
+  std::vector<std::size_t> newIndex(basis.size());
+  for (std::size_t s = 0; s < basis.size(); ++s) {
+    newIndex[reordering.shellOrder()[s]] = s;
+  }
+  std::size_t numberOfPairs = 0;
+  for (std::size_t s1 = 0; s1 < basis.size(); ++s1) {
+    numberOfPairs += shellPairs[s1].size();
+    for (auto const& pair : shellPairs[s1]) {
+      const auto n1 = std::max(newIndex[s1], newIndex[pair.secondShellIndex]);
+      const auto n2 = std::min(newIndex[s1], newIndex[pair.secondShellIndex]);
+      auto reorderedPair = std::find_if(reorderedPairs[n1].begin(), reorderedPairs[n1].end(),
+                                        [&](const auto& candidate) { return candidate.secondShellIndex == n2; });
+      ASSERT_NE(reorderedPair, reorderedPairs[n1].end());
+      EXPECT_DOUBLE_EQ(reorderedPair->cauchySchwarzFactor, pair.cauchySchwarzFactor);
+      EXPECT_EQ(reorderedPair->precomputedShellPair->primpairs.size(), pair.precomputedShellPair->primpairs.size());
+    }
+  }
+  std::size_t numberOfReorderedPairs = 0;
+  for (std::size_t n1 = 0; n1 < reordered.size(); ++n1) {
+    numberOfReorderedPairs += reorderedPairs[n1].size();
+    for (std::size_t i = 1; i < reorderedPairs[n1].size(); ++i) {
+      ASSERT_LT(reorderedPairs[n1][i - 1].secondShellIndex, reorderedPairs[n1][i].secondShellIndex);
+    }
+  }
+  ASSERT_EQ(numberOfReorderedPairs, numberOfPairs);
+
+  // Pairs whose shell order is swapped are rebuilt with the primitive screening precision of the reordering.
+  const double lnPrecision = std::log(1e-3);
+  ShellReordering coarseReordering(basis, lnPrecision);
+  const auto& coarse = coarseReordering.getBasis();
+  const auto& coarsePairs = *coarse.getShellPairs();
+  std::size_t numberOfSwappedPairs = 0;
+  for (std::size_t s1 = 0; s1 < basis.size(); ++s1) {
+    for (auto const& pair : shellPairs[s1]) {
+      const auto n1 = newIndex[s1];
+      const auto n2 = newIndex[pair.secondShellIndex];
+      if (n1 >= n2) {
+        continue;
+      }
+      ++numberOfSwappedPairs;
+      auto coarsePair = std::find_if(coarsePairs[n2].begin(), coarsePairs[n2].end(),
+                                     [&](const auto& candidate) { return candidate.secondShellIndex == n1; });
+      ASSERT_NE(coarsePair, coarsePairs[n2].end());
+      const Utils::Integrals::ShellPairType expected(coarse[n2], coarse[n1], lnPrecision);
+      EXPECT_EQ(coarsePair->precomputedShellPair->primpairs.size(), expected.primpairs.size());
+    }
+  }
+  ASSERT_GT(numberOfSwappedPairs, 0U);
+
+  Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(nbf, nbf);
+  Utils::MolecularOrbitals mos = Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs);
+  Utils::LcaoUtils::DensityMatrixBuilder builder(mos);
+  auto densityMatrix = builder.generateRestrictedForNumberElectrons(10);
+
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+
+  auto reference = LibintIntegrals::evaluateTwoBodyDirectBo(specifier, basis, basis, densityMatrix, 1e-14);
+  auto result = LibintIntegrals::evaluateTwoBodyDirectBo(specifier, basis, basis, densityMatrix, 1e-14, true);
+
+  ASSERT_TRUE(result.first.restrictedMatrix().isApprox(reference.first.restrictedMatrix(), 1e-10));
+  ASSERT_TRUE(result.second.restrictedMatrix().isApprox(reference.second.restrictedMatrix(), 1e-10));
+
+  // A prebuilt reordering, as kept in an SCF loop.
+  auto cached = LibintIntegrals::evaluateTwoBodyDirectBo(specifier, reordering, densityMatrix, 1e-14);
+  ASSERT_TRUE(cached.first.restrictedMatrix().isApprox(reference.first.restrictedMatrix(), 1e-10));
+  ASSERT_TRUE(cached.second.restrictedMatrix().isApprox(reference.second.restrictedMatrix(), 1e-10));
+}
+
+TEST_F(FockMatrixTest, TwoTypeCauchySchwarzScreeningKeepsNuclearElectronicJ) {
+  std::stringstream xyzInput_e("4\n\n"
+                               "O  0.0 0.0 0.0\n"
+                               "H  0.9 0.1 0.0\n"
+                               "H -0.3 0.8 0.0\n"
+                               "H  6.0 0.0 0.0");
+  auto atoms1 = Utils::XyzStreamHandler::read(xyzInput_e);
+  std::stringstream xyzInput_p("2\n\n"
+                               "H  0.9 0.1 0.0\n"
+                               "H  6.0 0.0 0.0");
+  auto atoms2 = Utils::XyzStreamHandler::read(xyzInput_p);
+
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  auto basis1 = eval.initializeBasisSet("def2-svp", atoms1);
+  auto basis2 = eval.initializeBasisSet("6-31g**", atoms2);
+  const auto nbf1 = static_cast<int>(basis1.nbf());
+  const auto nbf2 = static_cast<int>(basis2.nbf());
+
+  Eigen::MatrixXd coeffs1 = Eigen::MatrixXd::Random(nbf1, nbf1);
+  Utils::LcaoUtils::DensityMatrixBuilder builder1(Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs1));
+  auto densityMatrix1 = builder1.generateRestrictedForNumberElectrons(12);
+  Eigen::MatrixXd coeffs2 = Eigen::MatrixXd::Random(nbf2, nbf2);
+  Utils::LcaoUtils::DensityMatrixBuilder builder2(Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs2));
+  auto densityMatrix2 = builder2.generateRestrictedForNumberElectrons(2);
+
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+  specifier.typeVector = {Utils::Integrals::getParticleType("e"), Utils::Integrals::getParticleType("H")};
+
+  auto digester = TwoBody::TwoTypeCoulombDigester(basis1, basis2, specifier, densityMatrix1, densityMatrix2);
+  auto evaluator = TwoBody::Evaluator<TwoBody::TwoTypeCoulombDigester>(basis1, basis2, specifier, std::move(digester),
+                                                                       TwoBody::VoidPrescreener());
+  evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+  const auto reference = evaluator.getResult();
+
+  // The distant hydrogen makes part of the quartets negligible at the default threshold.
+  const auto prescreener = TwoBody::TwoTypeCauchySchwarzPrescreener(basis1, basis2, densityMatrix1, densityMatrix2);
+  const auto& shellPairs1 = *basis1.getShellPairs();
+  const auto& shellPairs2 = *basis2.getShellPairs();
+  ASSERT_TRUE(shellPairs1.hasCauchySchwarzFactor());
+  ASSERT_TRUE(shellPairs2.hasCauchySchwarzFactor());
+  std::size_t numberOfQuartets = 0;
+  std::size_t numberOfSkippedQuartets = 0;
+  for (std::size_t s1 = 0; s1 < basis1.size(); ++s1) {
+    for (auto const& pair12 : shellPairs1[s1]) {
+      for (std::size_t s3 = 0; s3 < basis2.size(); ++s3) {
+        for (auto const& pair34 : shellPairs2[s3]) {
+          ++numberOfQuartets;
+          if (!prescreener(s1, pair12.secondShellIndex, s3, pair34.secondShellIndex,
+                           pair12.cauchySchwarzFactor * pair34.cauchySchwarzFactor)) {
+            ++numberOfSkippedQuartets;
+          }
+        }
+      }
+    }
+  }
+  ASSERT_GT(numberOfSkippedQuartets, 0U);
+  ASSERT_LT(numberOfSkippedQuartets, numberOfQuartets);
+
+  auto screened =
+      LibintIntegrals::evaluateTwoBodyDirectPreBo(specifier, basis1, basis2, densityMatrix1, densityMatrix2);
+  ASSERT_TRUE(screened.first.isApprox(reference.first, 1e-9));
+  ASSERT_TRUE(screened.second.isApprox(reference.second, 1e-9));
+
+  // A threshold above every bound screens out all quartets.
+  auto empty =
+      LibintIntegrals::evaluateTwoBodyDirectPreBo(specifier, basis1, basis2, densityMatrix1, densityMatrix2, 1e10);
+  ASSERT_DOUBLE_EQ(empty.first.cwiseAbs().maxCoeff(), 0.0);
+  ASSERT_DOUBLE_EQ(empty.second.cwiseAbs().maxCoeff(), 0.0);
+}
+
+TEST_F(FockMatrixTest, MultiComponentCoulombMatchesPairwiseBuilds) {
+  std::stringstream xyzInput_e("3\n\n"
+                               "O  0.0 0.0 0.0\n"
+                               "H  0.9 0.1 0.0\n"
+                               "H -0.3 0.8 0.0");
+  auto atomsElectrons = Utils::XyzStreamHandler::read(xyzInput_e);
+  std::stringstream xyzInput_p1("1\n\n"
+                                "H  0.9 0.1 0.0");
+  auto atomsProton1 = Utils::XyzStreamHandler::read(xyzInput_p1);
+  std::stringstream xyzInput_p2("1\n\n"
+                                "H -0.3 0.8 0.0");
+  auto atomsProton2 = Utils::XyzStreamHandler::read(xyzInput_p2);
+
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  auto basisElectrons = eval.initializeBasisSet("def2-svp", atomsElectrons);
+  auto basisProton1 = eval.initializeBasisSet("6-31g**", atomsProton1);
+  auto basisProton2 = eval.initializeBasisSet("6-31g**", atomsProton2);
+
+  auto randomDensity = [](const Utils::Integrals::BasisSet& basis, int numberOfParticles) {
+    const auto nbf = static_cast<int>(basis.nbf());
+    Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(nbf, nbf);
+    Utils::LcaoUtils::DensityMatrixBuilder builder(Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs));
+    return builder.generateRestrictedForNumberElectrons(numberOfParticles);
+  };
+  auto densityElectrons = randomDensity(basisElectrons, 10);
+  auto densityProton1 = randomDensity(basisProton1, 2);
+  auto densityProton2 = randomDensity(basisProton2, 2);
+
+  TwoBody::MultiComponentCoulombBuilder builder({{basisElectrons, densityElectrons, -1.0},
+                                                 {basisProton1, densityProton1, 1.0},
+                                                 {basisProton2, densityProton2, 1.0}});
+  builder.compute();
+  const auto& result = builder.getResult();
+
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+  specifier.typeVector = {Utils::Integrals::getParticleType("e"), Utils::Integrals::getParticleType("H")};
+  auto electronProton1 = LibintIntegrals::evaluateTwoBodyDirectPreBo(specifier, basisElectrons, basisProton1,
+                                                                      densityElectrons, densityProton1);
+  auto electronProton2 = LibintIntegrals::evaluateTwoBodyDirectPreBo(specifier, basisElectrons, basisProton2,
+                                                                      densityElectrons, densityProton2);
+  ASSERT_TRUE(result.coulomb[0][1].isApprox(electronProton1.first, 1e-9));
+  ASSERT_TRUE(result.coulomb[1][0].isApprox(electronProton1.second, 1e-9));
+  ASSERT_TRUE(result.coulomb[0][2].isApprox(electronProton2.first, 1e-9));
+  ASSERT_TRUE(result.coulomb[2][0].isApprox(electronProton2.second, 1e-9));
+  ASSERT_TRUE(result.total(0).isApprox(electronProton1.first + electronProton2.first, 1e-9));
+
+  // Both nuclear types carry the same symbol, which evaluateTwoBodyDirectPreBo rejects.
+  specifier.typeVector = {Utils::Integrals::getParticleType("H"), Utils::Integrals::getParticleType("H")};
+  auto digester =
+      TwoBody::TwoTypeCoulombDigester(basisProton1, basisProton2, specifier, densityProton1, densityProton2);
+  auto evaluator = TwoBody::Evaluator<TwoBody::TwoTypeCoulombDigester>(basisProton1, basisProton2, specifier,
+                                                                       std::move(digester), TwoBody::VoidPrescreener());
+  evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+  ASSERT_TRUE(result.coulomb[1][2].isApprox(evaluator.getResult().first, 1e-9));
+  ASSERT_TRUE(result.coulomb[2][1].isApprox(evaluator.getResult().second, 1e-9));
+
+  // getResult() leaves the result in the builder, takeResult() moves it out.
+  ASSERT_EQ(&builder.getResult(), &result);
+  const Eigen::MatrixXd total = result.total(0);
+  const auto taken = builder.takeResult();
+  ASSERT_TRUE(taken.total(0).isApprox(total));
+}
+
+TEST_F(FockMatrixTest, DirectCoulombCOMMatchesSavedIntegrals) {
+  std::stringstream xyzInput_e("4\n\n"
+                               "N  0.0 0.0 0.1\n"
+                               "H  0.9 0.1 -0.3\n"
+                               "H -0.4 0.8 -0.3\n"
+                               "H -0.5 -0.8 -0.2");
+  auto atomsElectrons = Utils::XyzStreamHandler::read(xyzInput_e);
+  std::stringstream xyzInput_p("1\n\n"
+                               "H  0.9 0.1 -0.3");
+  auto atomsProton = Utils::XyzStreamHandler::read(xyzInput_p);
+
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  auto basisElectrons = eval.initializeBasisSet("sto-3g", atomsElectrons);
+  auto basisProton = eval.initializeBasisSet("6-31g**", atomsProton);
+  const auto n1 = static_cast<int>(basisElectrons.nbf());
+  const auto n2 = static_cast<int>(basisProton.nbf());
+
+  Eigen::MatrixXd coeffs1 = Eigen::MatrixXd::Random(n1, n1);
+  Utils::LcaoUtils::DensityMatrixBuilder builder1(Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs1));
+  auto densityElectrons = builder1.generateRestrictedForNumberElectrons(10);
+  Eigen::MatrixXd coeffs2 = Eigen::MatrixXd::Random(n2, n2);
+  Utils::LcaoUtils::DensityMatrixBuilder builder2(Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs2));
+  auto densityProton = builder2.generateRestrictedForNumberElectrons(2);
+  const auto& D1 = densityElectrons.restrictedMatrix();
+  const auto& D2 = densityProton.restrictedMatrix();
+
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::CoulombCOM;
+  specifier.totalMass = 42;
+
+  // One particle type: J_ij = sum_kl T_ij,kl D_kl, K_ik = sum_jl T_ij,kl D_jl.
+  {
+    auto resultMap = LibintIntegrals::evaluate(specifier, basisElectrons, basisElectrons);
+    const auto& T = resultMap[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, 0}];
+    Eigen::MatrixXd J = Eigen::MatrixXd::Zero(n1, n1);
+    Eigen::MatrixXd K = Eigen::MatrixXd::Zero(n1, n1);
+    for (int i = 0; i < n1; ++i) {
+      for (int j = 0; j < n1; ++j) {
+        for (int k = 0; k < n1; ++k) {
+          for (int l = 0; l < n1; ++l) {
+            J(i, j) += T(i * n1 + j, k * n1 + l) * D1(k, l);
+            K(i, k) += T(i * n1 + j, k * n1 + l) * D1(j, l);
+          }
+        }
+      }
+    }
+    auto JK =
+        LibintIntegrals::evaluateTwoBodyDirectBo(specifier, basisElectrons, basisElectrons, densityElectrons, 1e-14);
+    ASSERT_TRUE(JK.first.restrictedMatrix().isApprox(J, 1e-8));
+    ASSERT_TRUE(JK.second.restrictedMatrix().isApprox(K, 1e-8));
+  }
+
+  // Two particle types: J1_ij = sum_kl T_ij,kl D2_kl, J2_kl = sum_ij T_ij,kl D1_ij.
+  {
+    specifier.typeVector = {Utils::Integrals::getParticleType("e"), Utils::Integrals::getParticleType("H")};
+    auto resultMap = LibintIntegrals::evaluate(specifier, basisElectrons, basisProton);
+    const auto& T = resultMap[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, 0}];
+    Eigen::MatrixXd J1 = Eigen::MatrixXd::Zero(n1, n1);
+    Eigen::MatrixXd J2 = Eigen::MatrixXd::Zero(n2, n2);
+    for (int i = 0; i < n1; ++i) {
+      for (int j = 0; j < n1; ++j) {
+        for (int k = 0; k < n2; ++k) {
+          for (int l = 0; l < n2; ++l) {
+            J1(i, j) += T(i * n1 + j, k * n2 + l) * D2(k, l);
+            J2(k, l) += T(i * n1 + j, k * n2 + l) * D1(i, j);
+          }
+        }
+      }
+    }
+    auto J12 = LibintIntegrals::evaluateTwoBodyDirectPreBo(specifier, basisElectrons, basisProton, densityElectrons,
+                                                           densityProton, 1e-14);
+    ASSERT_TRUE(J12.first.isApprox(J1, 1e-8));
+    ASSERT_TRUE(J12.second.isApprox(J2, 1e-8));
+  }
+}
+
+TEST_F(FockMatrixTest, DirectFockBuilderReusesOutputBuffers) {
+  std::stringstream xyzInput("3\n\n"
+                             "O  0.0 0.0 0.0\n"
+                             "H  0.9 0.1 0.0\n"
+                             "H -0.3 0.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(xyzInput);
+
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  auto basis = eval.initializeBasisSet("def2-svp", scineAtoms);
+  const auto nbf = static_cast<int>(basis.nbf());
+
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+
+  // Reference with a digester owning its matrices.
+  auto referenceJK = [&](const Utils::DensityMatrix& density) {
+    auto evaluator = TwoBody::Evaluator<TwoBody::CoulombExchangeDigester, TwoBody::CauchySchwarzDensityPrescreener>(
+        basis, basis, specifier, TwoBody::CoulombExchangeDigester(basis, basis, specifier, density),
+        TwoBody::CauchySchwarzDensityPrescreener(basis, density, 1e-14));
+    evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+    return evaluator.takeResult();
+  };
+
+  TwoBody::DirectFockBuilder fockBuilder(basis, specifier, 1e-14);
+  std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix> JK;
+  const double* coulombBuffer = nullptr;
+  const double* exchangeBuffer = nullptr;
+  // Two SCF-like iterations with different densities into the same output.
+  for (int iteration = 0; iteration < 2; ++iteration) {
+    Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(nbf, nbf);
+    Utils::LcaoUtils::DensityMatrixBuilder builder(Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs));
+    auto densityMatrix = builder.generateRestrictedForNumberElectrons(10);
+
+    fockBuilder.compute(densityMatrix, JK);
+    if (iteration > 0) {
+      ASSERT_EQ(JK.first.restrictedMatrix().data(), coulombBuffer);
+      ASSERT_EQ(JK.second.restrictedMatrix().data(), exchangeBuffer);
+    }
+    coulombBuffer = JK.first.restrictedMatrix().data();
+    exchangeBuffer = JK.second.restrictedMatrix().data();
+
+    const auto reference = referenceJK(densityMatrix);
+    ASSERT_TRUE(JK.first.restrictedMatrix().isApprox(reference.first.restrictedMatrix(), 1e-12));
+    ASSERT_TRUE(JK.second.restrictedMatrix().isApprox(reference.second.restrictedMatrix(), 1e-12));
+  }
+
+  // The libint conversion kept by the builder is replaced once the shell pairs are regenerated.
+  auto oldLibintBasis = std::make_shared<const TwoBody::LibintBasis>(basis);
+  ASSERT_TRUE(oldLibintBasis->isConversionOf(basis));
+  LibintIntegrals::generateShellPairs(basis, false);
+  ASSERT_FALSE(oldLibintBasis->isConversionOf(basis));
+  Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(nbf, nbf);
+  Utils::LcaoUtils::DensityMatrixBuilder builder(Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs));
+  auto densityMatrix = builder.generateRestrictedForNumberElectrons(10);
+  fockBuilder.compute(densityMatrix, JK);
+  const auto reference = referenceJK(densityMatrix);
+  ASSERT_TRUE(JK.first.restrictedMatrix().isApprox(reference.first.restrictedMatrix(), 1e-12));
+  ASSERT_TRUE(JK.second.restrictedMatrix().isApprox(reference.second.restrictedMatrix(), 1e-12));
+
+  auto evaluator = TwoBody::Evaluator<TwoBody::CoulombExchangeDigester>(
+      basis, basis, specifier, TwoBody::CoulombExchangeDigester(basis, basis, specifier, densityMatrix),
+      TwoBody::VoidPrescreener());
+  ASSERT_THROW(evaluator.setLibintBases(oldLibintBasis, oldLibintBasis), std::invalid_argument);
+}
+
+TEST_F(FockMatrixTest, IntegralSessionMatchesLibintIntegrals) {
+  std::stringstream xyzInput("3\n\n"
+                             "O  0.0 0.0 0.0\n"
+                             "H  0.9 0.1 0.0\n"
+                             "H -0.3 0.8 0.0");
+  auto atoms = Utils::XyzStreamHandler::read(xyzInput);
+
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  auto basis = eval.initializeBasisSet("def2-svp", atoms);
+  const auto nbf = static_cast<int>(basis.nbf());
+
+  IntegralSession session(basis, atoms);
+  Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(nbf, nbf);
+  Utils::LcaoUtils::DensityMatrixBuilder builder(Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs));
+  auto densityMatrix = builder.generateRestrictedForNumberElectrons(10);
+
+  std::vector<Utils::Integrals::IntegralSpecifier> specifiers(2);
+  specifiers[0].op = Utils::Integrals::Operator::Kinetic;
+  specifiers[1].op = Utils::Integrals::Operator::PointCharges;
+  specifiers[1].atoms = atoms;
+  const Eigen::MatrixXd coreHamiltonian = LibintIntegrals::evaluateOneBodySum(specifiers, basis, basis).matrix(0);
+  ASSERT_TRUE(session.coreHamiltonian().isApprox(coreHamiltonian, 1e-12));
+
+  // Reference J and K from a digester owning its matrices, independent of DirectFockBuilder.
+  auto referenceJK = [](const Utils::Integrals::BasisSet& referenceBasis, const Utils::DensityMatrix& density) {
+    Utils::Integrals::IntegralSpecifier specifier;
+    specifier.op = Utils::Integrals::Operator::Coulomb;
+    auto evaluator = TwoBody::Evaluator<TwoBody::CoulombExchangeDigester, TwoBody::CauchySchwarzDensityPrescreener>(
+        referenceBasis, referenceBasis, specifier,
+        TwoBody::CoulombExchangeDigester(referenceBasis, referenceBasis, specifier, density),
+        TwoBody::CauchySchwarzDensityPrescreener(referenceBasis, density, 1e-12));
+    evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+    return evaluator.takeResult();
+  };
+  const auto reference = referenceJK(basis, densityMatrix);
+  std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix> JK;
+  session.coulombExchange(densityMatrix, JK);
+  ASSERT_TRUE(JK.first.restrictedMatrix().isApprox(reference.first.restrictedMatrix(), 1e-12));
+  ASSERT_TRUE(JK.second.restrictedMatrix().isApprox(reference.second.restrictedMatrix(), 1e-12));
+  ASSERT_THROW(session.coulombWith(densityMatrix, session, densityMatrix), std::runtime_error);
+
+  // A geometry change invalidates the cached matrices, the reference is a basis set up at the new geometry.
+  auto movedAtoms = atoms;
+  auto positions = movedAtoms.getPositions();
+  positions(1, 0) += 0.05;
+  movedAtoms.setPositions(positions);
+  session.updateGeometry(movedAtoms);
+  const auto movedBasis = eval.initializeBasisSet("def2-svp", movedAtoms);
+  specifiers[1].atoms = movedAtoms;
+  const Eigen::MatrixXd movedCoreHamiltonian =
+      LibintIntegrals::evaluateOneBodySum(specifiers, movedBasis, movedBasis).matrix(0);
+  ASSERT_FALSE(movedCoreHamiltonian.isApprox(coreHamiltonian, 1e-6));
+  ASSERT_TRUE(session.coreHamiltonian().isApprox(movedCoreHamiltonian, 1e-12));
+
+  const auto movedReference = referenceJK(movedBasis, densityMatrix);
+  session.coulombExchange(densityMatrix, JK);
+  ASSERT_TRUE(JK.first.restrictedMatrix().isApprox(movedReference.first.restrictedMatrix(), 1e-10));
+  ASSERT_TRUE(JK.second.restrictedMatrix().isApprox(movedReference.second.restrictedMatrix(), 1e-10));
+}
+
+TEST_F(FockMatrixTest, IntegralSessionRegeneratesShellPairsAfterDrift) {
+  // A hydrogen atom walks away from a water molecule in steps below the displacement tolerance, such that pairs
+  // between them drop below the overlap threshold on the way.
+  std::stringstream xyzInput("4\n\n"
+                             "O  0.0 0.0 0.0\n"
+                             "H  0.9 0.1 0.0\n"
+                             "H -0.3 0.8 0.0\n"
+                             "H  8.7 0.0 0.0");
+  auto atoms = Utils::XyzStreamHandler::read(xyzInput);
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  auto basis = eval.initializeBasisSet("def2-svp", atoms);
+  IntegralSession session(basis, atoms);
+
+  auto numberOfPairs = [](const Utils::Integrals::BasisSet& pairBasis) {
+    std::size_t number = 0;
+    for (std::size_t s1 = 0; s1 < pairBasis.size(); ++s1) {
+      number += pairBasis.getShellPairs()->at(s1).size();
+    }
+    return number;
+  };
+
+  const double tolerance = 0.1;
+  const double step = 0.09;
+  // With an even number of steps, the last one exceeds the tolerance with respect to the last generation.
+  const int numberOfSteps = 44;
+  auto movedAtoms = atoms;
+  for (int i = 0; i < numberOfSteps; ++i) {
+    auto positions = movedAtoms.getPositions();
+    positions(3, 0) += step;
+    movedAtoms.setPositions(positions);
+    session.updateGeometry(movedAtoms, tolerance);
+  }
+
+  const auto reference = eval.initializeBasisSet("def2-svp", movedAtoms);
+  ASSERT_NE(numberOfPairs(reference), numberOfPairs(basis));
+  ASSERT_EQ(numberOfPairs(session.getBasis()), numberOfPairs(reference));
+  for (std::size_t s1 = 0; s1 < reference.size(); ++s1) {
+    const auto& pairs = session.getBasis().getShellPairs()->at(s1);
+    const auto& referencePairs = reference.getShellPairs()->at(s1);
+    ASSERT_EQ(pairs.size(), referencePairs.size());
+    for (std::size_t p = 0; p < pairs.size(); ++p) {
+      EXPECT_EQ(pairs[p].secondShellIndex, referencePairs[p].secondShellIndex);
+      EXPECT_NEAR(pairs[p].cauchySchwarzFactor, referencePairs[p].cauchySchwarzFactor, 1e-12);
+    }
+  }
+}
+
+TEST_F(FockMatrixTest, ThreadCountFollowsTheActualTeam) {
+  std::stringstream xyzInput("3\n\n"
+                             "O  0.0 0.0 0.0\n"
+                             "H  0.9 0.1 0.0\n"
+                             "H -0.3 0.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(xyzInput);
+
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+  auto basis = eval.initializeBasisSet("def2-svp", scineAtoms);
+  const auto nbf = static_cast<int>(basis.nbf());
+
+  Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(nbf, nbf);
+  Utils::LcaoUtils::DensityMatrixBuilder builder(Utils::MolecularOrbitals::createFromRestrictedCoefficients(coeffs));
+  auto densityMatrix = builder.generateRestrictedForNumberElectrons(10);
+
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+  const auto reference = LibintIntegrals::evaluateTwoBodyDirectBo(specifier, basis, basis, densityMatrix, 1e-12);
+
+  // A scoped thread count applies to the calling thread only and is restored afterwards.
+  const int defaultNumberThreads = Libint::getNumberOfThreads();
+  {
+    Libint::ThreadCountScope threadCount(3);
+    ASSERT_EQ(Libint::getNumberOfThreads(), 3);
+    auto evaluator = TwoBody::Evaluator<TwoBody::CoulombExchangeDigester>(
+        basis, basis, specifier, TwoBody::CoulombExchangeDigester(basis, basis, specifier, densityMatrix),
+        TwoBody::VoidPrescreener());
+    evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+    // The per-thread data is sized from the team actually granted.
+    const auto teamSize = evaluator.getSchedulingStatistics().busyTime.size();
+    ASSERT_GE(teamSize, 1u);
+    ASSERT_LE(teamSize, 3u);
+    ASSERT_TRUE(evaluator.getResult().first.restrictedMatrix().isApprox(reference.first.restrictedMatrix(), 1e-12));
+    ASSERT_TRUE(evaluator.getResult().second.restrictedMatrix().isApprox(reference.second.restrictedMatrix(), 1e-12));
+    ASSERT_THROW(evaluator.setNumberOfThreads(-1), std::invalid_argument);
+  }
+  ASSERT_EQ(Libint::getNumberOfThreads(), defaultNumberThreads);
+  TwoBody::DirectFockBuilder fockBuilder(basis, specifier);
+  ASSERT_THROW(fockBuilder.setNumberOfThreads(-1), std::invalid_argument);
+
+  // Independent evaluations started concurrently from the threads of a host parallel region.
+  const int numberOfEvaluations = 4;
+  std::vector<std::pair<Utils::SpinAdaptedMatrix, Utils::SpinAdaptedMatrix>> results(numberOfEvaluations);
+  std::vector<int> numberThreadsInRegion(numberOfEvaluations);
+#pragma omp parallel for num_threads(numberOfEvaluations)
+  for (int i = 0; i < numberOfEvaluations; ++i) {
+    numberThreadsInRegion[i] = Libint::getNumberOfThreads();
+    results[i] = LibintIntegrals::evaluateTwoBodyDirectBo(specifier, basis, basis, densityMatrix, 1e-12);
+  }
+  for (int i = 0; i < numberOfEvaluations; ++i) {
+    ASSERT_EQ(numberThreadsInRegion[i], 1);
+    ASSERT_TRUE(results[i].first.restrictedMatrix().isApprox(reference.first.restrictedMatrix(), 1e-12));
+    ASSERT_TRUE(results[i].second.restrictedMatrix().isApprox(reference.second.restrictedMatrix(), 1e-12));
+  }
+}
+
 // TEST_F(FockMatrixTest, MakeRefernceData) {
 //  // Reference
 //
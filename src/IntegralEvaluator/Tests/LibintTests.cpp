@@ -651,3 +651,26 @@ TEST_F(LibintTest, RunAllTest) {
   testV();
   testF();
 }
+
+TEST_F(LibintTest, EnginePoolReusesAndResetsEngines) {
+  using Scine::Integrals::Libint;
+  Libint::clearEnginePool();
+
+  libint2::Engine* first = nullptr;
+  {
+    auto lease = Libint::leaseEngine(libint2::Operator::nuclear, 6, 2, 0);
+    first = lease.get();
+    lease->set_precision(0);
+    lease->set_params(std::vector<std::pair<double, std::array<double, 3>>>{{1.0, {0.0, 0.0, 0.0}}});
+  }
+  {
+    // The returned engine is lent out again, with the default precision.
+    auto lease = Libint::leaseEngine(libint2::Operator::nuclear, 6, 2, 0);
+    ASSERT_EQ(lease.get(), first);
+    ASSERT_DOUBLE_EQ(lease->precision(), std::numeric_limits<double>::epsilon());
+    // An engine of different dimensions is a new one, also while the first is lent out.
+    auto other = Libint::leaseEngine(libint2::Operator::nuclear, 6, 3, 0);
+    ASSERT_NE(other.get(), first);
+  }
+  Libint::clearEnginePool();
+}
@@ -7,6 +7,7 @@
 #include <LibintIntegrals/BasisSetHandler.h>
 #include <LibintIntegrals/LibintIntegrals.h>
 #include <Utils/Constants.h>
+#include <Utils/Geometry/ElementInfo.h>
 #include <Utils/IO/ChemicalFileFormats/XyzStreamHandler.h>
 #include <Utils/Settings.h>
 #include <gmock/gmock.h>
@@ -239,6 +240,72 @@ TEST_F(OneBodyIntsTest, TestOverlapDerivative) {
   }   // s1
 }
 
+TEST_F(OneBodyIntsTest, TestOverlapDerivativeUpperTriangle) {
+  std::stringstream h2o("3\n\n"
+                        "O  0.0 0.0 0.0\n"
+                        "H  0.9 0.1 0.0\n"
+                        "H -0.3 0.8 0.0");
+  auto atoms = Utils::XyzStreamHandler::read(h2o);
+
+  std::stringstream h2o_h0("3\n\n"
+                           "O  0.0 0.0 0.0\n"
+                           "H  0.9001 0.1 0.0\n"
+                           "H -0.3 0.8 0.0");
+  auto atoms_h0 = Utils::XyzStreamHandler::read(h2o_h0);
+
+  std::stringstream h2o_h1("3\n\n"
+                           "O  0.0 0.0 0.0\n"
+                           "H  0.8999 0.1 0.0\n"
+                           "H -0.3 0.8 0.0");
+  auto atoms_h1 = Utils::XyzStreamHandler::read(h2o_h1);
+
+  LibintIntegrals eval;
+  eval.settings().modifyBool("use_pure_spherical", true);
+
+  std::string name = "def2-svp";
+  auto basis = eval.initializeBasisSet(name, atoms);
+
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Overlap;
+  specifier.derivOrder = 1;
+  auto result_map = LibintIntegrals::evaluate(specifier, basis, basis);
+  const auto& braDerivative = result_map[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::x, 0}];
+  const auto& ketDerivative = result_map[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::x, 1}];
+
+  Utils::Integrals::IntegralSpecifier testSpecifier;
+  testSpecifier.op = Utils::Integrals::Operator::Overlap;
+  auto basis_h0 = eval.initializeBasisSet(name, atoms_h0);
+  auto basis_h1 = eval.initializeBasisSet(name, atoms_h1);
+  auto map_h0 = LibintIntegrals::evaluate(testSpecifier, basis_h0, basis_h0);
+  auto map_h1 = LibintIntegrals::evaluate(testSpecifier, basis_h1, basis_h1);
+  Eigen::MatrixXd xDerivative =
+      1 / (0.0002 * Utils::Constants::bohr_per_angstrom) *
+      (map_h0[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, 0}] -
+       map_h1[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, 0}]);
+
+  // Only shells on the displaced atom contribute to the derivative, on both sides of the diagonal.
+  auto shell2bf = basis.shell2bf();
+  auto shell2atom = basis.shellToAtom(atoms);
+  for (size_t s1 = 0; s1 < basis.size(); ++s1) {
+    for (size_t s2 = 0; s2 < basis.size(); ++s2) {
+      for (std::size_t f1 = 0; f1 < basis[s1].size(); ++f1) {
+        for (std::size_t f2 = 0; f2 < basis[s2].size(); ++f2) {
+          auto bf1 = shell2bf.at(s1) + f1;
+          auto bf2 = shell2bf.at(s2) + f2;
+          double analytical = 0;
+          if (shell2atom.at(s1) == 1) {
+            analytical += braDerivative(bf1, bf2);
+          }
+          if (shell2atom.at(s2) == 1) {
+            analytical += ketDerivative(bf1, bf2);
+          }
+          EXPECT_THAT(xDerivative(bf1, bf2), DoubleNear(analytical, 1e-6));
+        }
+      }
+    }
+  }
+}
+
 TEST_F(OneBodyIntsTest, TestCore) {
   // Reference
   Eigen::MatrixXd pyScfHCoreH2Def2SVP;
@@ -291,3 +358,199 @@ TEST_F(OneBodyIntsTest, TestCore) {
 
   // auto point_charges_deriv_result_map = LibintIntegrals::evaluate(point_charges_deriv, basis, basis);
 }
+
+TEST_F(OneBodyIntsTest, TestMultipleOperatorsInOnePass) {
+  std::stringstream h2o("3\n\n"
+                        "O  0.0 0.0 0.0\n"
+                        "H  0.9 0.1 0.0\n"
+                        "H -0.3 0.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(h2o);
+
+  LibintIntegrals eval;
+  auto basis = eval.initializeBasisSet("def2-svp", scineAtoms);
+
+  Utils::Integrals::IntegralSpecifier overlap;
+  overlap.op = Utils::Integrals::Operator::Overlap;
+  Utils::Integrals::IntegralSpecifier kinetic;
+  kinetic.op = Utils::Integrals::Operator::Kinetic;
+  Utils::Integrals::IntegralSpecifier pointCharges;
+  pointCharges.op = Utils::Integrals::Operator::PointCharges;
+  pointCharges.atoms = scineAtoms;
+  Utils::Integrals::IntegralSpecifier dipole;
+  dipole.op = Utils::Integrals::Operator::Dipole;
+  dipole.multipoleOrigin = Utils::Position(0.1, 0.2, 0.3);
+
+  std::vector<Utils::Integrals::IntegralSpecifier> specifiers = {overlap, kinetic, pointCharges, dipole};
+  auto results = LibintIntegrals::evaluateOneBodyOperators(specifiers, basis, basis);
+  ASSERT_EQ(results.size(), specifiers.size());
+
+  for (std::size_t i = 0; i < specifiers.size(); ++i) {
+    auto reference = LibintIntegrals::evaluate(specifiers[i], basis, basis);
+    ASSERT_EQ(results[i].size(), reference.size());
+    for (auto const& keyMatrix : reference) {
+      EXPECT_TRUE(results[i].at(keyMatrix.first).isApprox(keyMatrix.second, 1e-12));
+    }
+  }
+
+  auto coreHamiltonianMap = LibintIntegrals::evaluateOneBodySum({kinetic, pointCharges}, basis, basis);
+  const auto& coreHamiltonian =
+      coreHamiltonianMap[{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, 0}];
+  const Eigen::MatrixXd reference =
+      results[1][{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, 0}] +
+      results[2][{Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, 0}];
+  EXPECT_TRUE(coreHamiltonian.isApprox(reference, 1e-12));
+
+  std::vector<Utils::Integrals::IntegralSpecifier> incompatibleSpecifiers = {kinetic, dipole};
+  EXPECT_THROW(LibintIntegrals::evaluateOneBodySum(incompatibleSpecifiers, basis, basis), std::runtime_error);
+}
+
+TEST_F(OneBodyIntsTest, TestExpandedPointCharges) {
+  std::stringstream h2o("3\n\n"
+                        "O  0.0 0.0 0.0\n"
+                        "H  0.9 0.1 0.0\n"
+                        "H -0.3 0.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(h2o);
+
+  LibintIntegrals eval;
+  auto basis = eval.initializeBasisSet("def2-svp", scineAtoms);
+
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::PointCharges;
+  specifier.atoms = scineAtoms;
+
+  // Without expansion, the nuclei given as point charges reproduce the nuclear attraction.
+  std::vector<PointCharge> nuclei;
+  for (auto const& atom : scineAtoms) {
+    nuclei.push_back({static_cast<double>(Utils::ElementInfo::Z(atom.getElementType())), atom.getPosition()});
+  }
+  auto referenceMap = LibintIntegrals::evaluate(specifier, basis, basis);
+  auto exactMap = LibintIntegrals::evaluatePointCharges(specifier, nuclei, basis, basis, 0.0);
+  const Utils::Integrals::ReturnKey key = {Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, 0};
+  EXPECT_TRUE(exactMap.at(key).isApprox(referenceMap.at(key), 1e-12));
+
+  // A shell of alternating MM charges around the molecule.
+  std::vector<PointCharge> charges;
+  for (int i = -6; i <= 6; ++i) {
+    for (int j = -6; j <= 6; ++j) {
+      for (int k = -6; k <= 6; ++k) {
+        const Eigen::Vector3d position(3.0 * i + 0.1, 3.0 * j - 0.2, 3.0 * k + 0.3);
+        if (position.norm() > 8.0) {
+          charges.push_back({((i + j + k) % 2 == 0) ? 0.4 : -0.4, position});
+        }
+      }
+    }
+  }
+  auto exactMMMap = LibintIntegrals::evaluatePointCharges(specifier, charges, basis, basis, 0.0);
+  auto expandedMMMap = LibintIntegrals::evaluatePointCharges(specifier, charges, basis, basis);
+  const Eigen::MatrixXd difference = expandedMMMap.at(key) - exactMMMap.at(key);
+  EXPECT_LT(difference.cwiseAbs().maxCoeff(), 1e-5);
+
+  specifier.derivOrder = 1;
+  EXPECT_THROW(LibintIntegrals::evaluatePointCharges(specifier, charges, basis, basis), std::runtime_error);
+}
+
+TEST_F(OneBodyIntsTest, TestElectrostaticPotentialOnGrid) {
+  std::stringstream h2o("3\n\n"
+                        "O  0.0 0.0 0.0\n"
+                        "H  0.9 0.1 0.0\n"
+                        "H -0.3 0.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(h2o);
+
+  LibintIntegrals eval;
+  auto basis = eval.initializeBasisSet("def2-svp", scineAtoms);
+  const auto nbf = static_cast<int>(basis.nbf());
+
+  Eigen::MatrixXd D = Eigen::MatrixXd::Random(nbf, nbf);
+  D = (D + D.transpose()).eval();
+  Eigen::MatrixXd Dcp = D;
+  Utils::DensityMatrix densityMatrix;
+  densityMatrix.setDensity(std::move(Dcp), 10);
+
+  Utils::PositionCollection points(4, 3);
+  points << 3.0, 0.0, 0.0, 0.0, -2.5, 1.0, 1.0, 1.0, 1.0, -4.0, 2.0, -3.0;
+  auto esp = LibintIntegrals::evaluateElectrostaticPotential(basis, densityMatrix, points, true);
+  ASSERT_EQ(esp.potential.size(), points.rows());
+  ASSERT_EQ(esp.field.rows(), points.rows());
+
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::PointCharges;
+  const Utils::Integrals::ReturnKey key = {Utils::Integrals::Component::none, Utils::Integrals::DerivKey::value, 0};
+  auto potentialAt = [&](const Eigen::Vector3d& point) {
+    std::vector<PointCharge> unitCharge = {{1.0, point}};
+    auto map = LibintIntegrals::evaluatePointCharges(specifier, unitCharge, basis, basis, 0.0);
+    return D.cwiseProduct(Eigen::MatrixXd(map.at(key))).sum();
+  };
+
+  const double step = 1e-4;
+  for (int g = 0; g < points.rows(); ++g) {
+    const Eigen::Vector3d point = points.row(g).transpose();
+    EXPECT_THAT(esp.potential[g], DoubleNear(potentialAt(point), 1e-10));
+    for (int k = 0; k < 3; ++k) {
+      Eigen::Vector3d plus = point;
+      Eigen::Vector3d minus = point;
+      plus[k] += step;
+      minus[k] -= step;
+      const double numericalField = -(potentialAt(plus) - potentialAt(minus)) / (2 * step);
+      EXPECT_THAT(esp.field(g, k), DoubleNear(numericalField, 1e-6));
+    }
+  }
+}
+
+TEST_F(OneBodyIntsTest, TestContractedOneBodyGradient) {
+  std::stringstream h2o("3\n\n"
+                        "O  0.0 0.0 0.0\n"
+                        "H  0.9 0.1 0.0\n"
+                        "H -0.3 0.8 0.0");
+  auto scineAtoms = Utils::XyzStreamHandler::read(h2o);
+
+  LibintIntegrals eval;
+  auto basis = eval.initializeBasisSet("def2-svp", scineAtoms);
+  const auto nbf = static_cast<int>(basis.nbf());
+
+  Eigen::MatrixXd D = Eigen::MatrixXd::Random(nbf, nbf);
+  D = (D + D.transpose()).eval();
+
+  std::vector<long> bf2atom(nbf);
+  auto shell2atom = basis.shellToAtom(scineAtoms);
+  auto shell2bf = basis.shell2bf();
+  for (std::size_t s = 0; s < basis.size(); ++s) {
+    for (std::size_t i = 0; i < basis[s].size(); ++i) {
+      bf2atom[shell2bf[s] + i] = shell2atom[s];
+    }
+  }
+
+  Utils::Integrals::IntegralSpecifier overlap;
+  overlap.op = Utils::Integrals::Operator::Overlap;
+  Utils::Integrals::IntegralSpecifier kinetic;
+  kinetic.op = Utils::Integrals::Operator::Kinetic;
+  Utils::Integrals::IntegralSpecifier pointCharges;
+  pointCharges.op = Utils::Integrals::Operator::PointCharges;
+  pointCharges.atoms = scineAtoms;
+
+  for (auto specifier : {overlap, kinetic, pointCharges}) {
+    specifier.derivOrder = 1;
+    auto gradient = LibintIntegrals::evaluateOneBodyGradient(specifier, basis, D, scineAtoms);
+    ASSERT_EQ(gradient.rows(), scineAtoms.size());
+
+    // Reference from the stored derivative matrices.
+    auto derivatives = LibintIntegrals::evaluateTensor(specifier, basis, basis);
+    Utils::GradientCollection reference = Utils::GradientCollection::Zero(scineAtoms.size(), 3);
+    std::vector<Utils::Integrals::DerivKey> derivKeys = {Utils::Integrals::DerivKey::x, Utils::Integrals::DerivKey::y,
+                                                         Utils::Integrals::DerivKey::z};
+    for (std::size_t center = 0; center < derivatives.numberOfCenters(); ++center) {
+      for (int k = 0; k < 3; ++k) {
+        const auto matrix = derivatives.matrix(derivatives.index(Utils::Integrals::Component::none, center, derivKeys[k]));
+        for (int mu = 0; mu < nbf; ++mu) {
+          for (int nu = 0; nu < nbf; ++nu) {
+            const auto atom = (center == 0) ? bf2atom[mu] : (center == 1) ? bf2atom[nu] : center - 2;
+            reference(atom, k) += D(mu, nu) * matrix(mu, nu);
+          }
+        }
+      }
+    }
+    EXPECT_TRUE(gradient.isApprox(reference, 1e-10));
+  }
+
+  Utils::Integrals::IntegralSpecifier values = overlap;
+  EXPECT_THROW(LibintIntegrals::evaluateOneBodyGradient(values, basis, D, scineAtoms), std::runtime_error);
+}
@@ -6,7 +6,11 @@
  */
 
 #include <LibintIntegrals/BasisSetHandler.h>
+#include <LibintIntegrals/Libint.h>
 #include <LibintIntegrals/LibintIntegrals.h>
+#include <LibintIntegrals/TwoBodyIntegrals/Evaluator.h>
+#include <LibintIntegrals/TwoBodyIntegrals/SaverDigester.h>
+#include <LibintIntegrals/TwoBodyIntegrals/SymmetryHelper.h>
 #include <Utils/Constants.h>
 #include <Utils/IO/ChemicalFileFormats/XyzStreamHandler.h>
 #include <Utils/Settings.h>
@@ -856,3 +860,117 @@ TEST_F(TwoBodyIntsTest, TestCoulombDerivative) {
     }
   }
 }
+
+TEST_F(TwoBodyIntsTest, SymmetricIndicesExpandWithoutAllocation) {
+  using TwoBody::IndexType;
+  using TwoBody::IntegralSymmetry;
+  const int n = 24;
+  std::vector<IndexType<4>> quartets;
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      for (int k = 0; k < n; ++k) {
+        for (int l = 0; l <= k; ++l) {
+          IndexType<4> index = {i, j, k, l};
+          if (TwoBody::getMappedIndex<IntegralSymmetry::eightfold>(index) == index) {
+            quartets.push_back(index);
+          }
+        }
+      }
+    }
+  }
+
+  // Every symmetric index maps back onto the canonical one, and the number of them is the degeneracy.
+  for (const auto& index : quartets) {
+    const auto expanded = TwoBody::getSymmetricIndices<IntegralSymmetry::eightfold>(index);
+    ASSERT_DOUBLE_EQ(double(expanded.size()),
+                     TwoBody::getDegeneracy<IntegralSymmetry::eightfold>(index[0], index[1], index[2], index[3]));
+    for (const auto& symmetricIndex : expanded) {
+      ASSERT_EQ(TwoBody::getMappedIndex<IntegralSymmetry::eightfold>(symmetricIndex), index);
+    }
+  }
+}
+
+TEST_F(TwoBodyIntsTest, ParallelFirstTouchTensorMatchesSerialPlacement) {
+  std::stringstream water("3\n\n"
+                          "O  0.0 0.0 0.0\n"
+                          "H  0.9 0.1 0.0\n"
+                          "H -0.3 0.8 0.0\n");
+  auto scineAtoms = Utils::XyzStreamHandler::read(water);
+  LibintIntegrals eval;
+  auto basis = eval.initializeBasisSet("def2-svp", scineAtoms);
+  const auto nbf = static_cast<int>(basis.nbf());
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+
+  using Saver = TwoBody::SaverDigester<TwoBody::IntegralSymmetry::eightfold>;
+  auto computeTensor = [&](TensorPlacement placement) {
+    auto evaluator = TwoBody::Evaluator<Saver>(basis, basis, specifier, Saver(basis, basis, specifier, placement),
+                                               TwoBody::VoidPrescreener());
+    evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+    return Eigen::MatrixXd(evaluator.getResult().matrix(0));
+  };
+  const auto serial = computeTensor(TensorPlacement::serial);
+  const auto firstTouch = computeTensor(TensorPlacement::parallelFirstTouch);
+  ASSERT_EQ(serial.rows(), nbf * nbf);
+  ASSERT_TRUE(serial.isApprox(firstTouch, 1e-12));
+
+  // Every shell quartet computed directly, without the symmetry of the digester.
+  auto engine = Libint::getEngine(basis, libint2::Operator::coulomb);
+  const auto& buffer = engine.results();
+  const auto shell2bf = basis.shell2bf();
+  Eigen::MatrixXd reference = Eigen::MatrixXd::Zero(nbf * nbf, nbf * nbf);
+  for (std::size_t s1 = 0; s1 < basis.size(); ++s1) {
+    for (std::size_t s2 = 0; s2 < basis.size(); ++s2) {
+      for (std::size_t s3 = 0; s3 < basis.size(); ++s3) {
+        for (std::size_t s4 = 0; s4 < basis.size(); ++s4) {
+          engine.compute(BasisSetHandler::scineToLibint(basis[s1]), BasisSetHandler::scineToLibint(basis[s2]),
+                         BasisSetHandler::scineToLibint(basis[s3]), BasisSetHandler::scineToLibint(basis[s4]));
+          if (buffer[0] == nullptr) {
+            continue;
+          }
+          const auto n1 = basis[s1].size();
+          const auto n2 = basis[s2].size();
+          const auto n3 = basis[s3].size();
+          const auto n4 = basis[s4].size();
+          for (std::size_t f1 = 0, f1234 = 0; f1 < n1; ++f1) {
+            for (std::size_t f2 = 0; f2 < n2; ++f2) {
+              for (std::size_t f3 = 0; f3 < n3; ++f3) {
+                for (std::size_t f4 = 0; f4 < n4; ++f4, ++f1234) {
+                  const auto ij = (shell2bf[s1] + f1) * nbf + shell2bf[s2] + f2;
+                  const auto kl = (shell2bf[s3] + f3) * nbf + shell2bf[s4] + f4;
+                  reference(ij, kl) = buffer[0][f1234];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  // The evaluator screens primitive pairs, which changes the integrals at the order of the machine precision.
+  ASSERT_LT((firstTouch - reference).cwiseAbs().maxCoeff(), 1e-10);
+}
+
+TEST_F(TwoBodyIntsTest, TakeResultMovesTheTensorOut) {
+  std::stringstream h2("2\n\n"
+                       "H 0 0 0\n"
+                       "H 0.74 0 0\n");
+  auto scineAtoms = Utils::XyzStreamHandler::read(h2);
+  LibintIntegrals eval;
+  auto basis = eval.initializeBasisSet("def2-svp", scineAtoms);
+  Utils::Integrals::IntegralSpecifier specifier;
+  specifier.op = Utils::Integrals::Operator::Coulomb;
+
+  using Saver = TwoBody::SaverDigester<TwoBody::IntegralSymmetry::eightfold>;
+  auto evaluator =
+      TwoBody::Evaluator<Saver>(basis, basis, specifier, Saver(basis, basis, specifier), TwoBody::VoidPrescreener());
+  evaluator.evaluateTwoBodyIntegrals<libint2::Operator::coulomb>();
+  const Eigen::MatrixXd copy = evaluator.getResult().matrix(0);
+  const double* buffer = evaluator.getResult().data(0);
+
+  const auto taken = evaluator.takeResult();
+  // The buffer changes hands instead of being copied.
+  ASSERT_EQ(taken.data(0), buffer);
+  ASSERT_TRUE(Eigen::MatrixXd(taken.matrix(0)).isApprox(copy));
+  ASSERT_TRUE(LibintIntegrals::evaluateTensor(specifier, basis, basis).matrix(0).isApprox(copy));
+}